@@ -0,0 +1,68 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <cstdio>
+
+#include "engine/engine.hpp"
+#include "game/board.hpp"
+#include "util/profiler.hpp"
+
+// Runs the whole engine stack, process, I/O thread, parser and variant queue,
+// against a recorded session played back by uci-replay:
+//
+//     engine-replay-bench <uci-replay> <log> [speed] [stop after ms]
+//
+// Speed 0 floods the engine with the recorded output as fast as possible.
+// Finite searches end with the recorded bestmove, infinite ones are stopped
+// after the given time.
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    if (argc < 3) {
+        std::fprintf(stderr, "Usage: engine-replay-bench <uci-replay> <log> "
+                             "[speed] [stop after ms]\n");
+        return 1;
+    }
+
+    EngineConfig config;
+    config.setName("replay");
+    config.setCommand(argv[1]);
+    config.setArguments(QString("%1 --speed %2")
+                            .arg(argv[2], argc > 3 ? argv[3] : "0"));
+    int stopAfterMs = argc > 4 ? QString(argv[4]).toInt() : 0;
+
+    Profiler::instance().setEnabled(true);
+    Engine engine(config);
+    QElapsedTimer timer;
+    qint64 variants = 0;
+
+    QObject::connect(&engine, &Engine::variantParsed,
+                     [&variants](VariantInfo) { ++variants; });
+    QObject::connect(&engine, &Engine::ready, [&]() {
+        timer.start();
+        engine.startAnalysis(Board());
+        if (stopAfterMs > 0)
+            QTimer::singleShot(stopAfterMs, &engine, &Engine::stopAnalysis);
+    });
+    auto report = [&]() {
+        qint64 elapsedUs = timer.nsecsElapsed() / 1000;
+        std::printf("%lld us, %lld variants delivered\n",
+                    static_cast<long long>(elapsedUs),
+                    static_cast<long long>(variants));
+        for (const Profiler::Stats& stats : Profiler::instance().stats())
+            std::printf("%-24s %8lld calls  p50 %8.1f us  p99 %8.1f us  "
+                        "max %8.1f us\n",
+                        qPrintable(stats.section),
+                        static_cast<long long>(stats.count), stats.p50,
+                        stats.p99, stats.max);
+        app.quit();
+    };
+    QObject::connect(&engine, &Engine::bestMoveFound, report);
+    QObject::connect(&engine, &Engine::stopped, report);
+    QObject::connect(&engine, &Engine::failed, [&app](QString reason) {
+        std::fprintf(stderr, "%s\n", qPrintable(reason));
+        app.exit(1);
+    });
+
+    engine.start();
+    return app.exec();
+}
@@ -0,0 +1,47 @@
+#include <QElapsedTimer>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "database/game-database.hpp"
+
+// Replays random games of a database into trees, e.g.
+//
+//     game-database-bench games.db 10000
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <database> [games]\n", argv[0]);
+        return 1;
+    }
+
+    GameDatabase database;
+    if (!database.open(argv[1]) || database.gameCount() == 0) {
+        std::fprintf(stderr, "Cannot open %s or it is empty.\n", argv[1]);
+        return 1;
+    }
+    int count = argc > 2 ? std::atoi(argv[2]) : 10000;
+
+    // Fixed seed, runs are comparable.
+    std::mt19937_64 random(42);
+    std::uniform_int_distribution<qint64> pick(0, database.gameCount() - 1);
+    qint64 plies = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < count; ++i) {
+        std::unique_ptr<Tree> game = database.game(pick(random));
+        if (!game) {
+            std::fprintf(stderr, "Damaged record.\n");
+            return 1;
+        }
+        for (const TreeNode* node = game->rootNode(); node->next();
+             node = node->next())
+            ++plies;
+    }
+    qint64 elapsed = qMax<qint64>(1, timer.nsecsElapsed() / 1000);
+
+    std::printf("%d games, %lld plies: %.1f us per game, %.2f us per ply\n",
+                count, plies, double(elapsed) / count,
+                double(elapsed) / qMax<qint64>(1, plies));
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QVector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#include "database/game-database.hpp"
+#include "database/opening-explorer.hpp"
+#include "database/position-index.hpp"
+#include "engine/uci-parser.hpp"
+#include "game/zobrist.hpp"
+
+// Checks that a transposition ending with a double pawn push is a single
+// position for the explorer and the position index, then measures explorer
+// lookups along random games of a database with a built explorer:
+//
+//     opening-explorer-bench [database] [games]
+
+namespace {
+
+// Same position before 3...d5, reached by 3.c4 and by 3.Nf3.
+const char* const Orders[] = {"d2d4 g8f6 g1f3 e7e6 c2c4 d7d5",
+                              "d2d4 g8f6 c2c4 e7e6 g1f3 d7d5"};
+const int TransposedPly = 5;
+
+/*! \brief Plays moves in long algebraic notation, stops after \a plies
+ * of them if it is not negative */
+bool play(const char* moves, Tree* tree, Board* board, int plies = -1) {
+    const char* end = moves + std::strlen(moves);
+    UciTokenizer tokens(moves, end);
+    const char* begin;
+    const char* tokenEnd;
+    for (int ply = 0; ply != plies && tokens.next(begin, tokenEnd); ++ply) {
+        Move move;
+        if (!UciParser::parseMove(begin, tokenEnd, move)) return false;
+        if (tree && !tree->addMove(move)) return false;
+        if (board && !board->makeMove(move)) return false;
+    }
+    return true;
+}
+
+/*! \brief Builds database of both move orders with its explorer and
+ * index, then looks up the transposed position.
+ * \returns true if both report it for the two games
+ */
+bool checkTransposition() {
+    QTemporaryDir dir;
+    QString path = dir.filePath("transposition.db");
+    GameDatabase database;
+    if (!dir.isValid() || !database.open(path, GameDatabase::Append)) {
+        std::fprintf(stderr, "Cannot create database.\n");
+        return false;
+    }
+    for (const char* order : Orders) {
+        Tree tree;
+        if (!play(order, &tree, nullptr) || !database.append(tree)) {
+            std::fprintf(stderr, "Cannot add %s.\n", order);
+            return false;
+        }
+    }
+    database.close();
+
+    OpeningExplorer explorer;
+    PositionIndex index;
+    if (!database.open(path) || !OpeningExplorer::build(database, path, 2) ||
+        !PositionIndex::build(database, path, 2) || !explorer.open(path) ||
+        !index.open(path)) {
+        std::fprintf(stderr, "Cannot build explorer or index.\n");
+        return false;
+    }
+
+    bool passed = true;
+    for (const char* order : Orders) {
+        Board board;
+        play(order, nullptr, &board, TransposedPly);
+        quint64 hash = Zobrist::hash(board);
+        quint32 games = 0;
+        for (const OpeningExplorer::MoveStats& stats : explorer.moves(board))
+            games += stats.games;
+        bool found = games == 2 && index.gameCount(hash) == 2;
+        std::printf("%s %s: %u explorer games, %lld indexed games\n",
+                    found ? "ok  " : "FAIL", order, games,
+                    index.gameCount(hash));
+        passed = passed && found;
+    }
+    return passed;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (!checkTransposition()) return 1;
+    if (argc < 2) return 0;
+
+    GameDatabase database;
+    OpeningExplorer explorer;
+    if (!database.open(argv[1]) || database.gameCount() == 0 ||
+        !explorer.open(argv[1])) {
+        std::fprintf(stderr, "Cannot open %s or its explorer.\n", argv[1]);
+        return 1;
+    }
+    int count = argc > 2 ? std::atoi(argv[2]) : 10000;
+
+    // Fixed seed, runs are comparable.
+    std::mt19937_64 random(42);
+    std::uniform_int_distribution<qint64> pick(0, database.gameCount() - 1);
+    QVector<Board> boards;
+    Board start;
+    QVector<Move> moves;
+    for (int i = 0; i < count; ++i) {
+        if (!database.moves(pick(random), start, moves)) continue;
+        Board board = start;
+        // Explorer is mostly used in the opening.
+        for (int ply = 0; ply < qMin(20, int(moves.size())); ++ply) {
+            boards.append(board);
+            board.makeMove(moves[ply]);
+        }
+    }
+
+    qint64 found = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (const Board& board : boards) found += explorer.moves(board).size();
+    qint64 elapsed = qMax<qint64>(1, timer.nsecsElapsed() / 1000);
+
+    std::printf("%d positions, %lld moves: %.2f us per lookup\n",
+                int(boards.size()), found,
+                double(elapsed) / qMax(1, int(boards.size())));
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QFile>
+#include <cstdio>
+#include <cstring>
+
+#include "engine/uci-parser.hpp"
+#include "pgn/pgn-reader.hpp"
+#include "pgn/pgn-writer.hpp"
+
+// Checks that games from set-up positions are read back as written, then
+// measures reading and writing of a PGN file:
+//
+//     pgn-bench [games.pgn]
+
+namespace {
+
+struct SetUpGame {
+    const char* fen;
+    const char* moves;
+};
+
+const SetUpGame SetUpGames[] = {
+    // No castling rights, en passant square after the first move.
+    {"4k3/3p4/8/4P3/8/8/8/4K3 b - - 0 1", "d7d5 e5d6 e8d7"},
+    {"r3k2r/8/8/8/8/8/8/R3K2R w Kq - 3 20", "e1g1 e8c8"},
+    {"8/8/8/2k5/8/8/5K2/8 w - - 99 60", "f2e3"},
+};
+
+/*! \brief Writes a game of \a setUp and reads it back.
+ * \returns true if the starting position and the moves survive
+ */
+bool roundTrip(const SetUpGame& setUp) {
+    Board start;
+    if (!start.setFen(setUp.fen)) {
+        std::printf("FAIL %s: invalid test position\n", setUp.fen);
+        return false;
+    }
+    Tree tree(start);
+    Board end = start;
+    const char* moves = setUp.moves;
+    UciTokenizer tokens(moves, moves + std::strlen(moves));
+    const char* begin;
+    const char* tokenEnd;
+    while (tokens.next(begin, tokenEnd)) {
+        Move move;
+        if (!UciParser::parseMove(begin, tokenEnd, move) ||
+            !tree.addMove(move) || !end.makeMove(move)) {
+            std::printf("FAIL %s: illegal test move\n", setUp.fen);
+            return false;
+        }
+    }
+
+    QByteArray pgn;
+    QBuffer buffer(&pgn);
+    buffer.open(QIODevice::WriteOnly);
+    {
+        PgnWriter writer(&buffer);
+        writer.writeGame(tree);
+    }
+
+    PgnReader reader(pgn.constData(), pgn.constData() + pgn.size());
+    std::unique_ptr<Tree> game = reader.readGame();
+    const TreeNode* node = game ? game->rootNode() : nullptr;
+    bool passed = node && node->getBoard()->toFen() == start.toFen();
+    while (passed && node->next()) node = node->next();
+    passed = passed && node->getBoard()->toFen() == end.toFen();
+    std::printf("%s %s: %s\n", passed ? "ok  " : "FAIL", setUp.fen,
+                game ? "read back" : qPrintable(reader.lastError()));
+    return passed;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int failures = 0;
+    for (const SetUpGame& setUp : SetUpGames)
+        if (!roundTrip(setUp)) ++failures;
+    if (failures) {
+        std::fprintf(stderr, "%d games do not survive.\n", failures);
+        return 1;
+    }
+    if (argc < 2) return 0;
+
+    QFile file(argv[1]);
+    if (!file.open(QIODevice::ReadOnly)) {
+        std::fprintf(stderr, "Cannot open %s.\n", argv[1]);
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    PgnReader reader(&file);
+    std::vector<std::unique_ptr<Tree>> games;
+    while (std::unique_ptr<Tree> game = reader.readGame())
+        games.push_back(std::move(game));
+    qint64 reading = qMax<qint64>(1, timer.nsecsElapsed() / 1000);
+
+    QBuffer output;
+    output.open(QIODevice::WriteOnly);
+    timer.restart();
+    {
+        PgnWriter writer(&output);
+        for (const auto& game : games) writer.writeGame(*game);
+    }
+    qint64 writing = qMax<qint64>(1, timer.nsecsElapsed() / 1000);
+
+    std::printf("%d games, %lld skipped: read %.2f us, written %.2f us "
+                "per game\n",
+                int(games.size()), reader.skippedCount(),
+                double(reading) / qMax<size_t>(1, games.size()),
+                double(writing) / qMax<size_t>(1, games.size()));
+    return 0;
+}
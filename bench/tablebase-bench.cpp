@@ -0,0 +1,228 @@
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QVector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "engine/batch-analyzer.hpp"
+#include "tablebase/tablebase.hpp"
+
+// Checks probes of the smallest tables against known results, then measures
+// WDL and DTZ probes of random positions:
+//
+//     tablebase-bench <syzygy directory> [positions]
+//
+// The directory needs KQvK and KRvK, both .rtbw and .rtbz. Without a
+// directory nothing is checked. The same positions also go through
+// BatchAnalyzer the way batch-analysis passes them, as FEN of a Board.
+
+namespace {
+
+struct KnownResult {
+    const char* table;
+    const char* fen;
+    Tablebase::Wdl wdl;
+    /*!< Sign of DTZ, 0 for a draw */
+    int dtzSign;
+};
+
+const KnownResult KnownResults[] = {
+    {"KQvK", "4k3/8/8/8/8/8/8/4K2Q w - - 0 1", Tablebase::Win, 1},
+    {"KQvK", "4k3/8/8/8/8/8/8/4K2Q b - - 0 1", Tablebase::Loss, -1},
+    {"KRvK", "4k3/8/8/8/8/8/8/R3K3 w - - 0 1", Tablebase::Win, 1},
+    {"KRvK", "4k3/8/8/8/8/8/8/R3K3 b - - 0 1", Tablebase::Loss, -1},
+    // Black takes the undefended rook, only captures resolve it.
+    {"KRvK", "7K/8/8/8/8/8/1R6/k7 b - - 0 1", Tablebase::Draw, 0},
+};
+
+int sign(int value) { return (value > 0) - (value < 0); }
+
+bool hasTable(const QString& directory, const char* table) {
+    QDir dir(directory);
+    return QFile::exists(dir.filePath(QString("%1.rtbw").arg(table))) &&
+           QFile::exists(dir.filePath(QString("%1.rtbz").arg(table)));
+}
+
+/*! \brief Answers known positions through BatchAnalyzer, which has to
+ * find all of them in the tablebases.
+ * \returns number of mismatches
+ */
+int checkBatchAnalyzer(const QString& directory) {
+    QTemporaryDir output;
+    BatchAnalyzer analyzer(EngineConfig(), SearchLimits());
+    analyzer.setTablebase(&Tablebase::instance());
+    if (!output.isValid() ||
+        !analyzer.setOutput(output.filePath("batch.txt"))) {
+        std::fprintf(stderr, "Cannot create batch output.\n");
+        return 1;
+    }
+
+    QHash<QString, Tablebase::Wdl> expected;
+    Board board;
+    for (const KnownResult& known : KnownResults) {
+        if (!hasTable(directory, known.table)) continue;
+        board.setFen(known.fen);
+        expected.insert(board.toFen(), known.wdl);
+        analyzer.addPosition(board.toFen());
+    }
+    // Positions missing in the tables would be handed to engines.
+    analyzer.setWorkerCount(1);
+    analyzer.start();
+
+    int failures = 0;
+    QFile results(output.filePath("batch.txt"));
+    results.open(QIODevice::ReadOnly | QIODevice::Text);
+    while (!results.atEnd()) {
+        QStringList fields = QString::fromUtf8(results.readLine())
+                                 .trimmed()
+                                 .split('\t');
+        if (fields.size() < 3 || !expected.contains(fields[0])) continue;
+        bool passed = fields[2] == QString("wdl %1")
+                                       .arg(int(expected.take(fields[0])));
+        if (!passed) ++failures;
+        std::printf("%s batch %s: %s\n", passed ? "ok  " : "FAIL",
+                    qPrintable(fields[0]), qPrintable(fields[2]));
+    }
+    for (const QString& fen : expected.keys())
+        std::printf("FAIL batch %s: not answered\n", qPrintable(fen));
+    return failures + expected.size();
+}
+
+/*! \brief Returns piece placement of \a material, white pieces then the
+ * black king, on random squares with the kings apart */
+QString randomPlacement(std::mt19937_64& random, const QString& material) {
+    std::uniform_int_distribution<int> square(0, 63);
+    QVector<int> squares;
+    while (squares.size() < material.size()) {
+        int candidate = square(random);
+        if (!squares.contains(candidate)) squares.append(candidate);
+        // White king comes first, black king last.
+        if (squares.size() == material.size() &&
+            qAbs(squares.first() % 8 - squares.last() % 8) <= 1 &&
+            qAbs(squares.first() / 8 - squares.last() / 8) <= 1)
+            squares.removeLast();
+    }
+
+    char board[64];
+    std::fill(board, board + 64, '.');
+    for (int i = 0; i < material.size(); ++i)
+        board[squares[i]] = material[i].toLatin1();
+
+    QStringList ranks;
+    for (int y = 0; y < 8; ++y) {
+        QString rank;
+        int empty = 0;
+        for (int x = 0; x < 8; ++x) {
+            char piece = board[8 * y + x];
+            if (piece == '.') {
+                ++empty;
+                continue;
+            }
+            if (empty) rank += QString::number(empty);
+            rank += piece;
+            empty = 0;
+        }
+        if (empty) rank += QString::number(empty);
+        ranks.append(rank);
+    }
+    return ranks.join('/');
+}
+
+/*! \brief Sets \a board to a random legal position of \a material with
+ * white to move */
+void randomPosition(std::mt19937_64& random, const QString& material,
+                    Board& board) {
+    for (;;) {
+        QString placement = randomPlacement(random, material);
+        // Side not to move must not be in check.
+        if (!board.setFen(placement + " b - - 0 1") || board.isCheck())
+            continue;
+        if (board.setFen(placement + " w - - 0 1")) return;
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    if (argc < 2) {
+        std::printf("No tablebase directory given, skipped.\n");
+        return 0;
+    }
+
+    Tablebase& tablebase = Tablebase::instance();
+    if (tablebase.init(argv[1]) == 0) {
+        std::fprintf(stderr, "No tables in %s.\n", argv[1]);
+        return 1;
+    }
+
+    int failures = 0;
+    for (const KnownResult& known : KnownResults) {
+        if (!hasTable(argv[1], known.table)) {
+            std::printf("skipped %s, no %s\n", known.fen, known.table);
+            continue;
+        }
+
+        Board board;
+        board.setFen(known.fen);
+        Tablebase::Wdl wdl = Tablebase::Draw;
+        Tablebase::Wdl rootWdl = Tablebase::Draw;
+        int dtz = 0;
+        int rootDtz = 0;
+        Move move;
+        bool probed = tablebase.probeWdl(board, wdl) &&
+                      tablebase.probeDtz(board, dtz) &&
+                      tablebase.probeRoot(board, move, rootWdl, rootDtz);
+        bool passed = probed && wdl == known.wdl &&
+                      sign(dtz) == known.dtzSign && rootWdl == known.wdl &&
+                      board.isLegal(move);
+
+        // Best move must keep the result for the other side.
+        Tablebase::Wdl after = Tablebase::Draw;
+        if (passed) {
+            board.makeMove(move);
+            passed = tablebase.probeWdl(board, after) &&
+                     after == Tablebase::Wdl(-known.wdl);
+        }
+        if (!passed) ++failures;
+        std::printf("%s %s: wdl %d, dtz %d, after best move %d\n",
+                    passed ? "ok  " : "FAIL", known.fen, int(wdl), dtz,
+                    int(after));
+    }
+    failures += checkBatchAnalyzer(argv[1]);
+    if (failures) {
+        std::fprintf(stderr, "%d known results do not match.\n", failures);
+        return 1;
+    }
+
+    // Fixed seed, runs are comparable.
+    int count = argc > 2 ? std::atoi(argv[2]) : 100000;
+    std::mt19937_64 random(42);
+    QVector<Board> boards(qMax(1, count));
+    for (int i = 0; i < boards.size(); ++i)
+        randomPosition(random, i % 2 ? "KQk" : "KRk", boards[i]);
+
+    for (bool dtzProbes : {false, true}) {
+        int probed = 0;
+        QElapsedTimer timer;
+        timer.start();
+        for (const Board& board : boards) {
+            Tablebase::Wdl wdl;
+            int dtz;
+            if (dtzProbes ? tablebase.probeDtz(board, dtz)
+                          : tablebase.probeWdl(board, wdl))
+                ++probed;
+        }
+        qint64 elapsed = qMax<qint64>(1, timer.nsecsElapsed() / 1000);
+        std::printf("%s: %d of %d probed, %.2f us per probe\n",
+                    dtzProbes ? "DTZ" : "WDL", probed, int(boards.size()),
+                    double(elapsed) / boards.size());
+    }
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <QElapsedTimer>
+#include <QList>
+#include <QStringList>
+#include <cstdio>
+
+#include "engine/uci-parser.hpp"
+
+// Typical lines of a strong engine running with MultiPV.
+static const char* Lines[] = {
+    "info depth 24 seldepth 33 multipv 1 score cp 31 nodes 18234112 nps "
+    "2125342 hashfull 412 tbhits 0 time 8580 pv e2e4 e7e5 g1f3 b8c6 f1b5 "
+    "g8f6 e1g1 f6e4 f1e1 e4d6 f3e5 f8e7 b5f1 c6e5 e1e5 e8g8 d2d4 e7f6 e5e1 "
+    "f8e8 c2c3 e8e1 d1e1 d6f5",
+    "info depth 24 seldepth 30 multipv 2 score cp 24 upperbound nodes "
+    "18234112 nps 2125342 hashfull 412 tbhits 0 time 8580 pv d2d4 g8f6 c2c4 "
+    "e7e6 g1f3 d7d5 b1c3 f8e7 c1f4 e8g8 e2e3 c7c5 d4c5 e7c5",
+    "info depth 24 seldepth 29 multipv 3 score mate -7 nodes 18234112 nps "
+    "2125342 hashfull 412 tbhits 0 time 8580 pv g1f3 d7d5 d2d4 g8f6 c2c4 "
+    "e7e6 b1c3 f8e7 c1g5 h7h6 g5h4 e8g8 e2e3 b7b6",
+    "info depth 24 currmove e2e4 currmovenumber 1",
+};
+
+// Reference implementation the parser has replaced.
+static bool splitParse(const QString& line, VariantInfo& info) {
+    if (!line.contains("score")) return false;
+    QStringList tokens = line.split(" ");
+    QStringList moves;
+
+    for (int i = 0; i < tokens.size(); i++) {
+        const QString& token = tokens[i];
+        if (token == "score") {
+            const QString& type = tokens[++i];
+            if (type == "cp")
+                info.setScore(tokens[++i].toInt());
+            else if (type == "mate")
+                info.setMate(tokens[++i].toInt());
+        } else if (token == "depth") {
+            info.setDepth(tokens[++i].toInt());
+        } else if (token == "multipv") {
+            info.setId(tokens[++i].toInt());
+        } else if (token == "pv") {
+            ++i;
+            while (i < tokens.size()) moves.append(tokens[i++]);
+        } else if (token == "nps") {
+            info.setNps(tokens[++i].toInt());
+        }
+    }
+    return true;
+}
+
+int main() {
+    const int iterations = 200000;
+    const int numLines = sizeof(Lines) / sizeof(Lines[0]);
+    QList<QByteArray> raw;
+    for (const char* line : Lines) raw.append(QByteArray(line));
+
+    VariantInfo info;
+    QElapsedTimer timer;
+    int variants = 0;
+
+    timer.start();
+    for (int i = 0; i < iterations; i++)
+        for (const QByteArray& line : raw)
+            variants += UciParser::parseInfo(line, info);
+    qint64 parserNs = timer.nsecsElapsed();
+
+    timer.restart();
+    for (int i = 0; i < iterations; i++) {
+        for (const QByteArray& line : raw) {
+            VariantInfo fresh;
+            variants += splitParse(QString::fromLatin1(line), fresh);
+        }
+    }
+    qint64 splitNs = timer.nsecsElapsed();
+
+    const double lines = double(iterations) * numLines;
+    std::printf("UciParser::parseInfo  %8.1f ns/line  %10.0f lines/s\n",
+                parserNs / lines, lines * 1e9 / parserNs);
+    std::printf("QString::split        %8.1f ns/line  %10.0f lines/s\n",
+                splitNs / lines, lines * 1e9 / splitNs);
+    // Keeps the loops from being optimized away.
+    std::printf("(%d variants)\n", variants);
+    return 0;
+}
@@ -0,0 +1,359 @@
+#include "book/polyglot-book.hpp"
+
+#include <QRegularExpression>
+#include <QtEndian>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "database/game-database.hpp"
+#include "database/partition-files.hpp"
+
+namespace {
+
+const int RandomCount = 781;
+const int CastleOffset = 768;
+const int EnPassantOffset = 772;
+const int TurnOffset = 780;
+/*!< Key of the initial position in the Polyglot format description */
+const quint64 InitialKey = 0x463b96181691fc9cull;
+
+struct RandomTable {
+    quint64 keys[RandomCount];
+    bool standard = false;
+
+    RandomTable() {
+        // SplitMix64 with its own seed, only used without a loaded table.
+        quint64 state = 0x706f6c79676c6f74ull;
+        for (quint64& key : keys) {
+            quint64 z = (state += 0x9e3779b97f4a7c15ull);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            key = z ^ (z >> 31);
+        }
+    }
+};
+
+RandomTable& randomTable() {
+    static RandomTable instance;
+    return instance;
+}
+
+/*! \brief Book move played in a game, as written to partition files */
+struct Sample {
+    quint64 key;
+    quint16 move;
+    /*!< 2 for a win of the side playing the move, 1 for a draw */
+    quint16 score;
+    quint32 reserved;
+};
+
+/*!< Samples a worker collects per partition before writing them */
+const size_t BufferSamples = 2048;
+/*!< Games a worker takes at once */
+const qint64 BatchSize = 256;
+
+}  // namespace
+
+PolyglotBook::PolyglotBook()
+    : m_map(nullptr), m_entries(nullptr), m_entryCount(0) {}
+
+PolyglotBook::~PolyglotBook() { close(); }
+
+PolyglotBook& PolyglotBook::instance() {
+    static PolyglotBook book;
+    return book;
+}
+
+bool PolyglotBook::loadRandomTable(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    static const QRegularExpression number("0x([0-9A-Fa-f]{1,16})");
+    QString text = QString::fromLatin1(file.readAll());
+    QVector<quint64> keys;
+    for (auto match = number.globalMatch(text); match.hasNext();)
+        keys.append(match.next().captured(1).toULongLong(nullptr, 16));
+    if (keys.size() != RandomCount) return false;
+
+    RandomTable& table = randomTable();
+    RandomTable previous = table;
+    std::copy(keys.begin(), keys.end(), table.keys);
+    // Mistyped or reordered numbers would silently miss every position.
+    if (key(Board()) != InitialKey) {
+        table = previous;
+        return false;
+    }
+    table.standard = true;
+    return true;
+}
+
+bool PolyglotBook::hasStandardTable() { return randomTable().standard; }
+
+quint64 PolyglotBook::key(const Board& board) {
+    const quint64* random = randomTable().keys;
+    quint64 key = 0;
+
+    // Polyglot counts rows from rank 1, the board from rank 8.
+    for (int y = 0; y < 8; ++y) {
+        for (int x = 0; x < 8; ++x) {
+            const Piece& piece = board.pieceAt(x, y);
+            if (piece.isNone()) continue;
+
+            int kind = 2 * static_cast<int>(piece.type()) +
+                       (piece.owner().isWhite() ? 1 : 0);
+            key ^= random[64 * kind + 8 * (7 - y) + x];
+        }
+    }
+
+    if (board.hasShortCastlingRights(Player::white()))
+        key ^= random[CastleOffset];
+    if (board.hasLongCastlingRights(Player::white()))
+        key ^= random[CastleOffset + 1];
+    if (board.hasShortCastlingRights(Player::black()))
+        key ^= random[CastleOffset + 2];
+    if (board.hasLongCastlingRights(Player::black()))
+        key ^= random[CastleOffset + 3];
+
+    // En passant file counts only if a pawn can actually capture there.
+    Player side = board.currentPlayer();
+    Coord2D<int> target = board.getBoardState().EnPassantCoords;
+    if (board.isLegalCoord(target)) {
+        int y = target.y + (side.isWhite() ? 1 : -1);
+        for (int x : {target.x - 1, target.x + 1}) {
+            if (!board.isLegalCoord(x, y)) continue;
+            const Piece& piece = board.pieceAt(x, y);
+            if (piece.isPawn() && piece.owner() == side) {
+                key ^= random[EnPassantOffset + target.x];
+                break;
+            }
+        }
+    }
+
+    if (side.isWhite()) key ^= random[TurnOffset];
+    return key;
+}
+
+quint16 PolyglotBook::packMove(const Board& board, const Move& move) {
+    Coord2D<int> to = move.To;
+    // Castling is written as the king taking its own rook.
+    if (board.pieceAt(move.From).isKing() && move.From.x == 4 &&
+        qAbs(to.x - move.From.x) == 2)
+        to.x = to.x == 6 ? 7 : 0;
+
+    int promotion = move.PromotionPiece == Piece::Type::None
+                        ? 0
+                        : static_cast<int>(move.PromotionPiece);
+    return to.x | (7 - to.y) << 3 | move.From.x << 6 |
+           (7 - move.From.y) << 9 | promotion << 12;
+}
+
+Move PolyglotBook::unpackMove(const Board& board, quint16 packed) {
+    Coord2D<int> to(packed & 7, 7 - ((packed >> 3) & 7));
+    Coord2D<int> from((packed >> 6) & 7, 7 - ((packed >> 9) & 7));
+    int promotion = (packed >> 12) & 7;
+
+    const Piece& piece = board.pieceAt(from);
+    const Piece& target = board.pieceAt(to);
+    if (piece.isKing() && from.x == 4 && target.isRook() &&
+        target.owner() == piece.owner())
+        to.x = to.x == 7 ? 6 : 2;
+
+    // Knight to queen are 1 to 4 in both encodings.
+    return Move(from, to,
+                promotion ? static_cast<Piece::Type>(promotion)
+                          : Piece::Type::None);
+}
+
+bool PolyglotBook::build(const GameDatabase& database, const QString& path,
+                         int threadCount, int maxPlies) {
+    PartitionFiles partitions(path);
+    if (!partitions.open()) return false;
+
+    std::atomic<qint64> next(0);
+    std::atomic<bool> failed(false);
+    const qint64 gameCount = database.gameCount();
+
+    auto work = [&]() {
+        std::vector<std::vector<Sample>> buffers(PartitionFiles::Count);
+        Board start;
+        QVector<Move> moves;
+        for (qint64 first = next.fetch_add(BatchSize); first < gameCount;
+             first = next.fetch_add(BatchSize)) {
+            qint64 last = qMin(first + BatchSize, gameCount);
+            for (qint64 game = first; game < last; ++game) {
+                QString result;
+                for (const auto& tag : database.tags(game))
+                    if (tag.first == "Result") result = tag.second;
+                int whiteScore = result == "1-0"       ? 2
+                                 : result == "1/2-1/2" ? 1
+                                 : result == "0-1"     ? 0
+                                                       : -1;
+                // Unfinished games say nothing about the moves.
+                if (whiteScore < 0 || !database.moves(game, start, moves))
+                    continue;
+
+                Board board = start;
+                int plies = qMin<qint64>(maxPlies, moves.size());
+                for (int ply = 0; ply < plies; ++ply) {
+                    bool white = board.currentPlayer().isWhite();
+                    Sample sample = {
+                        key(board), packMove(board, moves[ply]),
+                        quint16(white ? whiteScore : 2 - whiteScore), 0};
+                    int partition = PartitionFiles::partition(sample.key);
+                    buffers[partition].push_back(sample);
+                    if (buffers[partition].size() >= BufferSamples &&
+                        !partitions.write(partition, buffers[partition]))
+                        failed = true;
+                    board.makeMove(moves[ply]);
+                }
+            }
+        }
+        for (int i = 0; i < PartitionFiles::Count; ++i)
+            if (!partitions.write(i, buffers[i])) failed = true;
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < qMax(1, threadCount); ++i) threads.emplace_back(work);
+    for (std::thread& thread : threads) thread.join();
+
+    QFile file(path);
+    if (failed || !file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    // Partitions follow the order of keys, each is sorted on its own.
+    std::vector<Sample> samples;
+    std::vector<quint16> moveCodes;
+    std::vector<quint64> weights;
+    std::vector<RawEntry> entries;
+    for (int partition = 0; partition < PartitionFiles::Count; ++partition) {
+        if (!partitions.read(partition, samples)) return false;
+
+        std::sort(samples.begin(), samples.end(),
+                  [](const Sample& a, const Sample& b) {
+                      return a.key != b.key ? a.key < b.key
+                                            : a.move < b.move;
+                  });
+
+        entries.clear();
+        for (size_t begin = 0; begin < samples.size();) {
+            // Sums weights of the moves of one position.
+            size_t end = begin;
+            moveCodes.clear();
+            weights.clear();
+            for (; end < samples.size(); ++end) {
+                const Sample& sample = samples[end];
+                if (sample.key != samples[begin].key) break;
+                if (end == begin || sample.move != moveCodes.back()) {
+                    moveCodes.push_back(sample.move);
+                    weights.push_back(0);
+                }
+                weights.back() += sample.score;
+            }
+
+            // Large weights are scaled down to 16 bits keeping their ratio.
+            quint64 maxWeight =
+                *std::max_element(weights.begin(), weights.end());
+            size_t first = entries.size();
+            for (size_t i = 0; i < moveCodes.size(); ++i) {
+                if (weights[i] == 0) continue;
+                quint64 weight =
+                    maxWeight > 0xffff
+                        ? qMax<quint64>(1, weights[i] * 0xffff / maxWeight)
+                        : weights[i];
+                entries.push_back({samples[begin].key, moveCodes[i],
+                                   quint16(weight), 0});
+            }
+            std::stable_sort(entries.begin() + first, entries.end(),
+                             [](const RawEntry& a, const RawEntry& b) {
+                                 return a.weight > b.weight;
+                             });
+            begin = end;
+        }
+
+        for (RawEntry& entry : entries) {
+            entry.key = qToBigEndian(entry.key);
+            entry.move = qToBigEndian(entry.move);
+            entry.weight = qToBigEndian(entry.weight);
+        }
+        qint64 bytes = entries.size() * sizeof(RawEntry);
+        if (file.write(reinterpret_cast<const char*>(entries.data()),
+                       bytes) != bytes)
+            return false;
+    }
+    return file.flush();
+}
+
+bool PolyglotBook::open(const QString& path) {
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly) || m_file.size() == 0 ||
+        m_file.size() % sizeof(RawEntry) != 0) {
+        close();
+        return false;
+    }
+
+    m_map = m_file.map(0, m_file.size());
+    if (!m_map) {
+        close();
+        return false;
+    }
+    m_entries = reinterpret_cast<const RawEntry*>(m_map);
+    m_entryCount = m_file.size() / sizeof(RawEntry);
+
+    // Every opening book starts from the initial position, missing it means
+    // the book is keyed with another table.
+    if (entries(Board()).isEmpty()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void PolyglotBook::close() {
+    if (m_map) m_file.unmap(m_map);
+    m_file.close();
+
+    m_map = nullptr;
+    m_entries = nullptr;
+    m_entryCount = 0;
+}
+
+QVector<PolyglotBook::Entry> PolyglotBook::entries(const Board& board) const {
+    QVector<Entry> entries;
+    if (!m_entries) return entries;
+
+    quint64 key = PolyglotBook::key(board);
+    const RawEntry* end = m_entries + m_entryCount;
+    const RawEntry* entry = std::lower_bound(
+        m_entries, end, key, [](const RawEntry& entry, quint64 key) {
+            return qFromBigEndian(entry.key) < key;
+        });
+
+    // A key collision or a damaged book must not offer an illegal move.
+    for (; entry != end && qFromBigEndian(entry->key) == key; ++entry) {
+        Move move = unpackMove(board, qFromBigEndian(entry->move));
+        if (!board.isLegal(move)) continue;
+
+        entries.append({move, qFromBigEndian(entry->weight),
+                        qFromBigEndian(entry->learn)});
+    }
+    return entries;
+}
+
+Move PolyglotBook::pick(const Board& board, quint32 random) const {
+    QVector<Entry> entries = this->entries(board);
+    quint32 total = 0;
+    for (const Entry& entry : entries) total += entry.weight;
+    // Moves of zero weight are kept in books but never played.
+    if (total == 0) return Move::NullMove;
+
+    quint32 value = random % total;
+    for (const Entry& entry : entries) {
+        if (value < entry.weight) return entry.move;
+        value -= entry.weight;
+    }
+    return Move::NullMove;
+}
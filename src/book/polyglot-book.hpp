@@ -0,0 +1,99 @@
+#ifndef POLYGLOT_BOOK_HPP
+#define POLYGLOT_BOOK_HPP
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+#include "game/board.hpp"
+
+class GameDatabase;
+/*! \brief Opening book in the Polyglot .bin format.
+ *
+ * Book is a sorted array of 16 byte big-endian entries: position key, move,
+ * weight and learn value. The file is memory mapped, moves of a position are
+ * found by binary search over the keys.
+ *
+ * Keys are computed from 781 random numbers in the Polyglot layout. Books of
+ * other programs use the Random64 table of the Polyglot sources, which has to
+ * be loaded with loadRandomTable(). Without it a fixed built-in table is
+ * used, so books built here work with each other only. Opening a book keyed
+ * with the other table fails instead of finding no moves.
+ */
+class PolyglotBook {
+public:
+    struct Entry {
+        Move move;
+        quint16 weight;
+        quint32 learn;
+    };
+
+    PolyglotBook();
+    ~PolyglotBook();
+
+    PolyglotBook(const PolyglotBook&) = delete;
+    PolyglotBook& operator=(const PolyglotBook&) = delete;
+
+    /*! \brief Returns book shared by the application */
+    static PolyglotBook& instance();
+
+    /*! \brief Loads Random64 table from \a path, a text file with the 781
+     * numbers written as 0x prefixed hexadecimal, e.g. the Polyglot sources.
+     * Has to be called before any key is computed.
+     * \returns false if the file does not hold exactly 781 numbers or they
+     * do not give the documented key of the initial position
+     */
+    static bool loadRandomTable(const QString& path);
+
+    /*! \brief Returns true once the Polyglot Random64 table is loaded, books
+     * of other programs cannot be read without it */
+    static bool hasStandardTable();
+
+    /*! \brief Returns Polyglot key of the position */
+    static quint64 key(const Board& board);
+
+    /*! \brief Builds book at \a path from the first \a maxPlies plies of the
+     * games of \a database. Weight of a move is twice its wins plus its draws
+     * for the side playing it, moves that only lost are left out.
+     * \returns false if the book cannot be written
+     */
+    static bool build(const GameDatabase& database, const QString& path,
+                      int threadCount, int maxPlies);
+
+    /*! \brief Opens book file.
+     * \returns false if the file cannot be mapped or is not a book. A book
+     * without the initial position is refused too, its keys come from
+     * another random table, see hasStandardTable().
+     */
+    bool open(const QString& path);
+    void close();
+    bool isOpen() const { return m_entries != nullptr; }
+
+    /*! \brief Returns legal book moves of the position in file order, which
+     * is by weight for books written by common tools */
+    QVector<Entry> entries(const Board& board) const;
+
+    /*! \brief Picks a book move with probability proportional to its
+     * weight, \a random is any uniformly distributed number.
+     * \returns null move if the position is not in the book
+     */
+    Move pick(const Board& board, quint32 random) const;
+
+private:
+    struct RawEntry {
+        quint64 key;
+        quint16 move;
+        quint16 weight;
+        quint32 learn;
+    };
+    static_assert(sizeof(RawEntry) == 16, "Entry layout changed");
+
+    static quint16 packMove(const Board& board, const Move& move);
+    static Move unpackMove(const Board& board, quint16 packed);
+
+    QFile m_file;
+    uchar* m_map;
+    const RawEntry* m_entries;
+    qint64 m_entryCount;
+};
+
+#endif  // POLYGLOT_BOOK_HPP
@@ -0,0 +1,17 @@
+#ifndef BUILD_PROGRESS_HPP
+#define BUILD_PROGRESS_HPP
+#include <QtGlobal>
+#include <atomic>
+
+/*! \brief Progress of an index build, shared with the thread watching it.
+ *
+ * The build moves done towards total and gives up as soon as canceled is
+ * set. Both sides may touch the fields at any time.
+ */
+struct BuildProgress {
+    std::atomic<qint64> done{0};
+    std::atomic<qint64> total{0};
+    std::atomic<bool> canceled{false};
+};
+
+#endif  // BUILD_PROGRESS_HPP
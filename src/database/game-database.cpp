@@ -0,0 +1,275 @@
+#include "database/game-database.hpp"
+
+#include <QtEndian>
+#include <cstring>
+
+#include "database/varint.hpp"
+
+static const char DataMagic[8] = {'Q', 'T', 'C', 'G', 'A', 'M', 'E', 'S'};
+static const char IndexMagic[8] = {'Q', 'T', 'C', 'I', 'N', 'D', 'E', 'X'};
+static const char StringsMagic[8] = {'Q', 'T', 'C', 'S', 'T', 'R', 'N', 'G'};
+static const quint32 Version = 1;
+
+GameDatabase::GameDatabase()
+    : m_mode(ReadOnly),
+      m_open(false),
+      m_gameCount(0),
+      m_dataMap(nullptr),
+      m_indexMap(nullptr),
+      m_dataSize(0),
+      m_offsets(nullptr),
+      m_dataEnd(0) {}
+
+GameDatabase::~GameDatabase() { close(); }
+
+bool GameDatabase::open(const QString& path, OpenMode mode) {
+    close();
+    m_mode = mode;
+    m_data.setFileName(path);
+    m_index.setFileName(path + ".index");
+    m_strings.setFileName(path + ".strings");
+
+    if (!openFile(m_data, DataMagic) || !openFile(m_index, IndexMagic) ||
+        !openFile(m_strings, StringsMagic) || !readStrings()) {
+        close();
+        return false;
+    }
+
+    // Partly written offset at the end is ignored.
+    m_gameCount = (m_index.size() - qint64(sizeof(Header))) / sizeof(quint64);
+
+    if (mode == ReadOnly) {
+        m_dataSize = m_data.size();
+        m_dataMap = m_data.map(0, m_dataSize);
+        m_indexMap = m_index.map(0, m_index.size());
+        if (!m_dataMap || !m_indexMap) {
+            close();
+            return false;
+        }
+        m_offsets = reinterpret_cast<const quint64*>(m_indexMap +
+                                                     sizeof(Header));
+    } else {
+        m_dataEnd = m_data.size();
+        if (!m_data.seek(m_dataEnd) ||
+            !m_index.resize(sizeof(Header) + m_gameCount * sizeof(quint64)) ||
+            !m_index.seek(m_index.size()) ||
+            !m_strings.seek(m_strings.size())) {
+            close();
+            return false;
+        }
+    }
+    m_open = true;
+    return true;
+}
+
+void GameDatabase::close() {
+    if (m_dataMap) m_data.unmap(m_dataMap);
+    if (m_indexMap) m_index.unmap(m_indexMap);
+    m_data.close();
+    m_index.close();
+    m_strings.close();
+
+    m_open = false;
+    m_gameCount = 0;
+    m_dataMap = nullptr;
+    m_indexMap = nullptr;
+    m_dataSize = 0;
+    m_offsets = nullptr;
+    m_dataEnd = 0;
+    m_stringList.clear();
+    m_stringIds.clear();
+}
+
+bool GameDatabase::append(const Tree& tree) {
+    static const QString startFen = Board().toFen();
+    if (!m_open || m_mode != Append) return false;
+
+    const TreeNode* node = tree.rootNode();
+    Board board = *node->getBoard();
+
+    // FEN comes from the starting position, moves are stored as indices
+    // into its legal moves and readRecord() has to set it up again.
+    QList<QPair<QString, QString>> tags;
+    for (const auto& tag : tree.tags())
+        if (tag.first != "FEN" && tag.first != "SetUp") tags.append(tag);
+    QString fen = board.toFen();
+    if (fen != startFen) {
+        if (!Board().setFen(fen)) return false;
+        tags.append({"SetUp", "1"});
+        tags.append({"FEN", fen});
+    }
+
+    m_record.clear();
+    writeVarint(m_record, tags.size());
+    for (const auto& tag : tags) {
+        writeVarint(m_record, stringId(tag.first));
+        writeVarint(m_record, stringId(tag.second));
+    }
+
+    // No position has more than 218 legal moves, an index fits a byte.
+    QByteArray plies;
+    for (; node->hasNeighbours(); node = node->next()) {
+        Move move = node->nextMove();
+        int index = board.legalMoves().indexOf(move);
+        if (index < 0) return false;
+
+        plies.append(static_cast<char>(index));
+        board.makeMove(move);
+    }
+    writeVarint(m_record, plies.size());
+    m_record.append(plies);
+
+    // Record goes first, a crash leaves at most an unreferenced tail.
+    quint64 offset = qToLittleEndian<quint64>(m_dataEnd);
+    if (m_data.write(m_record) != m_record.size() ||
+        m_index.write(reinterpret_cast<const char*>(&offset),
+                      sizeof(offset)) != sizeof(offset))
+        return false;
+
+    m_dataEnd += m_record.size();
+    ++m_gameCount;
+    return true;
+}
+
+bool GameDatabase::flush() {
+    return m_data.flush() && m_strings.flush() && m_index.flush();
+}
+
+std::unique_ptr<Tree> GameDatabase::game(qint64 index) const {
+    QList<QPair<QString, QString>> tags;
+    Board start;
+    QVector<Move> moves;
+    if (!readRecord(index, &tags, start, &moves)) return nullptr;
+
+    auto tree = std::make_unique<Tree>(start);
+    for (const auto& tag : tags) tree->setTag(tag.first, tag.second);
+    for (const Move& move : moves) tree->addMove(move);
+    return tree;
+}
+
+QList<QPair<QString, QString>> GameDatabase::tags(qint64 index) const {
+    QList<QPair<QString, QString>> tags;
+    Board start;
+    readRecord(index, &tags, start, nullptr);
+    return tags;
+}
+
+bool GameDatabase::moves(qint64 index, Board& start,
+                         QVector<Move>& moves) const {
+    moves.clear();
+    return readRecord(index, nullptr, start, &moves);
+}
+
+bool GameDatabase::openFile(QFile& file, const char* magic) {
+    QIODevice::OpenMode flags =
+        m_mode == ReadOnly ? QIODevice::ReadOnly : QIODevice::ReadWrite;
+    if (!file.open(flags)) return false;
+
+    Header header;
+    if (file.size() == 0 && m_mode == Append) {
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, magic, sizeof(header.magic));
+        header.version = qToLittleEndian(Version);
+        return file.write(reinterpret_cast<const char*>(&header),
+                          sizeof(header)) == sizeof(header);
+    }
+
+    return file.read(reinterpret_cast<char*>(&header), sizeof(header)) ==
+               sizeof(header) &&
+           std::memcmp(header.magic, magic, sizeof(header.magic)) == 0 &&
+           qFromLittleEndian(header.version) == Version;
+}
+
+bool GameDatabase::readStrings() {
+    // Strings are stored as 16-bit length followed by UTF-8 bytes.
+    QByteArray data = m_strings.readAll();
+    const char* p = data.constData();
+    const char* end = p + data.size();
+
+    while (end - p >= 2) {
+        quint16 length = qFromLittleEndian<quint16>(p);
+        if (end - p - 2 < length) break;
+
+        QString text = QString::fromUtf8(p + 2, length);
+        m_stringIds.insert(text, m_stringList.size());
+        m_stringList.append(text);
+        p += 2 + length;
+    }
+
+    // Drop a partly written string.
+    qint64 valid = sizeof(Header) + (p - data.constData());
+    return m_mode == ReadOnly || m_strings.resize(valid);
+}
+
+quint32 GameDatabase::stringId(const QString& text) {
+    static const int MaxLength = 0xffff;
+
+    // Length is stored in 16 bits, a UTF-16 unit takes at most 3 bytes.
+    QString key = text;
+    if (text.size() > MaxLength / 3) {
+        QByteArray bytes = text.toUtf8();
+        if (bytes.size() > MaxLength) {
+            // Cut at a character boundary, the key reads back the same.
+            int length = MaxLength;
+            while (length > 0 && (bytes[length] & 0xc0) == 0x80) --length;
+            key = QString::fromUtf8(bytes.constData(), length);
+        }
+    }
+
+    auto found = m_stringIds.constFind(key);
+    if (found != m_stringIds.constEnd()) return found.value();
+
+    QByteArray bytes = key.toUtf8();
+    quint16 length = qToLittleEndian<quint16>(bytes.size());
+    m_strings.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    m_strings.write(bytes);
+
+    quint32 id = m_stringList.size();
+    m_stringIds.insert(key, id);
+    m_stringList.append(key);
+    return id;
+}
+
+bool GameDatabase::readRecord(qint64 index,
+                              QList<QPair<QString, QString>>* tags,
+                              Board& start, QVector<Move>* moves) const {
+    if (!m_dataMap || index < 0 || index >= m_gameCount) return false;
+
+    quint64 offset = qFromLittleEndian(m_offsets[index]);
+    if (offset >= quint64(m_dataSize)) return false;
+    const uchar* p = m_dataMap + offset;
+    const uchar* end = m_dataMap + m_dataSize;
+
+    quint64 tagCount;
+    if (!readVarint(p, end, tagCount)) return false;
+    start = Board();
+    for (quint64 i = 0; i < tagCount; ++i) {
+        quint64 name;
+        quint64 value;
+        if (!readVarint(p, end, name) || !readVarint(p, end, value) ||
+            name >= quint64(m_stringList.size()) ||
+            value >= quint64(m_stringList.size()))
+            return false;
+
+        const QString& tagName = m_stringList[name];
+        const QString& tagValue = m_stringList[value];
+        if (tagName == "FEN" && !start.setFen(tagValue)) return false;
+        if (tags) tags->append({tagName, tagValue});
+    }
+
+    quint64 plyCount;
+    if (!readVarint(p, end, plyCount) || quint64(end - p) < plyCount)
+        return false;
+    if (!moves) return true;
+
+    Board board = start;
+    moves->reserve(plyCount);
+    for (quint64 i = 0; i < plyCount; ++i) {
+        QVector<Move> legal = board.legalMoves();
+        if (p[i] >= legal.size()) return false;
+
+        moves->append(legal[p[i]]);
+        board.makeMove(legal[p[i]]);
+    }
+    return true;
+}
@@ -0,0 +1,106 @@
+#ifndef GAME_DATABASE_HPP
+#define GAME_DATABASE_HPP
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QVector>
+#include <memory>
+
+#include "game/board.hpp"
+#include "game/tree.hpp"
+
+/*! \brief Compact binary store of games with random access.
+ *
+ * Database at path consists of three append-only files:
+ *
+ *  - path holds game records: number of tags, pairs of string ids of tag
+ *    names and values, number of plies and one byte per ply, the index of
+ *    the move in Board::legalMoves() of the position,
+ *  - path.index holds 64-bit offsets of the records, so that any game is
+ *    found in constant time,
+ *  - path.strings is the dictionary of tag names and values, player and
+ *    event names repeat a lot and are stored once.
+ *
+ * Only the main line and tags are stored, a non-standard starting position
+ * is kept in the FEN tag. Decoding relies on the order of
+ * Board::legalMoves(), changing it requires a new format version.
+ */
+class GameDatabase {
+public:
+    enum OpenMode { ReadOnly, Append };
+
+    GameDatabase();
+    ~GameDatabase();
+
+    GameDatabase(const GameDatabase&) = delete;
+    GameDatabase& operator=(const GameDatabase&) = delete;
+
+    /*! \brief Opens database, in Append mode missing files are created.
+     * \returns false if the files cannot be opened or are not a database
+     */
+    bool open(const QString& path, OpenMode mode = ReadOnly);
+    void close();
+    bool isOpen() const { return m_open; }
+
+    /*! \brief Returns number of stored games */
+    qint64 gameCount() const { return m_gameCount; }
+
+    /*! \brief Appends main line and tags of \a tree.
+     * \returns false if the database is not open for appending, a move is
+     * illegal or the starting position cannot be stored as FEN
+     */
+    bool append(const Tree& tree);
+
+    /*! \brief Writes buffered records to disk */
+    bool flush();
+
+    /*! \brief Returns game number \a index, nullptr if there is none */
+    std::unique_ptr<Tree> game(qint64 index) const;
+
+    /*! \brief Reads tags of game \a index without replaying its moves */
+    QList<QPair<QString, QString>> tags(qint64 index) const;
+
+    /*! \brief Reads starting position and main line of game \a index.
+     * \returns false if there is no such game or its record is damaged
+     */
+    bool moves(qint64 index, Board& start, QVector<Move>& moves) const;
+
+private:
+    struct Header {
+        char magic[8];
+        quint32 version;
+        quint32 reserved;
+    };
+    static_assert(sizeof(Header) == 16, "Header layout changed");
+
+    /*! \brief Checks header of \a file or writes it to an empty one */
+    bool openFile(QFile& file, const char* magic);
+    bool readStrings();
+    /*! \brief Returns id of \a text, adding it to the dictionary if needed */
+    quint32 stringId(const QString& text);
+    /*! \brief Decodes record, \a tags and \a moves may be null */
+    bool readRecord(qint64 index, QList<QPair<QString, QString>>* tags,
+                    Board& start, QVector<Move>* moves) const;
+
+    QFile m_data;
+    QFile m_index;
+    QFile m_strings;
+    OpenMode m_mode;
+    bool m_open;
+    qint64 m_gameCount;
+    /*!< Mapped files, read-only mode only */
+    uchar* m_dataMap;
+    uchar* m_indexMap;
+    qint64 m_dataSize;
+    const quint64* m_offsets;
+    /*!< Size of the record file, append mode only */
+    qint64 m_dataEnd;
+    QVector<QString> m_stringList;
+    QHash<QString, quint32> m_stringIds;
+    QByteArray m_record;
+};
+
+#endif  // GAME_DATABASE_HPP
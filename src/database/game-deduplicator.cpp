@@ -0,0 +1,105 @@
+#include "database/game-deduplicator.hpp"
+
+#include <QHashFunctions>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "database/game-database.hpp"
+#include "game/tree.hpp"
+#include "game/zobrist.hpp"
+
+namespace {
+
+/*!< Games a worker takes at once */
+const qint64 BatchSize = 256;
+
+/*! \brief SplitMix64 finalizer */
+quint64 mix(quint64 z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+quint64 stringHash(const QString& text) {
+    return mix(qHashBits(text.constData(), text.size() * sizeof(QChar)));
+}
+
+}  // namespace
+
+GameDeduplicator::GameDeduplicator(qint64 expected)
+    : m_moves(expected), m_games(expected) {}
+
+void GameDeduplicator::addDatabase(const GameDatabase& database,
+                                   int threadCount) {
+    std::atomic<qint64> next(0);
+    const qint64 gameCount = database.gameCount();
+
+    auto work = [&]() {
+        Board start;
+        QVector<Move> moves;
+        quint32 original;
+        for (qint64 first = next.fetch_add(BatchSize); first < gameCount;
+             first = next.fetch_add(BatchSize)) {
+            qint64 last = qMin(first + BatchSize, gameCount);
+            for (qint64 game = first; game < last; ++game) {
+                // Damaged records are left out.
+                if (!database.moves(game, start, moves)) continue;
+                add(key(start, moves, database.tags(game)), game, original);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < qMax(1, threadCount); ++i) threads.emplace_back(work);
+    for (std::thread& thread : threads) thread.join();
+}
+
+GameDeduplicator::Match GameDeduplicator::add(const Key& key, quint32 id,
+                                              quint32& original) {
+    original = m_games.insert(key[1], id);
+    quint32 sameMoves = m_moves.insert(key[0], id);
+    if (original != id) return Duplicate;
+
+    original = sameMoves;
+    return original != id ? NearDuplicate : Unique;
+}
+
+GameDeduplicator::Key GameDeduplicator::key(
+    const Board& start, const QVector<Move>& moves,
+    const QList<QPair<QString, QString>>& tags) {
+    quint64 moveKey = movesHash(start, moves);
+    return {moveKey, mix(moveKey ^ mix(tagsHash(tags) + 1))};
+}
+
+GameDeduplicator::Key GameDeduplicator::key(const Tree& game) {
+    const TreeNode* node = game.rootNode();
+    Board start = *node->getBoard();
+    QVector<Move> moves;
+    for (; node->hasNeighbours(); node = node->next())
+        moves.append(node->nextMove());
+    return key(start, moves, game.tags());
+}
+
+quint64 GameDeduplicator::movesHash(const Board& start,
+                                    const QVector<Move>& moves) {
+    quint64 hash = mix(Zobrist::hash(start));
+    for (const Move& move : moves) {
+        int promotion = move.PromotionPiece == Piece::Type::None
+                            ? 0
+                            : static_cast<int>(move.PromotionPiece);
+        quint64 code = (move.From.x + 8 * move.From.y) |
+                       (move.To.x + 8 * move.To.y) << 6 | promotion << 12;
+        hash = mix(hash ^ code);
+    }
+    return hash;
+}
+
+quint64 GameDeduplicator::tagsHash(
+    const QList<QPair<QString, QString>>& tags) {
+    // Sum does not depend on the order.
+    quint64 hash = 0;
+    for (const auto& tag : tags)
+        hash += mix(stringHash(tag.first) ^ (stringHash(tag.second) << 1));
+    return hash;
+}
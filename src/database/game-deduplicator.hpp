@@ -0,0 +1,63 @@
+#ifndef GAME_DEDUPLICATOR_HPP
+#define GAME_DEDUPLICATOR_HPP
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QVector>
+#include <array>
+
+#include "database/game-hash-set.hpp"
+#include "game/board.hpp"
+
+class GameDatabase;
+class Tree;
+/*! \brief Finds games seen before by hashing their move sequences.
+ *
+ * A game is hashed twice: its starting position with the main line, and
+ * that combined with its tags. Each hash goes to its own GameHashSet, so a
+ * new game is either unique, a duplicate with the same moves and tags, or
+ * a near duplicate with the same moves and other tags. Tags are compared
+ * regardless of their order.
+ *
+ * Games are added as a stream. Ids given to add() decide which copy is the
+ * original: the lowest one, which is the earlier game when they come in
+ * order. Hashing is the costly part, key() can run on other threads, e.g.
+ * the PgnImporter parsing ones, leaving only the lookup to the stream.
+ */
+class GameDeduplicator {
+public:
+    enum Match { Unique, NearDuplicate, Duplicate };
+
+    /*! \brief Hashes of a game, the main line and the main line with tags */
+    typedef std::array<quint64, 2> Key;
+
+    /*! \brief Creates deduplicator sized for \a expected games */
+    explicit GameDeduplicator(qint64 expected = 0);
+
+    /*! \brief Adds games of \a database on a pool of threads, their ids are
+     * their indexes. Duplicates among them are not reported.
+     */
+    void addDatabase(const GameDatabase& database, int threadCount);
+
+    /*! \brief Adds game with \a key and \a id, thread-safe.
+     * \returns match with an earlier game, whose id is put in \a original
+     */
+    Match add(const Key& key, quint32 id, quint32& original);
+
+    /*! \brief Returns key of the game, thread-safe */
+    static Key key(const Board& start, const QVector<Move>& moves,
+                   const QList<QPair<QString, QString>>& tags);
+    static Key key(const Tree& game);
+
+    /*! \brief Returns hash of the starting position and main line */
+    static quint64 movesHash(const Board& start, const QVector<Move>& moves);
+
+    /*! \brief Returns hash of the tags in any order */
+    static quint64 tagsHash(const QList<QPair<QString, QString>>& tags);
+
+private:
+    GameHashSet m_moves;
+    GameHashSet m_games;
+};
+
+#endif  // GAME_DEDUPLICATOR_HPP
@@ -0,0 +1,102 @@
+#include "database/game-hash-set.hpp"
+
+#include <mutex>
+
+/*!< Smallest number of slots */
+static const quint64 MinCapacity = 1024;
+
+GameHashSet::GameHashSet(qint64 expected) : m_size(0) {
+    quint64 capacity = MinCapacity;
+    while (capacity * 3 < quint64(qMax<qint64>(0, expected)) * 4)
+        capacity *= 2;
+
+    m_hashes.reset(new std::atomic<quint64>[capacity]);
+    m_ids.reset(new std::atomic<quint32>[capacity]);
+    for (quint64 i = 0; i < capacity; ++i) {
+        m_hashes[i].store(0, std::memory_order_relaxed);
+        m_ids[i].store(0, std::memory_order_relaxed);
+    }
+    m_mask = capacity - 1;
+}
+
+quint32 GameHashSet::insert(quint64 hash, quint32 id) {
+    if (hash == 0) hash = 1;
+
+    while (true) {
+        std::shared_lock<std::shared_mutex> lock(m_lock);
+        quint64 capacity = m_mask + 1;
+        // Threads inserting at once may go a little beyond the limit, the
+        // table still has a quarter free.
+        if (quint64(size() + 1) * 4 > capacity * 3) {
+            lock.unlock();
+            grow(capacity);
+            continue;
+        }
+
+        for (quint64 slot = hash & m_mask;; slot = (slot + 1) & m_mask) {
+            quint64 current = m_hashes[slot].load(std::memory_order_acquire);
+            if (current == 0 &&
+                m_hashes[slot].compare_exchange_strong(
+                    current, hash, std::memory_order_acq_rel)) {
+                m_size.fetch_add(1, std::memory_order_relaxed);
+                current = hash;
+            }
+            if (current != hash) continue;
+
+            // Lowest id wins, another thread may have claimed the slot and
+            // not stored its id yet.
+            quint32 stored = m_ids[slot].load(std::memory_order_acquire);
+            while ((stored == 0 || id + 1 < stored) &&
+                   !m_ids[slot].compare_exchange_weak(
+                       stored, id + 1, std::memory_order_acq_rel))
+                ;
+            return stored == 0 || id + 1 < stored ? id : stored - 1;
+        }
+    }
+}
+
+qint64 GameHashSet::find(quint64 hash) const {
+    if (hash == 0) hash = 1;
+
+    std::shared_lock<std::shared_mutex> lock(m_lock);
+    for (quint64 slot = hash & m_mask;; slot = (slot + 1) & m_mask) {
+        quint64 current = m_hashes[slot].load(std::memory_order_acquire);
+        if (current == 0) return -1;
+        if (current != hash) continue;
+
+        quint32 stored = m_ids[slot].load(std::memory_order_acquire);
+        return stored == 0 ? -1 : qint64(stored) - 1;
+    }
+}
+
+void GameHashSet::grow(quint64 capacity) {
+    std::unique_lock<std::shared_mutex> lock(m_lock);
+    if (m_mask + 1 != capacity) return;
+
+    quint64 newCapacity = capacity * 2;
+    quint64 newMask = newCapacity - 1;
+    std::unique_ptr<std::atomic<quint64>[]> hashes(
+        new std::atomic<quint64>[newCapacity]);
+    std::unique_ptr<std::atomic<quint32>[]> ids(
+        new std::atomic<quint32>[newCapacity]);
+    for (quint64 i = 0; i < newCapacity; ++i) {
+        hashes[i].store(0, std::memory_order_relaxed);
+        ids[i].store(0, std::memory_order_relaxed);
+    }
+
+    for (quint64 i = 0; i < capacity; ++i) {
+        quint64 hash = m_hashes[i].load(std::memory_order_relaxed);
+        if (hash == 0) continue;
+
+        quint64 slot = hash & newMask;
+        while (hashes[slot].load(std::memory_order_relaxed) != 0)
+            slot = (slot + 1) & newMask;
+        hashes[slot].store(hash, std::memory_order_relaxed);
+        ids[slot].store(m_ids[i].load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+    }
+
+    m_hashes = std::move(hashes);
+    m_ids = std::move(ids);
+    m_mask = newMask;
+}
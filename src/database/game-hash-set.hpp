@@ -0,0 +1,52 @@
+#ifndef GAME_HASH_SET_HPP
+#define GAME_HASH_SET_HPP
+#include <QtGlobal>
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+
+/*! \brief Set of 64-bit game hashes with the lowest id of the games having
+ * each of them.
+ *
+ * Open addressing with linear probing in two flat arrays, 12 bytes per
+ * slot. The table doubles when it is three quarters full, which averages
+ * to about 20 bytes per game. Inserts from several threads run in parallel
+ * without locking each other, only growing the table stops them.
+ *
+ * Growing keeps the old table until it is copied, so it peaks at three
+ * times its size, e.g. 2.3 GB when 64M slots double. Sizing the set for
+ * the expected number of games avoids that.
+ */
+class GameHashSet {
+public:
+    /*! \brief Creates set sized for \a expected hashes, it grows beyond */
+    explicit GameHashSet(qint64 expected = 0);
+
+    GameHashSet(const GameHashSet&) = delete;
+    GameHashSet& operator=(const GameHashSet&) = delete;
+
+    /*! \brief Adds \a hash of game \a id, which must be below 2^32 - 1.
+     * \returns lowest id added with the hash so far, \a id if it is new
+     */
+    quint32 insert(quint64 hash, quint32 id);
+
+    /*! \brief Returns lowest id added with \a hash, -1 if there is none */
+    qint64 find(quint64 hash) const;
+
+    /*! \brief Returns number of distinct hashes */
+    qint64 size() const { return m_size.load(std::memory_order_relaxed); }
+
+private:
+    /*! \brief Doubles the table unless another thread already did */
+    void grow(quint64 capacity);
+
+    /*!< Hashes, 0 marks an empty slot and stands for itself as 1 */
+    std::unique_ptr<std::atomic<quint64>[]> m_hashes;
+    /*!< Lowest id + 1 of every slot, 0 until it is stored */
+    std::unique_ptr<std::atomic<quint32>[]> m_ids;
+    quint64 m_mask;
+    std::atomic<qint64> m_size;
+    mutable std::shared_mutex m_lock;
+};
+
+#endif  // GAME_HASH_SET_HPP
@@ -0,0 +1,298 @@
+#include "database/opening-explorer.hpp"
+
+#include <QtEndian>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "database/build-progress.hpp"
+#include "database/game-database.hpp"
+#include "database/partition-files.hpp"
+#include "game/zobrist.hpp"
+
+static const char Magic[8] = {'Q', 'T', 'C', 'E', 'X', 'P', 'L', 'R'};
+// 2: en passant file hashed only when a capture is possible.
+static const quint32 Version = 2;
+
+namespace {
+
+enum Result : quint8 { WhiteWin, Draw, BlackWin, Unknown };
+
+/*! \brief Move played in a game, as written to partition files */
+struct Sample {
+    quint64 hash;
+    quint32 game;
+    quint16 move;
+    /*!< Average rating of the players, 0 if unknown */
+    quint16 rating;
+    quint8 result;
+    quint8 reserved[7];
+};
+static_assert(sizeof(Sample) == 24, "Sample layout changed");
+
+/*!< Samples a worker collects per partition before writing them */
+const size_t BufferSamples = 2048;
+/*!< Games a worker takes at once */
+const qint64 BatchSize = 256;
+
+}  // namespace
+
+// Same packing as the analysis cache.
+static quint16 packMove(const Move& move) {
+    int promotion = move.PromotionPiece == Piece::Type::None
+                        ? 0
+                        : static_cast<int>(move.PromotionPiece);
+    return (move.From.x + 8 * move.From.y) |
+           (move.To.x + 8 * move.To.y) << 6 | promotion << 12;
+}
+
+static Move unpackMove(quint16 packed) {
+    int from = packed & 63;
+    int to = (packed >> 6) & 63;
+    int promotion = (packed >> 12) & 7;
+
+    return Move(Coord2D<int>(from % 8, from / 8), Coord2D<int>(to % 8, to / 8),
+                promotion ? static_cast<Piece::Type>(promotion)
+                          : Piece::Type::None);
+}
+
+/*! \brief Reads result and average rating from tags of a game */
+static void readTags(const QList<QPair<QString, QString>>& tags,
+                     quint8& result, quint16& rating) {
+    result = Unknown;
+    int ratingSum = 0;
+    int ratingCount = 0;
+    for (const auto& tag : tags) {
+        if (tag.first == "Result") {
+            if (tag.second == "1-0")
+                result = WhiteWin;
+            else if (tag.second == "1/2-1/2")
+                result = Draw;
+            else if (tag.second == "0-1")
+                result = BlackWin;
+        } else if (tag.first == "WhiteElo" || tag.first == "BlackElo") {
+            int elo = tag.second.toInt();
+            if (elo > 0 && elo < 65536) {
+                ratingSum += elo;
+                ++ratingCount;
+            }
+        }
+    }
+    rating = ratingCount ? ratingSum / ratingCount : 0;
+}
+
+OpeningExplorer::OpeningExplorer()
+    : m_map(nullptr), m_entries(nullptr), m_entryCount(0), m_indexedGames(0) {}
+
+OpeningExplorer::~OpeningExplorer() { close(); }
+
+bool OpeningExplorer::build(const GameDatabase& database,
+                            const QString& databasePath, int threadCount,
+                            BuildProgress* progress) {
+    QString path = databasePath + ".explorer";
+    PartitionFiles partitions(path);
+    if (!partitions.open()) return false;
+
+    std::atomic<qint64> next(0);
+    std::atomic<bool> failed(false);
+    const qint64 gameCount = database.gameCount();
+    // Reading games and sorting partitions count as a half each.
+    if (progress) progress->total = 2 * gameCount;
+    auto canceled = [progress]() { return progress && progress->canceled; };
+
+    auto work = [&]() {
+        std::vector<std::vector<Sample>> buffers(PartitionFiles::Count);
+        Board start;
+        QVector<Move> moves;
+        for (qint64 first = next.fetch_add(BatchSize);
+             first < gameCount && !canceled();
+             first = next.fetch_add(BatchSize)) {
+            qint64 last = qMin(first + BatchSize, gameCount);
+            for (qint64 game = first; game < last; ++game) {
+                // Damaged records are left out.
+                if (!database.moves(game, start, moves)) continue;
+
+                Sample sample;
+                std::memset(&sample, 0, sizeof(sample));
+                sample.game = game;
+                readTags(database.tags(game), sample.result, sample.rating);
+
+                Board board = start;
+                for (const Move& move : moves) {
+                    sample.hash = Zobrist::hash(board);
+                    sample.move = packMove(move);
+                    int partition = PartitionFiles::partition(sample.hash);
+                    buffers[partition].push_back(sample);
+                    if (buffers[partition].size() >= BufferSamples &&
+                        !partitions.write(partition, buffers[partition]))
+                        failed = true;
+                    board.makeMove(move);
+                }
+            }
+            if (progress) progress->done += last - first;
+        }
+        for (int i = 0; i < PartitionFiles::Count; ++i)
+            if (!partitions.write(i, buffers[i])) failed = true;
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < qMax(1, threadCount); ++i) threads.emplace_back(work);
+    for (std::thread& thread : threads) thread.join();
+
+    QFile file(path);
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    header.version = qToLittleEndian(Version);
+    if (failed || canceled() ||
+        !file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header)) !=
+            sizeof(header))
+        return false;
+
+    // Partitions follow the order of hashes, each is sorted on its own.
+    quint64 entryCount = 0;
+    std::vector<Sample> samples;
+    std::vector<Entry> entries;
+    for (int partition = 0; partition < PartitionFiles::Count; ++partition) {
+        // Header is still blank, open() rejects the partial file.
+        if (canceled() || !partitions.read(partition, samples)) return false;
+
+        std::sort(samples.begin(), samples.end(),
+                  [](const Sample& a, const Sample& b) {
+                      if (a.hash != b.hash) return a.hash < b.hash;
+                      return a.move != b.move ? a.move < b.move
+                                              : a.game < b.game;
+                  });
+
+        entries.clear();
+        for (size_t i = 0; i < samples.size(); ++i) {
+            const Sample& sample = samples[i];
+            bool sameMove = i > 0 && samples[i - 1].hash == sample.hash &&
+                            samples[i - 1].move == sample.move;
+            // Move repeated within one game is counted once.
+            if (sameMove && samples[i - 1].game == sample.game) continue;
+
+            if (!sameMove) {
+                Entry entry;
+                std::memset(&entry, 0, sizeof(entry));
+                entry.hash = sample.hash;
+                entry.move = sample.move;
+                entries.push_back(entry);
+            }
+            Entry& entry = entries.back();
+            ++entry.games;
+            if (sample.result == WhiteWin) ++entry.whiteWins;
+            if (sample.result == Draw) ++entry.draws;
+            if (sample.result == BlackWin) ++entry.blackWins;
+            if (sample.rating) {
+                ++entry.ratedGames;
+                entry.ratingSum += sample.rating;
+            }
+        }
+
+        for (Entry& entry : entries) {
+            entry.hash = qToLittleEndian(entry.hash);
+            entry.move = qToLittleEndian(entry.move);
+            entry.games = qToLittleEndian(entry.games);
+            entry.whiteWins = qToLittleEndian(entry.whiteWins);
+            entry.draws = qToLittleEndian(entry.draws);
+            entry.blackWins = qToLittleEndian(entry.blackWins);
+            entry.ratedGames = qToLittleEndian(entry.ratedGames);
+            entry.ratingSum = qToLittleEndian(entry.ratingSum);
+        }
+        qint64 bytes = entries.size() * sizeof(Entry);
+        if (file.write(reinterpret_cast<const char*>(entries.data()),
+                       bytes) != bytes)
+            return false;
+        entryCount += entries.size();
+        if (progress)
+            progress->done =
+                gameCount + gameCount * (partition + 1) / PartitionFiles::Count;
+    }
+
+    std::memcpy(header.magic, Magic, sizeof(header.magic));
+    header.entryCount = qToLittleEndian(entryCount);
+    header.gameCount = qToLittleEndian<quint64>(gameCount);
+    return file.seek(0) &&
+           file.write(reinterpret_cast<const char*>(&header),
+                      sizeof(header)) == sizeof(header) &&
+           file.flush();
+}
+
+bool OpeningExplorer::open(const QString& databasePath) {
+    close();
+    m_file.setFileName(databasePath + ".explorer");
+    if (!m_file.open(QIODevice::ReadOnly)) return false;
+
+    Header header;
+    bool valid =
+        m_file.read(reinterpret_cast<char*>(&header), sizeof(header)) ==
+            sizeof(header) &&
+        std::memcmp(header.magic, Magic, sizeof(header.magic)) == 0 &&
+        qFromLittleEndian(header.version) == Version &&
+        m_file.size() ==
+            qint64(sizeof(Header) +
+                   qFromLittleEndian(header.entryCount) * sizeof(Entry));
+    if (!valid) {
+        close();
+        return false;
+    }
+
+    m_map = m_file.map(0, m_file.size());
+    if (!m_map) {
+        close();
+        return false;
+    }
+
+    m_entries = reinterpret_cast<const Entry*>(m_map + sizeof(Header));
+    m_entryCount = qFromLittleEndian(header.entryCount);
+    m_indexedGames = qFromLittleEndian(header.gameCount);
+    return true;
+}
+
+void OpeningExplorer::close() {
+    if (m_map) m_file.unmap(m_map);
+    m_file.close();
+
+    m_map = nullptr;
+    m_entries = nullptr;
+    m_entryCount = 0;
+    m_indexedGames = 0;
+}
+
+QVector<OpeningExplorer::MoveStats> OpeningExplorer::moves(
+    const Board& board) const {
+    QVector<MoveStats> moves;
+    if (!m_entries) return moves;
+
+    quint64 hash = Zobrist::hash(board);
+    const Entry* end = m_entries + m_entryCount;
+    const Entry* entry = std::lower_bound(
+        m_entries, end, hash, [](const Entry& entry, quint64 hash) {
+            return qFromLittleEndian(entry.hash) < hash;
+        });
+
+    // A hash collision must not offer an illegal move.
+    QVector<Move> legal;
+    for (; entry != end && qFromLittleEndian(entry->hash) == hash; ++entry) {
+        if (legal.isEmpty()) legal = board.legalMoves();
+        Move move = unpackMove(qFromLittleEndian(entry->move));
+        if (!legal.contains(move)) continue;
+
+        quint32 rated = qFromLittleEndian(entry->ratedGames);
+        quint64 ratingSum = qFromLittleEndian(entry->ratingSum);
+        moves.append({move, qFromLittleEndian(entry->games),
+                      qFromLittleEndian(entry->whiteWins),
+                      qFromLittleEndian(entry->draws),
+                      qFromLittleEndian(entry->blackWins),
+                      rated ? int(ratingSum / rated) : 0});
+    }
+
+    std::stable_sort(moves.begin(), moves.end(),
+                     [](const MoveStats& a, const MoveStats& b) {
+                         return a.games > b.games;
+                     });
+    return moves;
+}
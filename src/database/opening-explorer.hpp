@@ -0,0 +1,91 @@
+#ifndef OPENING_EXPLORER_HPP
+#define OPENING_EXPLORER_HPP
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+#include "game/board.hpp"
+
+struct BuildProgress;
+class GameDatabase;
+/*! \brief Precomputed statistics of moves played in positions of a game
+ * database.
+ *
+ * Explorer of a database at path is path.explorer, a table of entries
+ * sorted by Zobrist hash of the position and the move, each holding the
+ * number of games, their results and the sum of average ratings of the
+ * players. The file is memory mapped, all moves of a position are a binary
+ * search and a run of adjacent entries.
+ */
+class OpeningExplorer {
+public:
+    struct MoveStats {
+        Move move;
+        quint32 games;
+        quint32 whiteWins;
+        quint32 draws;
+        quint32 blackWins;
+        /*!< Mean of average ratings of the players, 0 if no game is rated */
+        int averageRating;
+    };
+
+    OpeningExplorer();
+    ~OpeningExplorer();
+
+    OpeningExplorer(const OpeningExplorer&) = delete;
+    OpeningExplorer& operator=(const OpeningExplorer&) = delete;
+
+    /*! \brief Builds explorer of \a database stored at \a databasePath,
+     * reporting to \a progress if given.
+     * \returns false if the explorer file cannot be written or the build
+     * was canceled
+     */
+    static bool build(const GameDatabase& database,
+                      const QString& databasePath, int threadCount,
+                      BuildProgress* progress = nullptr);
+
+    /*! \brief Opens explorer of the database at \a databasePath.
+     * \returns false if there is no valid explorer file
+     */
+    bool open(const QString& databasePath);
+    void close();
+    bool isOpen() const { return m_entries != nullptr; }
+
+    /*! \brief Returns number of games the explorer was built from */
+    qint64 indexedGames() const { return m_indexedGames; }
+
+    /*! \brief Returns legal moves played in \a board, most played first */
+    QVector<MoveStats> moves(const Board& board) const;
+
+private:
+    struct Header {
+        char magic[8];
+        quint32 version;
+        quint32 reserved;
+        quint64 entryCount;
+        quint64 gameCount;
+    };
+
+    struct Entry {
+        quint64 hash;
+        /*!< Move packed as from | to << 6 | promotion << 12 */
+        quint16 move;
+        quint16 reserved;
+        quint32 games;
+        quint32 whiteWins;
+        quint32 draws;
+        quint32 blackWins;
+        quint32 ratedGames;
+        quint64 ratingSum;
+    };
+    static_assert(sizeof(Header) == 32, "Header layout changed");
+    static_assert(sizeof(Entry) == 40, "Entry layout changed");
+
+    QFile m_file;
+    uchar* m_map;
+    const Entry* m_entries;
+    qint64 m_entryCount;
+    qint64 m_indexedGames;
+};
+
+#endif  // OPENING_EXPLORER_HPP
@@ -0,0 +1,26 @@
+#include "database/partition-files.hpp"
+
+PartitionFiles::PartitionFiles(const QString& basePath) : m_locks(Count) {
+    for (int i = 0; i < Count; ++i)
+        m_files.push_back(std::make_unique<QFile>(
+            QString("%1.part%2").arg(basePath).arg(i)));
+}
+
+PartitionFiles::~PartitionFiles() {
+    for (auto& file : m_files) file->remove();
+}
+
+bool PartitionFiles::open() {
+    for (auto& file : m_files)
+        if (!file->open(QIODevice::ReadWrite | QIODevice::Truncate))
+            return false;
+    return true;
+}
+
+bool PartitionFiles::write(int partition, const void* data, qint64 bytes) {
+    if (bytes == 0) return true;
+
+    std::lock_guard<std::mutex> lock(m_locks[partition]);
+    return m_files[partition]->write(static_cast<const char*>(data),
+                                     bytes) == bytes;
+}
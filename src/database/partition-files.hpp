@@ -0,0 +1,65 @@
+#ifndef PARTITION_FILES_HPP
+#define PARTITION_FILES_HPP
+#include <QFile>
+#include <QString>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/*! \brief Temporary files fixed-size records are spread over while building
+ * an index.
+ *
+ * Records are assigned a partition by the top bits of their key, so every
+ * partition is sorted in memory on its own and partitions read in order give
+ * the whole sorted sequence. Writing is thread-safe, the files are removed
+ * once read or when the object is destroyed.
+ */
+class PartitionFiles {
+public:
+    static const int Bits = 8;
+    static const int Count = 1 << Bits;
+
+    explicit PartitionFiles(const QString& basePath);
+    ~PartitionFiles();
+
+    PartitionFiles(const PartitionFiles&) = delete;
+    PartitionFiles& operator=(const PartitionFiles&) = delete;
+
+    /*! \brief Creates the files.
+     * \returns false if any of them cannot be created
+     */
+    bool open();
+
+    /*! \brief Returns partition of a 64-bit key */
+    static int partition(quint64 key) { return key >> (64 - Bits); }
+
+    /*! \brief Appends \a records to \a partition, \a records is cleared */
+    template <typename Record>
+    bool write(int partition, std::vector<Record>& records) {
+        bool written = write(partition, records.data(),
+                             records.size() * sizeof(Record));
+        records.clear();
+        return written;
+    }
+
+    /*! \brief Reads all records of \a partition and removes its file */
+    template <typename Record>
+    bool read(int partition, std::vector<Record>& records) {
+        QFile& file = *m_files[partition];
+        records.resize(file.size() / sizeof(Record));
+        qint64 bytes = records.size() * sizeof(Record);
+        bool read = file.seek(0) &&
+                    file.read(reinterpret_cast<char*>(records.data()),
+                              bytes) == bytes;
+        file.remove();
+        return read;
+    }
+
+private:
+    bool write(int partition, const void* data, qint64 bytes);
+
+    std::vector<std::unique_ptr<QFile>> m_files;
+    std::vector<std::mutex> m_locks;
+};
+
+#endif  // PARTITION_FILES_HPP
@@ -0,0 +1,278 @@
+#include "database/position-index.hpp"
+
+#include <QtEndian>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "database/build-progress.hpp"
+#include "database/game-database.hpp"
+#include "database/partition-files.hpp"
+#include "database/varint.hpp"
+#include "game/zobrist.hpp"
+
+static const char KeysMagic[8] = {'Q', 'T', 'C', 'P', 'O', 'S', 'I', 'X'};
+static const char PostingsMagic[8] = {'Q', 'T', 'C', 'P', 'O', 'S', 'T',
+                                      'S'};
+// 2: en passant file hashed only when a capture is possible.
+static const quint32 Version = 2;
+
+namespace {
+
+/*! \brief Position reached in a game, as written to partition files */
+struct Pair {
+    quint64 hash;
+    quint32 game;
+    quint32 reserved;
+};
+
+/*!< Pairs a worker collects per partition before writing them */
+const size_t BufferPairs = 2048;
+/*!< Games a worker takes at once */
+const qint64 BatchSize = 256;
+
+}  // namespace
+
+PositionIndex::PositionIndex()
+    : m_keysMap(nullptr),
+      m_postingsMap(nullptr),
+      m_postingsSize(0),
+      m_keys(nullptr),
+      m_keyCount(0),
+      m_indexedGames(0) {}
+
+PositionIndex::~PositionIndex() { close(); }
+
+bool PositionIndex::build(const GameDatabase& database,
+                          const QString& databasePath, int threadCount,
+                          BuildProgress* progress) {
+    QString keysPath = databasePath + ".positions";
+    PartitionFiles partitions(keysPath);
+    if (!partitions.open()) return false;
+
+    std::atomic<qint64> next(0);
+    std::atomic<bool> failed(false);
+    const qint64 gameCount = database.gameCount();
+    // Reading games and sorting partitions count as a half each.
+    if (progress) progress->total = 2 * gameCount;
+    auto canceled = [progress]() { return progress && progress->canceled; };
+
+    auto work = [&]() {
+        std::vector<std::vector<Pair>> buffers(PartitionFiles::Count);
+        auto add = [&](quint64 hash, quint32 game) {
+            int partition = PartitionFiles::partition(hash);
+            buffers[partition].push_back({hash, game, 0});
+            if (buffers[partition].size() >= BufferPairs &&
+                !partitions.write(partition, buffers[partition]))
+                failed = true;
+        };
+
+        Board start;
+        QVector<Move> moves;
+        for (qint64 first = next.fetch_add(BatchSize);
+             first < gameCount && !canceled();
+             first = next.fetch_add(BatchSize)) {
+            qint64 last = qMin(first + BatchSize, gameCount);
+            for (qint64 game = first; game < last; ++game) {
+                // Damaged records are left out.
+                if (!database.moves(game, start, moves)) continue;
+
+                Board board = start;
+                add(Zobrist::hash(board), game);
+                for (const Move& move : moves) {
+                    board.makeMove(move);
+                    add(Zobrist::hash(board), game);
+                }
+            }
+            if (progress) progress->done += last - first;
+        }
+        for (int i = 0; i < PartitionFiles::Count; ++i)
+            if (!partitions.write(i, buffers[i])) failed = true;
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < qMax(1, threadCount); ++i) threads.emplace_back(work);
+    for (std::thread& thread : threads) thread.join();
+
+    QFile keys(keysPath);
+    QFile postings(databasePath + ".postings");
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    header.version = qToLittleEndian(Version);
+    if (failed || canceled() ||
+        !keys.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+        !postings.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+        keys.write(reinterpret_cast<const char*>(&header), sizeof(header)) !=
+            sizeof(header) ||
+        postings.write(reinterpret_cast<const char*>(&header),
+                       sizeof(header)) != sizeof(header))
+        return false;
+
+    // Partitions follow the order of hashes, each is sorted on its own.
+    quint64 keyCount = 0;
+    qint64 postingsOffset = sizeof(Header);
+    std::vector<Key> keyBuffer;
+    QByteArray postingBuffer;
+    std::vector<Pair> pairs;
+    for (int partition = 0; partition < PartitionFiles::Count; ++partition) {
+        // Header is still blank, open() rejects the partial index.
+        if (canceled() || !partitions.read(partition, pairs)) return false;
+
+        std::sort(pairs.begin(), pairs.end(),
+                  [](const Pair& a, const Pair& b) {
+                      return a.hash != b.hash ? a.hash < b.hash
+                                              : a.game < b.game;
+                  });
+
+        keyBuffer.clear();
+        postingBuffer.clear();
+        for (size_t begin = 0; begin < pairs.size();) {
+            size_t end = begin + 1;
+            quint64 unique = 1;
+            for (; end < pairs.size() && pairs[end].hash == pairs[begin].hash;
+                 ++end)
+                if (pairs[end].game != pairs[end - 1].game) ++unique;
+
+            keyBuffer.push_back(
+                {qToLittleEndian(pairs[begin].hash),
+                 qToLittleEndian<quint64>(postingsOffset +
+                                          postingBuffer.size())});
+            writeVarint(postingBuffer, unique);
+            quint32 previous = 0;
+            for (size_t i = begin; i < end; ++i) {
+                // Repeated position of one game is stored once.
+                if (i > begin && pairs[i].game == pairs[i - 1].game) continue;
+                writeVarint(postingBuffer, pairs[i].game - previous);
+                previous = pairs[i].game;
+            }
+            begin = end;
+        }
+
+        qint64 keyBytes = keyBuffer.size() * sizeof(Key);
+        if (keys.write(reinterpret_cast<const char*>(keyBuffer.data()),
+                       keyBytes) != keyBytes ||
+            postings.write(postingBuffer) != postingBuffer.size())
+            return false;
+        keyCount += keyBuffer.size();
+        postingsOffset += postingBuffer.size();
+        if (progress)
+            progress->done =
+                gameCount + gameCount * (partition + 1) / PartitionFiles::Count;
+    }
+
+    header.keyCount = qToLittleEndian(keyCount);
+    header.gameCount = qToLittleEndian<quint64>(gameCount);
+    std::memcpy(header.magic, KeysMagic, sizeof(header.magic));
+    bool written = keys.seek(0) &&
+                   keys.write(reinterpret_cast<const char*>(&header),
+                              sizeof(header)) == sizeof(header);
+    std::memcpy(header.magic, PostingsMagic, sizeof(header.magic));
+    written = written && postings.seek(0) &&
+              postings.write(reinterpret_cast<const char*>(&header),
+                             sizeof(header)) == sizeof(header);
+    return written && keys.flush() && postings.flush();
+}
+
+bool PositionIndex::open(const QString& databasePath) {
+    close();
+    m_keysFile.setFileName(databasePath + ".positions");
+    m_postingsFile.setFileName(databasePath + ".postings");
+    if (!m_keysFile.open(QIODevice::ReadOnly) ||
+        !m_postingsFile.open(QIODevice::ReadOnly)) {
+        close();
+        return false;
+    }
+
+    Header header;
+    Header postingsHeader;
+    bool valid =
+        m_keysFile.read(reinterpret_cast<char*>(&header), sizeof(header)) ==
+            sizeof(header) &&
+        m_postingsFile.read(reinterpret_cast<char*>(&postingsHeader),
+                            sizeof(postingsHeader)) ==
+            sizeof(postingsHeader) &&
+        std::memcmp(header.magic, KeysMagic, sizeof(header.magic)) == 0 &&
+        std::memcmp(postingsHeader.magic, PostingsMagic,
+                    sizeof(postingsHeader.magic)) == 0 &&
+        qFromLittleEndian(header.version) == Version &&
+        // Postings of another build would give wrong games.
+        postingsHeader.keyCount == header.keyCount &&
+        m_keysFile.size() ==
+            qint64(sizeof(Header) +
+                   qFromLittleEndian(header.keyCount) * sizeof(Key));
+    if (!valid) {
+        close();
+        return false;
+    }
+
+    m_postingsSize = m_postingsFile.size();
+    m_keysMap = m_keysFile.map(0, m_keysFile.size());
+    m_postingsMap = m_postingsFile.map(0, m_postingsSize);
+    if (!m_keysMap || !m_postingsMap) {
+        close();
+        return false;
+    }
+    m_keys = reinterpret_cast<const Key*>(m_keysMap + sizeof(Header));
+    m_keyCount = qFromLittleEndian(header.keyCount);
+    m_indexedGames = qFromLittleEndian(header.gameCount);
+    return true;
+}
+
+void PositionIndex::close() {
+    if (m_keysMap) m_keysFile.unmap(m_keysMap);
+    if (m_postingsMap) m_postingsFile.unmap(m_postingsMap);
+    m_keysFile.close();
+    m_postingsFile.close();
+
+    m_keysMap = nullptr;
+    m_postingsMap = nullptr;
+    m_postingsSize = 0;
+    m_keys = nullptr;
+    m_keyCount = 0;
+    m_indexedGames = 0;
+}
+
+qint64 PositionIndex::gameCount(quint64 hash) const {
+    const uchar* p = posting(hash);
+    quint64 count;
+    if (!p || !readVarint(p, m_postingsMap + m_postingsSize, count))
+        return 0;
+    return count;
+}
+
+QVector<quint32> PositionIndex::games(quint64 hash, int limit) const {
+    QVector<quint32> games;
+    const uchar* p = posting(hash);
+    const uchar* end = m_postingsMap + m_postingsSize;
+    quint64 count;
+    if (!p || !readVarint(p, end, count)) return games;
+
+    if (limit >= 0) count = qMin<quint64>(count, limit);
+    games.reserve(count);
+    quint64 game = 0;
+    for (quint64 i = 0; i < count; ++i) {
+        quint64 delta;
+        if (!readVarint(p, end, delta)) break;
+        game += delta;
+        games.append(game);
+    }
+    return games;
+}
+
+const uchar* PositionIndex::posting(quint64 hash) const {
+    if (!m_keys) return nullptr;
+
+    const Key* end = m_keys + m_keyCount;
+    const Key* found = std::lower_bound(
+        m_keys, end, hash, [](const Key& key, quint64 hash) {
+            return qFromLittleEndian(key.hash) < hash;
+        });
+    if (found == end || qFromLittleEndian(found->hash) != hash)
+        return nullptr;
+
+    quint64 offset = qFromLittleEndian(found->offset);
+    if (offset >= quint64(m_postingsSize)) return nullptr;
+    return m_postingsMap + offset;
+}
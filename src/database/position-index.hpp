@@ -0,0 +1,85 @@
+#ifndef POSITION_INDEX_HPP
+#define POSITION_INDEX_HPP
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+struct BuildProgress;
+class GameDatabase;
+/*! \brief On-disk index from positions to the games reaching them.
+ *
+ * Index of a database at path consists of path.positions, a sorted table
+ * of Zobrist hashes with offsets of their postings, and path.postings, where
+ * every posting is the number of games followed by the ascending game ids
+ * as LEB128 deltas. Both files are memory mapped, a lookup is a binary
+ * search and decoding of a single posting, transpositions included.
+ *
+ * Building runs on a pool of threads. Hashes are spread over partition files
+ * by their top bits, so every partition is sorted on its own and the table
+ * comes out in order without sorting everything in memory.
+ */
+class PositionIndex {
+public:
+    PositionIndex();
+    ~PositionIndex();
+
+    PositionIndex(const PositionIndex&) = delete;
+    PositionIndex& operator=(const PositionIndex&) = delete;
+
+    /*! \brief Builds index of \a database stored at \a databasePath,
+     * reporting to \a progress if given.
+     * \returns false if the index files cannot be written or the build was
+     * canceled
+     */
+    static bool build(const GameDatabase& database,
+                      const QString& databasePath, int threadCount,
+                      BuildProgress* progress = nullptr);
+
+    /*! \brief Opens index of the database at \a databasePath.
+     * \returns false if there is no valid index
+     */
+    bool open(const QString& databasePath);
+    void close();
+    bool isOpen() const { return m_keys != nullptr; }
+
+    /*! \brief Returns number of games the index was built from, an index
+     * with fewer games than the database is stale */
+    qint64 indexedGames() const { return m_indexedGames; }
+
+    /*! \brief Returns number of games reaching the position */
+    qint64 gameCount(quint64 hash) const;
+
+    /*! \brief Returns ids of games reaching the position in ascending order,
+     * at most \a limit of them unless it is negative */
+    QVector<quint32> games(quint64 hash, int limit = -1) const;
+
+private:
+    struct Header {
+        char magic[8];
+        quint32 version;
+        quint32 reserved;
+        quint64 keyCount;
+        quint64 gameCount;
+    };
+
+    struct Key {
+        quint64 hash;
+        quint64 offset;
+    };
+    static_assert(sizeof(Header) == 32, "Header layout changed");
+    static_assert(sizeof(Key) == 16, "Key layout changed");
+
+    /*! \brief Returns posting of the position, nullptr if there is none */
+    const uchar* posting(quint64 hash) const;
+
+    QFile m_keysFile;
+    QFile m_postingsFile;
+    uchar* m_keysMap;
+    uchar* m_postingsMap;
+    qint64 m_postingsSize;
+    const Key* m_keys;
+    qint64 m_keyCount;
+    qint64 m_indexedGames;
+};
+
+#endif  // POSITION_INDEX_HPP
@@ -0,0 +1,28 @@
+#ifndef VARINT_HPP
+#define VARINT_HPP
+#include <QByteArray>
+#include <QtGlobal>
+
+/*! \brief Appends \a value in LEB128, seven bits per byte, low bits first */
+inline void writeVarint(QByteArray& out, quint64 value) {
+    while (value >= 0x80) {
+        out.append(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+/*! \brief Reads LEB128 value and advances \a p past it.
+ * \returns false if the value is truncated
+ */
+inline bool readVarint(const uchar*& p, const uchar* end, quint64& value) {
+    value = 0;
+    for (int shift = 0; p != end && shift < 64; shift += 7) {
+        uchar byte = *p++;
+        value |= quint64(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+#endif  // VARINT_HPP
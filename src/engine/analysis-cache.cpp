@@ -0,0 +1,201 @@
+#include "engine/analysis-cache.hpp"
+
+#include <QCryptographicHash>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include "engine/engine-config.hpp"
+
+static const char Magic[8] = {'Q', 'T', 'C', 'A', 'C', 'H', 'E', '1'};
+// 2: en passant file hashed only when a capture is possible.
+static const quint32 Version = 2;
+
+AnalysisCache::AnalysisCache()
+    : m_header(nullptr), m_entries(nullptr), m_bucketMask(0) {}
+
+AnalysisCache::~AnalysisCache() { close(); }
+
+AnalysisCache& AnalysisCache::instance() {
+    static AnalysisCache cache;
+    return cache;
+}
+
+bool AnalysisCache::open(const QString& path, qint64 sizeBytes) {
+    close();
+
+    // Power of two buckets, so that the bucket is a simple mask of the hash.
+    qint64 bucketBytes = BucketSize * sizeof(Entry);
+    qint64 available = sizeBytes - qint64(sizeof(Header));
+    quint64 bucketCount = 1;
+    while (qint64(bucketCount * 2) * bucketBytes <= available)
+        bucketCount *= 2;
+    qint64 fileSize = sizeof(Header) + bucketCount * bucketBytes;
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadWrite)) return false;
+
+    Header header;
+    bool valid = m_file.size() == fileSize &&
+                 m_file.read(reinterpret_cast<char*>(&header),
+                             sizeof(header)) == sizeof(header) &&
+                 std::memcmp(header.magic, Magic, sizeof(Magic)) == 0 &&
+                 header.version == Version &&
+                 header.bucketCount == bucketCount;
+    if (!valid) {
+        // Foreign, damaged or differently sized file, start over.
+        if (!m_file.resize(0) || !m_file.resize(fileSize)) {
+            m_file.close();
+            return false;
+        }
+    }
+
+    uchar* memory = m_file.map(0, fileSize);
+    if (!memory) {
+        m_file.close();
+        return false;
+    }
+    m_header = reinterpret_cast<Header*>(memory);
+    m_entries = reinterpret_cast<Entry*>(memory + sizeof(Header));
+    m_bucketMask = bucketCount - 1;
+
+    if (!valid) {
+        std::memcpy(m_header->magic, Magic, sizeof(Magic));
+        m_header->version = Version;
+        m_header->generation = 0;
+        m_header->bucketCount = bucketCount;
+    }
+    // Every session is a new generation, older entries age.
+    ++m_header->generation;
+    return true;
+}
+
+void AnalysisCache::close() {
+    if (m_header) m_file.unmap(reinterpret_cast<uchar*>(m_header));
+    m_file.close();
+    m_header = nullptr;
+    m_entries = nullptr;
+    m_bucketMask = 0;
+}
+
+quint64 AnalysisCache::engineKey(const EngineConfig& config) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(config.name().toUtf8());
+
+    QStringList options = config.options();
+    options.sort();
+    for (const QString& option : options) {
+        hash.addData(QByteArray(1, '\0'));
+        hash.addData(option.toUtf8());
+        hash.addData(QByteArray(1, '='));
+        hash.addData(config.option(option).toUtf8());
+    }
+
+    quint64 key;
+    std::memcpy(&key, hash.result().constData(), sizeof(key));
+    return key;
+}
+
+AnalysisCache::Entry* AnalysisCache::bucket(quint64 position,
+                                            quint64 engine) const {
+    quint64 hash = position ^ (engine * 0x9e3779b97f4a7c15ull);
+    return m_entries + (hash & m_bucketMask) * BucketSize;
+}
+
+quint16 AnalysisCache::packMove(const Move& move) {
+    int promotion = move.PromotionPiece == Piece::Type::None
+                        ? 0
+                        : static_cast<int>(move.PromotionPiece);
+    return (move.From.x + 8 * move.From.y) |
+           (move.To.x + 8 * move.To.y) << 6 | promotion << 12;
+}
+
+Move AnalysisCache::unpackMove(quint16 packed) {
+    int from = packed & 63;
+    int to = (packed >> 6) & 63;
+    int promotion = (packed >> 12) & 7;
+
+    return Move(Coord2D<int>(from % 8, from / 8), Coord2D<int>(to % 8, to / 8),
+                promotion ? static_cast<Piece::Type>(promotion)
+                          : Piece::Type::None);
+}
+
+QVector<VariantInfo> AnalysisCache::lookup(quint64 position,
+                                           quint64 engine) const {
+    QVector<VariantInfo> variants;
+    if (!isOpen()) return variants;
+
+    const Entry* entries = bucket(position, engine);
+    for (int i = 0; i < BucketSize; ++i) {
+        const Entry& entry = entries[i];
+        if (entry.position != position || entry.engine != engine) continue;
+        if (entry.id < 1 || entry.pvLength > MaxPv) continue;
+
+        VariantInfo info;
+        info.setId(entry.id);
+        info.setDepth(entry.depth);
+        info.setNodes(entry.nodes);
+        if (entry.mate)
+            info.setMate(entry.mate);
+        else
+            info.setScore(entry.score);
+        for (int j = 0; j < entry.pvLength; ++j)
+            info.pv().append(unpackMove(entry.pv[j]));
+        variants.append(info);
+    }
+
+    std::sort(variants.begin(), variants.end(),
+              [](const VariantInfo& a, const VariantInfo& b) {
+                  return a.id() < b.id();
+              });
+    return variants;
+}
+
+void AnalysisCache::store(quint64 position, quint64 engine,
+                          const VariantInfo& info) {
+    // Bounds are just intermediate results of the search.
+    if (!isOpen() || info.bound() != VariantInfo::Exact) return;
+    if (info.id() < 1 || info.id() > 255 || info.pv().isEmpty()) return;
+
+    Entry* entries = bucket(position, engine);
+    Entry* target = nullptr;
+    int lowestPriority = INT_MAX;
+    quint8 generation = m_header->generation;
+
+    for (int i = 0; i < BucketSize; ++i) {
+        Entry& entry = entries[i];
+
+        if (entry.position == position && entry.engine == engine &&
+            entry.id == info.id()) {
+            // Same line, keep the deeper one.
+            if (entry.depth > info.depth()) return;
+            target = &entry;
+            break;
+        }
+
+        // A session old line counts as four plies shallower: one session
+        // alone would rarely outweigh the depth spread of stored lines, so
+        // stale deep lines would never make room for current ones.
+        int age = quint8(generation - entry.generation);
+        int priority = entry.position == 0 && entry.engine == 0
+                           ? INT_MIN
+                           : entry.depth - 4 * age;
+        if (priority < lowestPriority) {
+            lowestPriority = priority;
+            target = &entry;
+        }
+    }
+
+    target->position = position;
+    target->engine = engine;
+    target->nodes = info.nodes();
+    target->score = info.score();
+    target->mate = info.mate();
+    target->depth = info.depth();
+    target->id = info.id();
+    target->generation = generation;
+    target->pvLength = std::min<int>(info.pv().size(), MaxPv);
+    target->reserved = 0;
+    for (int i = 0; i < target->pvLength; ++i)
+        target->pv[i] = packMove(info.pv()[i]);
+}
@@ -0,0 +1,90 @@
+#ifndef ANALYSIS_CACHE_HPP
+#define ANALYSIS_CACHE_HPP
+#include <QFile>
+#include <QVector>
+
+#include "engine/variant-info.hpp"
+
+class EngineConfig;
+/*! \brief Persistent cache of engine analysis.
+ *
+ * Memory-mapped hash table of fixed size, keyed by the Zobrist hash of the
+ * position and a hash of the engine name and options. Every multipv line is
+ * a separate 128 byte entry, eight entries form a bucket. A line replaces
+ * the stored one only if it is at least as deep; when a bucket is full, the
+ * entry with the lowest depth minus four times its age in sessions is
+ * evicted.
+ *
+ * Only exact scores are stored. Stored lines are not validated beyond their
+ * size, callers must check the moves before using them.
+ */
+class AnalysisCache {
+public:
+    AnalysisCache();
+    ~AnalysisCache();
+
+    AnalysisCache(const AnalysisCache&) = delete;
+    AnalysisCache& operator=(const AnalysisCache&) = delete;
+
+    /*! \brief Returns cache shared by the application */
+    static AnalysisCache& instance();
+
+    /*! \brief Opens or creates cache file of the given size, the file is
+     * cleared if it was created with another size.
+     * \returns false if the file cannot be opened or mapped
+     */
+    bool open(const QString& path, qint64 sizeBytes);
+    void close();
+    bool isOpen() const { return m_entries != nullptr; }
+
+    /*! \brief Returns key identifying engine and its options */
+    static quint64 engineKey(const EngineConfig& config);
+
+    /*! \brief Returns cached lines of the position ordered by multipv id */
+    QVector<VariantInfo> lookup(quint64 position, quint64 engine) const;
+
+    /*! \brief Stores line unless a deeper one is already stored */
+    void store(quint64 position, quint64 engine, const VariantInfo& info);
+
+private:
+    struct Header {
+        char magic[8];
+        quint32 version;
+        quint32 generation;
+        quint64 bucketCount;
+        char reserved[40];
+    };
+
+    struct Entry {
+        quint64 position;
+        quint64 engine;
+        qint64 nodes;
+        qint32 score;
+        qint16 mate;
+        qint16 depth;
+        quint8 id;
+        quint8 generation;
+        quint8 pvLength;
+        quint8 reserved;
+        /*!< Moves packed as from | to << 6 | promotion << 12 */
+        quint16 pv[46];
+    };
+    static_assert(sizeof(Header) == 64, "Header layout changed");
+    static_assert(sizeof(Entry) == 128, "Entry layout changed");
+
+    static const int BucketSize = 8;
+    static const int MaxPv = 46;
+
+    /*! \brief Returns first entry of the bucket of the position */
+    Entry* bucket(quint64 position, quint64 engine) const;
+
+    static quint16 packMove(const Move& move);
+    static Move unpackMove(quint16 packed);
+
+    QFile m_file;
+    Header* m_header;
+    Entry* m_entries;
+    quint64 m_bucketMask;
+};
+
+#endif  // ANALYSIS_CACHE_HPP
@@ -0,0 +1,224 @@
+#include "engine/batch-analyzer.hpp"
+
+#include <QDebug>
+#include <QThread>
+
+#include "game/board.hpp"
+#include "game/tree.hpp"
+#include "tablebase/tablebase.hpp"
+#include "util/stringify.hpp"
+
+BatchAnalyzer::BatchAnalyzer(const EngineConfig& config,
+                             const SearchLimits& limits, QObject* parent)
+    : QObject(parent),
+      m_config(config),
+      m_limits(limits),
+      m_workerCount(QThread::idealThreadCount()),
+      m_tablebase(nullptr),
+      m_next(0),
+      m_done(0),
+      m_finished(false) {}
+
+BatchAnalyzer::~BatchAnalyzer() { m_output.close(); }
+
+void BatchAnalyzer::setWorkerCount(int count) {
+    m_workerCount = qMax(1, count);
+}
+
+void BatchAnalyzer::setTablebase(const Tablebase* tablebase) {
+    m_tablebase = tablebase;
+}
+
+void BatchAnalyzer::addPosition(const QString& fen) {
+    if (m_known.contains(fen)) return;
+
+    m_known.insert(fen);
+    m_positions.append(fen);
+}
+
+void BatchAnalyzer::addTree(const Tree& tree) { addNode(tree.rootNode()); }
+
+void BatchAnalyzer::addNode(const TreeNode* node) {
+    addPosition(node->getBoard()->toFen());
+
+    for (const Move& move : node->nextMoves()) addNode(node->next(move));
+}
+
+bool BatchAnalyzer::setOutput(const QString& path) {
+    m_output.close();
+    m_output.setFileName(path);
+    if (!m_output.open(QIODevice::ReadWrite)) return false;
+
+    // Crash may have left a partially written line, cut it off.
+    qint64 validSize = 0;
+    while (!m_output.atEnd()) {
+        QByteArray line = m_output.readLine();
+        if (!line.endsWith('\n')) break;
+
+        validSize += line.size();
+        int tab = line.indexOf('\t');
+        if (tab > 0) m_completed.insert(QString::fromUtf8(line.left(tab)));
+    }
+    m_output.resize(validSize);
+    m_output.seek(validSize);
+    return true;
+}
+
+void BatchAnalyzer::start() {
+    if (m_tablebase) probeTablebase();
+    for (const QString& fen : m_positions)
+        if (m_completed.contains(fen)) ++m_done;
+
+    int workers = qMin(m_workerCount, m_positions.size() - m_done);
+    for (int i = 0; i < workers; ++i) {
+        auto worker = std::make_unique<Worker>();
+        Worker* pWorker = worker.get();
+        worker->engine = std::make_unique<Engine>(m_config);
+
+        QObject::connect(worker->engine.get(), &Engine::ready, this,
+                         [this, pWorker]() { dispatch(*pWorker); });
+        QObject::connect(worker->engine.get(), &Engine::bestMoveFound, this,
+                         [this, pWorker](Move bestMove, Move, VariantInfo info) {
+                             onBestMoveFound(*pWorker, bestMove, info);
+                         });
+        QObject::connect(worker->engine.get(), &Engine::failed, this,
+                         [this, pWorker](QString reason) {
+                             onFailed(*pWorker, reason);
+                         });
+        worker->engine->start();
+        m_workers.push_back(std::move(worker));
+    }
+    emit progress(m_done, total());
+    finishIfDone();
+}
+
+int BatchAnalyzer::total() const { return m_positions.size(); }
+
+int BatchAnalyzer::done() const { return m_done; }
+
+void BatchAnalyzer::probeTablebase() {
+    Board board;
+    for (const QString& fen : m_positions) {
+        Move bestMove;
+        Tablebase::Wdl wdl;
+        int dtz;
+        if (m_completed.contains(fen) || !board.setFen(fen) ||
+            !m_tablebase->canProbe(board) ||
+            !m_tablebase->probeRoot(board, bestMove, wdl, dtz))
+            continue;
+
+        QString bestMoveString =
+            bestMove == Move::NullMove
+                ? QString("(none)")
+                : Stringify::longAlgebraicNotationString(bestMove);
+        QString pv = bestMove == Move::NullMove ? QString() : bestMoveString;
+        m_output.write(QString("%1\t%2\twdl %3\t0\t0\t%4\n")
+                           .arg(fen, bestMoveString, QString::number(wdl), pv)
+                           .toUtf8());
+        m_completed.insert(fen);
+    }
+    m_output.flush();
+}
+
+void BatchAnalyzer::dispatch(Worker& worker) {
+    if (worker.position >= 0) return;
+
+    Board board;
+    for (;;) {
+        if (!m_retry.isEmpty()) {
+            worker.position = m_retry.takeFirst();
+        } else {
+            while (m_next < m_positions.size() &&
+                   m_completed.contains(m_positions[m_next]))
+                ++m_next;
+            if (m_next == m_positions.size()) {
+                // Nothing left, let the process go.
+                retire(worker);
+                finishIfDone();
+                return;
+            }
+            worker.position = m_next++;
+        }
+        if (board.setFen(m_positions[worker.position])) break;
+
+        // Result of any other board would be filed under this FEN.
+        qWarning() << "Skipping invalid FEN" << m_positions[worker.position];
+        worker.position = -1;
+        ++m_done;
+        emit progress(m_done, total());
+    }
+    worker.engine->startAnalysis(board, m_limits);
+}
+
+void BatchAnalyzer::onBestMoveFound(Worker& worker, Move bestMove,
+                                    VariantInfo info) {
+    const QString& fen = m_positions[worker.position];
+
+    // Flush every line, finished work must survive a crash.
+    m_output.write(formatResult(fen, bestMove, info));
+    m_output.flush();
+    m_completed.insert(fen);
+    worker.position = -1;
+    ++m_done;
+
+    emit progress(m_done, total());
+    dispatch(worker);
+}
+
+void BatchAnalyzer::onFailed(Worker& worker, QString reason) {
+    if (worker.position < 0) {
+        qWarning() << "Engine failed to start:" << reason;
+        retire(worker);
+        finishIfDone();
+        return;
+    }
+
+    int position = worker.position;
+    worker.position = -1;
+    if (++m_attempts[position] < MaxAttempts) {
+        m_retry.append(position);
+    } else {
+        qWarning() << "Skipping" << m_positions[position] << ":" << reason;
+        ++m_done;
+        emit progress(m_done, total());
+    }
+    // Search request restarts the dead process.
+    dispatch(worker);
+}
+
+void BatchAnalyzer::retire(Worker& worker) {
+    // We are most likely inside a signal of the engine.
+    if (worker.engine) worker.engine.release()->deleteLater();
+}
+
+void BatchAnalyzer::finishIfDone() {
+    if (m_finished) return;
+
+    for (const auto& worker : m_workers)
+        if (worker->engine) return;
+
+    m_finished = true;
+    if (m_done < total()) qWarning() << "No engine left to analyse positions.";
+    // Queued, start() may get here before the caller enters event loop.
+    QMetaObject::invokeMethod(this, &BatchAnalyzer::finished,
+                              Qt::QueuedConnection);
+}
+
+QByteArray BatchAnalyzer::formatResult(const QString& fen, Move bestMove,
+                                       const VariantInfo& info) {
+    QString score = info.mate() ? QString("mate %1").arg(info.mate())
+                                : QString("cp %1").arg(info.score());
+    QStringList pv;
+    for (const Move& move : info.pv())
+        pv.append(Stringify::longAlgebraicNotationString(move));
+
+    QString bestMoveString =
+        bestMove == Move::NullMove
+            ? QString("(none)")
+            : Stringify::longAlgebraicNotationString(bestMove);
+
+    return QString("%1\t%2\t%3\t%4\t%5\t%6\n")
+        .arg(fen, bestMoveString, score, QString::number(info.depth()),
+             QString::number(info.nodes()), pv.join(' '))
+        .toUtf8();
+}
@@ -0,0 +1,118 @@
+#ifndef BATCH_ANALYZER_HPP
+#define BATCH_ANALYZER_HPP
+#include <QFile>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <memory>
+#include <vector>
+
+#include "engine/engine.hpp"
+
+class Tablebase;
+class Tree;
+class TreeNode;
+/*! \brief Analyses a list of positions with a pool of engine processes.
+ *
+ * Every worker is a separate engine process that searches one position at a
+ * time with finite limits, so as many positions are analysed in parallel as
+ * there are workers. Engines should be configured with a single search
+ * thread to keep one process per core.
+ *
+ * Results are appended to the output file as soon as they arrive, one line
+ * per position:
+ *
+ *     <fen> TAB <bestmove> TAB <score> TAB <depth> TAB <nodes> TAB <pv>
+ *
+ * where score is either "cp <n>" or "mate <n>". Positions already present in
+ * the output file are skipped, so an interrupted batch resumes where it
+ * stopped.
+ *
+ * With tablebases set, positions found in them are answered without a
+ * search, their score is "wdl <n>" with n from Tablebase::Wdl, depth and
+ * nodes are 0 and the pv is the best move.
+ */
+class BatchAnalyzer : public QObject {
+    Q_OBJECT
+public:
+    BatchAnalyzer(const EngineConfig& config, const SearchLimits& limits,
+                  QObject* parent = nullptr);
+    ~BatchAnalyzer();
+
+    /*! \brief Sets number of engine processes, defaults to number of cores */
+    void setWorkerCount(int count);
+
+    /*! \brief Answers positions found in \a tablebase from it, null turns
+     * this off */
+    void setTablebase(const Tablebase* tablebase);
+
+    /*! \brief Queues position given as FEN, duplicates are ignored */
+    void addPosition(const QString& fen);
+
+    /*! \brief Queues every position of the tree, including variations */
+    void addTree(const Tree& tree);
+
+    /*! \brief Opens output file for appending and skips positions it already
+     * contains.
+     * \returns false if the file cannot be opened
+     */
+    bool setOutput(const QString& path);
+
+    /*! \brief Starts engines, finished() is queued when all positions are
+     * analysed, also when there is nothing to do */
+    void start();
+
+    /*! \brief Number of queued positions */
+    int total() const;
+
+    /*! \brief Number of analysed positions, including the resumed ones */
+    int done() const;
+signals:
+    void progress(int done, int total);
+    void finished();
+
+private:
+    struct Worker {
+        std::unique_ptr<Engine> engine;
+        /*!< Index of the analysed position or -1 */
+        int position = -1;
+    };
+
+    void addNode(const TreeNode* node);
+    /*! \brief Writes results of positions found in the tablebases */
+    void probeTablebase();
+    void dispatch(Worker& worker);
+    void onBestMoveFound(Worker& worker, Move bestMove, VariantInfo info);
+    void onFailed(Worker& worker, QString reason);
+    /*! \brief Stops engine of the worker */
+    void retire(Worker& worker);
+    void finishIfDone();
+
+    /*! \brief Formats single result line */
+    static QByteArray formatResult(const QString& fen, Move bestMove,
+                                   const VariantInfo& info);
+
+    /*!< Maximal number of engine failures on a single position */
+    static const int MaxAttempts = 3;
+
+    EngineConfig m_config;
+    SearchLimits m_limits;
+    int m_workerCount;
+    const Tablebase* m_tablebase;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    QStringList m_positions;
+    QSet<QString> m_known;
+    /*!< Positions found in the output file of a previous run */
+    QSet<QString> m_completed;
+    /*!< Index of the next position to hand out */
+    int m_next;
+    /*!< Positions handed back after an engine failure */
+    QList<int> m_retry;
+    QHash<int, int> m_attempts;
+    int m_done;
+    bool m_finished;
+    QFile m_output;
+};
+
+#endif  // BATCH_ANALYZER_HPP
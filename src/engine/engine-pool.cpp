@@ -0,0 +1,79 @@
+#include "engine/engine-pool.hpp"
+
+#include <QThread>
+
+void EnginePool::Releaser::operator()(Engine* engine) const {
+    if (pool)
+        pool->release(engine);
+    else
+        delete engine;
+}
+
+EnginePool::EnginePool(QObject* parent)
+    : QObject(parent), m_capacity(QThread::idealThreadCount()) {}
+
+EnginePool::~EnginePool() { clear(); }
+
+EnginePool::Lease EnginePool::lease(const EngineConfig& config,
+                                    const QString& recordFile) {
+    QVector<Engine*>& idle = m_idle[config.name()];
+
+    while (recordFile.isEmpty() && !idle.isEmpty()) {
+        Engine* engine = idle.takeLast();
+
+        // Engine died while parked or it was reconfigured meanwhile.
+        if (engine->state() == Engine::Finished || engine->config() != config) {
+            delete engine;
+            continue;
+        }
+        return Lease(engine, Releaser{this});
+    }
+
+    Engine* engine = new Engine(config);
+    if (!recordFile.isEmpty()) engine->setRecordFile(recordFile);
+    engine->start();
+    return Lease(engine, Releaser{this});
+}
+
+void EnginePool::prewarm(const EngineConfig& config, int count) {
+    QVector<Engine*>& idle = m_idle[config.name()];
+    count = qMin(count, m_capacity);
+
+    while (idle.size() < count) {
+        Engine* engine = new Engine(config);
+        engine->start();
+        idle.append(engine);
+    }
+}
+
+void EnginePool::setCapacity(int capacity) {
+    m_capacity = qMax(0, capacity);
+
+    for (QVector<Engine*>& idle : m_idle) {
+        while (idle.size() > m_capacity) delete idle.takeFirst();
+    }
+}
+
+int EnginePool::capacity() const { return m_capacity; }
+
+void EnginePool::clear() {
+    for (QVector<Engine*>& idle : m_idle) qDeleteAll(idle);
+    m_idle.clear();
+}
+
+void EnginePool::release(Engine* engine) {
+    if (!engine) return;
+
+    // Previous user must not hear about the next one's analysis.
+    QObject::disconnect(engine, nullptr, nullptr, nullptr);
+    // Next lease must not append to this one's log.
+    engine->setRecordFile(QString());
+
+    QVector<Engine*>& idle = m_idle[engine->config().name()];
+    if (engine->state() == Engine::Finished || idle.size() >= m_capacity) {
+        delete engine;
+        return;
+    }
+    engine->stopAnalysis();
+    idle.append(engine);
+}
@@ -0,0 +1,63 @@
+#ifndef ENGINE_POOL_HPP
+#define ENGINE_POOL_HPP
+#include <QMap>
+#include <QObject>
+#include <QPointer>
+#include <QVector>
+#include <memory>
+
+#include "engine/engine.hpp"
+
+/*! \brief Keeps initialized engine processes around between uses.
+ *
+ * Starting an engine costs a process spawn and the whole UCI handshake, which
+ * is noticeable when panels are reopened or many games are played. Released
+ * engines are stopped and parked; the next lease of the same config takes a
+ * parked engine instead of starting a new one.
+ */
+class EnginePool : public QObject {
+    Q_OBJECT
+public:
+    /*! \brief Deleter of leased engines, returns them to the pool */
+    struct Releaser {
+        QPointer<EnginePool> pool;
+        void operator()(Engine* engine) const;
+    };
+    typedef std::unique_ptr<Engine, Releaser> Lease;
+
+    explicit EnginePool(QObject* parent = nullptr);
+    ~EnginePool();
+
+    /*! \brief Returns a started engine of the given config.
+     *
+     * A parked engine is reused when its config still matches, otherwise a
+     * new one is started. The engine goes back to the pool once the lease is
+     * destroyed.
+     *
+     * With \a recordFile set the UCI traffic is logged there. Such a lease
+     * always starts a new engine, so that the log holds the whole session
+     * including the handshake.
+     */
+    Lease lease(const EngineConfig& config,
+                const QString& recordFile = QString());
+
+    /*! \brief Starts engines in advance, so that up to count of them are
+     * parked for the given config */
+    void prewarm(const EngineConfig& config, int count = 1);
+
+    /*! \brief Maximal number of parked engines per config name */
+    void setCapacity(int capacity);
+    int capacity() const;
+
+    /*! \brief Stops all parked engines */
+    void clear();
+
+private:
+    void release(Engine* engine);
+
+    int m_capacity;
+    /*!< \brief Parked engines by config name */
+    QMap<QString, QVector<Engine*>> m_idle;
+};
+
+#endif  // ENGINE_POOL_HPP
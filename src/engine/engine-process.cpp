@@ -0,0 +1,417 @@
+#include "engine/engine-process.hpp"
+
+#include <QDebug>
+#include <QThread>
+#include <climits>
+#include <stdexcept>
+
+#include "engine/uci-parser.hpp"
+#include "util/profiler.hpp"
+
+EngineProcess::EngineProcess(const EngineConfig& config, const int timeoutMs,
+                             std::shared_ptr<VariantQueue> variants)
+    : m_timeoutMs(timeoutMs),
+      m_process(new QProcess(this)),
+      m_state(Engine::Initializing),
+      m_config(config),
+      m_watchdog(this),
+      m_searchId(0),
+      m_pendingSearchId(0),
+      m_pondering(false),
+      m_newGame(false),
+      m_line(MaxLineLength, '\0'),
+      m_variants(std::move(variants)) {
+    m_watchdog.setSingleShot(true);
+    m_watchdog.setInterval(m_timeoutMs);
+
+    QObject::connect(m_process, &QProcess::started, this,
+                     &EngineProcess::onStarted);
+    QObject::connect(m_process, &QProcess::readyRead, this,
+                     &EngineProcess::onReadyRead);
+    QObject::connect(m_process, &QProcess::errorOccurred, this,
+                     &EngineProcess::onErrorOccurred);
+    QObject::connect(m_process, &QProcess::finished, this,
+                     &EngineProcess::onFinished);
+    QObject::connect(&m_watchdog, &QTimer::timeout, this,
+                     &EngineProcess::onTimeout);
+    m_process->setProgram(m_config.command());
+    m_process->setArguments(QProcess::splitCommand(m_config.arguments()));
+    if (!m_config.workdir().isEmpty())
+        m_process->setWorkingDirectory(m_config.workdir());
+}
+
+const QList<EngineOption>& EngineProcess::options() const {
+    return m_parsedOptions;
+}
+
+void EngineProcess::start() {
+    if (m_process->state() != QProcess::NotRunning) return;
+
+    setState(Engine::Initializing);
+    m_sentOptions.clear();
+    m_watchdog.start(m_timeoutMs);
+    m_process->start();
+}
+
+void EngineProcess::startAndWait() {
+    start();
+
+    if (!m_process->waitForStarted(m_timeoutMs))
+        throw std::runtime_error("Cannot start engine.");
+
+    waitForStateOrThrow(Engine::Idling);
+}
+
+void EngineProcess::startAnalysis(const QString& position,
+                                  const SearchLimits& limits,
+                                  quint64 searchId) {
+    m_pendingPosition = position;
+    m_pendingLimits = limits;
+    m_pendingSearchId = searchId;
+
+    switch (m_state) {
+        case Engine::Idling:
+            startPendingAnalysis();
+            break;
+        case Engine::Working:
+            // Search restarts when the engine acknowledges the stop.
+            setState(Engine::Stopping);
+            break;
+        case Engine::Finished:
+            // Killed process may still be on its way out.
+            if (m_process->state() != QProcess::NotRunning) {
+                m_process->kill();
+                m_process->waitForFinished(m_timeoutMs);
+            }
+            start();
+            break;
+        default:
+            if (m_process->state() == QProcess::NotRunning) start();
+            break;
+    }
+}
+
+void EngineProcess::stopAnalysis() {
+    m_pendingPosition.clear();
+
+    if (m_state == Engine::Working) setState(Engine::Stopping);
+}
+
+void EngineProcess::ponderHit(quint64 searchId) {
+    // Search has not started yet, it will be a normal one then.
+    if (!m_pendingPosition.isEmpty() && m_pendingSearchId == searchId) {
+        if (!m_pendingLimits.ponder) return;
+
+        m_pendingLimits.ponder = false;
+        emit ponderEnded(searchId, true, 0);
+        return;
+    }
+
+    if (m_state != Engine::Working || !m_pondering || m_searchId != searchId)
+        return;
+
+    send("ponderhit");
+    m_pondering = false;
+    emit ponderEnded(searchId, true, m_searchTimer.nsecsElapsed() / 1000);
+    // Own thinking time starts now.
+    m_searchTimer.start();
+    armSearchWatchdog();
+}
+
+void EngineProcess::shutdown() {
+    QObject::disconnect(m_process, nullptr, this, nullptr);
+    m_watchdog.stop();
+
+    // Blocking is fine here, this is the engine thread.
+    if (m_process->state() != QProcess::NotRunning) {
+        send("stop");
+        send("quit");
+        if (!m_process->waitForFinished(m_timeoutMs)) {
+            m_process->kill();
+            m_process->waitForFinished(m_timeoutMs);
+        }
+    }
+    thread()->quit();
+}
+
+void EngineProcess::newGame() { m_newGame = true; }
+
+void EngineProcess::setOption(const QString& name, const QString& value) {
+    send(QString("setoption name %1 value %2").arg(name, value));
+    m_sentOptions[name] = value;
+}
+
+void EngineProcess::setRecordFile(const QString& path) {
+    if (path.isEmpty())
+        m_recorder.close();
+    else if (!m_recorder.open(path))
+        qWarning() << "Cannot record UCI traffic into" << path;
+}
+
+void EngineProcess::onStarted() { send("uci"); }
+
+void EngineProcess::onReadyRead() {
+    ProfileScope profile("Engine::onReadyRead");
+
+    while (m_process->canReadLine()) {
+        qint64 length = m_process->readLine(m_line.data(), m_line.size());
+        if (length <= 0) break;
+
+        const char* begin = m_line.constData();
+        const char* end = begin + length;
+
+        // Lines longer than the buffer are truncated, drop the rest of them.
+        if (end[-1] != '\n') {
+            char rest[256];
+            qint64 read;
+            do {
+                read = m_process->readLine(rest, sizeof(rest));
+            } while (read > 0 && rest[read - 1] != '\n');
+        }
+
+        // Make Windows users happy.
+        while (end > begin && (end[-1] == '\n' || end[-1] == '\r')) --end;
+        if (m_recorder.isOpen())
+            m_recorder.record(UciRecorder::FromEngine, begin, end);
+
+        setState(parseLine(begin, end));
+    }
+}
+
+void EngineProcess::onErrorOccurred(QProcess::ProcessError error) {
+    // Failure has been reported already, e.g. the kill of a timed out
+    // engine shows up as a crash.
+    if (m_state == Engine::Finished) return;
+
+    if (error == QProcess::FailedToStart)
+        fail("Cannot start engine.");
+    else
+        fail(m_process->errorString());
+}
+
+void EngineProcess::onFinished() {
+    // Engine only quits when asked to in shutdown(), which disconnects.
+    if (m_state != Engine::Finished) fail("Engine exited unexpectedly.");
+}
+
+void EngineProcess::onTimeout() { fail("Engine stopped responding."); }
+
+void EngineProcess::fail(const QString& reason) {
+    m_watchdog.stop();
+    m_pendingPosition.clear();
+    m_pondering = false;
+    m_state = Engine::Finished;
+    emit stateChanged(m_state);
+
+    // Blocking is fine here, this is the engine thread. Signals of the
+    // dying process are ignored in the Finished state.
+    if (m_process->state() != QProcess::NotRunning) {
+        m_process->kill();
+        m_process->waitForFinished(m_timeoutMs);
+    }
+    emit failed(reason);
+}
+
+void EngineProcess::armSearchWatchdog() {
+    // Ponder and infinite searches run until told to stop.
+    qint64 duration = m_pondering ? 0 : m_limits.maxDuration();
+    if (duration > 0)
+        m_watchdog.start(int(qMin<qint64>(duration + m_timeoutMs, INT_MAX)));
+    else
+        m_watchdog.stop();
+}
+
+void EngineProcess::waitForStateOrThrow(Engine::State expectedState) {
+    while (m_state != expectedState) {
+        if (!m_process->waitForReadyRead(m_timeoutMs))
+            throw std::runtime_error("Engine stopped responding.");
+    }
+}
+
+void EngineProcess::parseOption(const QString& line) {
+    static QStringList keywords = {"option",  "name",  "type",   "check",
+                                   "spin",    "combo", "button", "string",
+                                   "default", "min",   "max",    "var"};
+
+    QStringList tokens = line.split(" ");
+    QString name;
+
+    for (int i = 0; i < tokens.size(); ++i) {
+        if (tokens[i] == "name") {
+            while (!keywords.contains(tokens[++i])) {
+                name.append(tokens[i]);
+                name.append(' ');
+            }
+            name.chop(1);
+            --i;
+        } else if (tokens[i] == "type") {
+            QString type = tokens[++i];
+            EngineOption option;
+
+            if (type == "check") {
+                ++i;
+                option = EngineOption::checkbox(name, tokens[++i] == "true");
+            } else if (type == "button") {
+                option = EngineOption::button(name);
+            } else if (type == "string") {
+                ++i;
+                QString value;
+                while (++i < tokens.size()) {
+                    value.append(tokens[i]);
+                    value.append(' ');
+                }
+                value.chop(1);
+                option = EngineOption::string(name, value);
+            } else if (type == "spin") {
+                int defaultValue;
+                int minValue;
+                int maxValue;
+                while (++i < tokens.size()) {
+                    if (tokens[i] == "default")
+                        defaultValue = tokens[++i].toInt();
+                    else if (tokens[i] == "min")
+                        minValue = tokens[++i].toInt();
+                    else if (tokens[i] == "max")
+                        maxValue = tokens[++i].toInt();
+                }
+                option = EngineOption::spinbox(name, minValue, maxValue,
+                                               defaultValue);
+            } else {
+                qDebug() << "Warning: ignored option: " << line;
+                break;
+            }
+            m_parsedOptions.push_back(option);
+        }
+    }
+}
+
+void EngineProcess::parseInfo(const char* begin, const char* end) {
+    // Lines without score are engine info, not a variant.
+    if (!UciParser::parseInfo(begin, end, m_info)) return;
+    if (m_info.id() <= 1) m_bestInfo.assign(m_info);
+
+    // GUI is far behind, newer lines will supersede this one.
+    PackedVariantInfo packed;
+    packed.assign(m_info);
+    if (!m_variants->queue.push({m_searchId, packed})) return;
+    if (!m_variants->notified.exchange(true)) emit variantsAvailable();
+}
+
+void EngineProcess::parseBestMove(const char* begin, const char* end) {
+    UciTokenizer tokenizer(begin, end);
+    const char* tokenBegin;
+    const char* tokenEnd;
+    Move bestMove = Move::NullMove;
+    Move ponderMove = Move::NullMove;
+
+    // "bestmove <move> [ponder <move>]", the move is "(none)" when mated.
+    tokenizer.next(tokenBegin, tokenEnd);
+    if (tokenizer.next(tokenBegin, tokenEnd) &&
+        !UciParser::parseMove(tokenBegin, tokenEnd, bestMove))
+        bestMove = Move::NullMove;
+    if (tokenizer.next(tokenBegin, tokenEnd) &&
+        UciParser::equals(tokenBegin, tokenEnd, "ponder") &&
+        tokenizer.next(tokenBegin, tokenEnd) &&
+        !UciParser::parseMove(tokenBegin, tokenEnd, ponderMove))
+        ponderMove = Move::NullMove;
+
+    emit bestMoveFound(m_searchId, bestMove, ponderMove, m_bestInfo.unpack(),
+                       m_searchTimer.nsecsElapsed() / 1000);
+}
+
+Engine::State EngineProcess::parseLine(const char* begin, const char* end) {
+    Q_ASSERT(m_state != Engine::Idling && "Engine talks while it is idle.");
+
+    switch (m_state) {
+        case Engine::Initializing:
+            // End of the initialization, engine is now idle
+            if (UciParser::startsWith(begin, end, "uciok")) {
+                emit optionsParsed(m_parsedOptions);
+                return Engine::Idling;
+            } else if (UciParser::startsWith(begin, end, "option"))
+                parseOption(QString::fromUtf8(begin, end - begin));
+            break;
+        case Engine::Working:
+            if (UciParser::startsWith(begin, end, "info"))
+                parseInfo(begin, end);
+            else if (UciParser::startsWith(begin, end, "bestmove")) {
+                // Finite search has ended, or a ponder search has run out
+                // of moves before the ponderhit.
+                m_pondering = false;
+                parseBestMove(begin, end);
+                return Engine::Idling;
+            }
+            break;
+        case Engine::Stopping:
+            if (UciParser::startsWith(begin, end, "bestmove"))
+                return Engine::Idling;
+            break;
+        default:
+            break;
+    }
+    // No state change
+    return m_state;
+}
+
+void EngineProcess::setState(Engine::State state) {
+    if (state == m_state) return;
+
+    m_state = state;
+    emit stateChanged(state);
+
+    switch (state) {
+        case Engine::Stopping:
+            send("stop");
+            m_watchdog.start(m_timeoutMs);
+            if (m_pondering) {
+                // Opponent did not play the expected move.
+                m_pondering = false;
+                emit ponderEnded(m_searchId, false,
+                                 m_searchTimer.nsecsElapsed() / 1000);
+            }
+            break;
+        case Engine::Idling:
+            m_watchdog.stop();
+            startPendingAnalysis();
+            break;
+        default:
+            break;
+    }
+}
+
+void EngineProcess::startPendingAnalysis() {
+    if (m_state != Engine::Idling || m_pendingPosition.isEmpty()) return;
+
+    setState(Engine::Working);
+    // Engine keeps options between searches, send only the changed ones.
+    for (const QString& key : m_config.options()) {
+        QString value = m_config.option(key);
+        auto sent = m_sentOptions.constFind(key);
+        if (sent == m_sentOptions.constEnd() || sent.value() != value)
+            setOption(key, value);
+    }
+
+    if (m_newGame) {
+        send("ucinewgame");
+        m_newGame = false;
+    }
+    send("position " + m_pendingPosition);
+    send(m_pendingLimits.toUci());
+    m_searchTimer.start();
+    m_limits = m_pendingLimits;
+    m_pondering = m_limits.ponder;
+    m_searchId = m_pendingSearchId;
+    m_bestInfo.clear();
+    m_pendingPosition.clear();
+    armSearchWatchdog();
+}
+
+void EngineProcess::send(const QString& command) {
+    QByteArray line = command.toUtf8();
+    if (m_recorder.isOpen())
+        m_recorder.record(UciRecorder::ToEngine, line.constData(),
+                          line.constData() + line.size());
+
+    m_process->write(line);
+    m_process->write("\n");
+}
@@ -0,0 +1,154 @@
+#ifndef ENGINE_PROCESS_HPP
+#define ENGINE_PROCESS_HPP
+#include <QElapsedTimer>
+#include <QMap>
+#include <QProcess>
+#include <QTimer>
+#include <memory>
+
+#include "engine/engine.hpp"
+#include "engine/uci-recorder.hpp"
+
+/*! \brief UCI process and protocol state machine of an Engine.
+ *
+ * Lives in the engine I/O thread. All slots must be invoked through queued
+ * calls, parsed variants are pushed into the queue shared with the Engine.
+ */
+class EngineProcess : public QObject {
+    Q_OBJECT
+public:
+    EngineProcess(const EngineConfig& config, const int timeoutMs,
+                  std::shared_ptr<VariantQueue> variants);
+
+    /*! \brief Returns parsed options. */
+    const QList<EngineOption>& options() const;
+
+public slots:
+    /*! \brief Starts an engine */
+    void start();
+
+    /*! \brief Starts an engine and blocks until it is initialized, throws on
+     * failure. */
+    void startAndWait();
+
+    /*! \brief Queues analysis of the position, given as arguments of the
+     * "position" command; parsed variants are tagged with \a searchId */
+    void startAnalysis(const QString& position, const SearchLimits& limits,
+                       quint64 searchId);
+
+    /*! \brief Requests analysis stop */
+    void stopAnalysis();
+
+    /*! \brief Turns ponder search \a searchId into a normal one, the
+     * opponent has played the expected move */
+    void ponderHit(quint64 searchId);
+
+    /*! \brief Sends "ucinewgame" before the next search, not while the
+     * engine is still searching the previous game */
+    void newGame();
+
+    /*! \brief Sets engine option. */
+    void setOption(const QString& name, const QString& value);
+
+    /*! \brief Starts logging UCI traffic into the file, empty path stops
+     * it. */
+    void setRecordFile(const QString& path);
+
+    /*! \brief Asks the engine to quit, kills it on timeout and finishes the
+     * thread. */
+    void shutdown();
+signals:
+    void stateChanged(Engine::State);
+    void optionsParsed(QList<EngineOption>);
+    /*! \brief Emitted when the variant queue has become non-empty */
+    void variantsAvailable();
+    /*! \brief Emitted when a finite search has ended on its own, \a timeUs
+     * is the time from sending "go" to reading "bestmove" */
+    void bestMoveFound(quint64 searchId, Move bestMove, Move ponderMove,
+                       VariantInfo info, qint64 timeUs);
+    /*! \brief Emitted on ponderhit or when a ponder search is stopped,
+     * \a timeUs is the time spent pondering */
+    void ponderEnded(quint64 searchId, bool hit, qint64 timeUs);
+    void failed(QString reason);
+private slots:
+    void onStarted();
+    void onReadyRead();
+    void onErrorOccurred(QProcess::ProcessError error);
+    void onFinished();
+    void onTimeout();
+
+private:
+    /*! \brief Waits for state change to a specific one or throws. */
+    void waitForStateOrThrow(Engine::State expectedState);
+
+    /*! \brief Parses option */
+    void parseOption(const QString& line);
+
+    /*! \brief Parses info */
+    void parseInfo(const char* begin, const char* end);
+
+    /*! \brief Parses "bestmove" line of a finished search */
+    void parseBestMove(const char* begin, const char* end);
+
+    /*! \brief Parses line from the engine */
+    Engine::State parseLine(const char* begin, const char* end);
+
+    /*! \brief Ends the process for good and emits failed() once */
+    void fail(const QString& reason);
+
+    /*! \brief Arms watchdog for the running search, finite searches must
+     * end within their limits */
+    void armSearchWatchdog();
+
+    /*! \brief Sets current state and reacts on the transition */
+    void setState(Engine::State state);
+
+    /*! \brief Sends queued search if there is any */
+    void startPendingAnalysis();
+
+    /*! \brief Sends command string to the engine */
+    void send(const QString& command);
+
+    /*!< \brief Default timeout for engine actions */
+    const int m_timeoutMs;
+    QProcess* m_process;
+    Engine::State m_state;
+    EngineConfig m_config;
+    /*!< \brief Option values the running process has already received */
+    QMap<QString, QString> m_sentOptions;
+    /*!< \brief Position to analyse once engine is idle, as arguments of
+     * the "position" command */
+    QString m_pendingPosition;
+    SearchLimits m_pendingLimits;
+    /*!< \brief Fires when the engine does not answer in time */
+    QTimer m_watchdog;
+    /*!< \brief Id of the running search and of the pending one */
+    quint64 m_searchId;
+    quint64 m_pendingSearchId;
+    /*!< \brief Longest line read from the engine at once */
+    static const int MaxLineLength = 8192;
+    /*!< \brief Buffer the engine output is read into */
+    QByteArray m_line;
+    /*!< \brief Variant reused for parsing every info line */
+    VariantInfo m_info;
+    /*!< \brief Measures the running search, started right after "go" and
+     * restarted on ponderhit */
+    QElapsedTimer m_searchTimer;
+    /*!< \brief Limits of the running search */
+    SearchLimits m_limits;
+    /*!< \brief Running search is a ponder search */
+    bool m_pondering;
+    /*!< \brief Next search begins a new game */
+    bool m_newGame;
+    /*!< \brief Last principal variant of the running search */
+    PackedVariantInfo m_bestInfo;
+    /*!< \brief Log of the traffic, if enabled */
+    UciRecorder m_recorder;
+    /*!< \brief Parsed variants waiting for the GUI thread */
+    std::shared_ptr<VariantQueue> m_variants;
+
+    /*!< \brief List of parsed options declared by the engine. */
+    QList<EngineOption> m_parsedOptions;
+};
+
+#endif  // ENGINE_PROCESS_HPP
@@ -1,224 +1,227 @@
-#include "engine.hpp"
+#include "engine/engine.hpp"
 
-#include <QDebug>
+#include <QMap>
 #include <stdexcept>
 
+#include "engine/engine-process.hpp"
 #include "game/board.hpp"
-#include <filesystem>
-#include <iostream>
+#include "util/stringify.hpp"
 
 Engine::Engine(const EngineConfig& config, const int timeoutMs)
     : m_timeoutMs(timeoutMs),
-      m_process(new QProcess()),
+      m_config(config),
       m_state(Engine::Initializing),
-      m_config(config) {
-    QObject::connect(m_process, &QProcess::started, this, &Engine::onStarted);
-    QObject::connect(m_process, &QProcess::readyRead, this,
-                     &Engine::onReadyRead);
-    m_process->setProgram(m_config.command());
+      m_started(false),
+      m_analysing(false),
+      m_searchId(0),
+      m_lastSearchTime(0),
+      m_pondering(false),
+      m_lastPonderTime(0),
+      m_variants(std::make_shared<VariantQueue>()),
+      m_thread(new QThread()),
+      m_process(new EngineProcess(config, timeoutMs, m_variants)) {
+    qRegisterMetaType<Engine::State>();
+    qRegisterMetaType<QList<EngineOption>>();
+    qRegisterMetaType<Move>();
+    qRegisterMetaType<VariantInfo>();
+    qRegisterMetaType<SearchLimits>();
+
+    m_thread->setObjectName("Engine " + config.name());
+    m_process->moveToThread(m_thread);
+
+    QObject::connect(m_process, &EngineProcess::stateChanged, this,
+                     &Engine::onStateChanged);
+    QObject::connect(m_process, &EngineProcess::optionsParsed, this,
+                     &Engine::onOptionsParsed);
+    QObject::connect(m_process, &EngineProcess::variantsAvailable, this,
+                     &Engine::onVariantsAvailable);
+    QObject::connect(m_process, &EngineProcess::failed, this,
+                     &Engine::onFailed);
+    QObject::connect(m_process, &EngineProcess::bestMoveFound, this,
+                     &Engine::onBestMoveFound);
+    QObject::connect(m_process, &EngineProcess::ponderEnded, this,
+                     &Engine::onPonderEnded);
+    // Thread cleans up after itself once the engine has quit.
+    QObject::connect(m_thread, &QThread::finished, m_process,
+                     &QObject::deleteLater);
+    QObject::connect(m_thread, &QThread::finished, m_thread,
+                     &QObject::deleteLater);
+
+    m_thread->start();
 }
 
 Engine::~Engine() {
-    if (isAnalysing()) stopAnalysis();
-    m_process->close();
-    // FIXME: possible memory leak or segmentation fault
-    m_process->waitForFinished(m_timeoutMs);
-    m_process->deleteLater();
-    m_process = nullptr;
+    QObject::disconnect(m_process, nullptr, this, nullptr);
+    QMetaObject::invokeMethod(m_process, &EngineProcess::shutdown,
+                              Qt::QueuedConnection);
 }
 
 void Engine::start() {
-    if (started()) return;
-
-    // Start the engine.
-    m_process->start();
+    m_started = true;
+    QMetaObject::invokeMethod(m_process, &EngineProcess::start,
+                              Qt::QueuedConnection);
+}
 
-    if (!m_process->waitForStarted(m_timeoutMs))
-        throw std::runtime_error("Cannot start engine.");
+void Engine::startAndWait() {
+    EngineProcess* process = m_process;
+    QList<EngineOption> options;
+    QString error;
+
+    m_started = true;
+    QMetaObject::invokeMethod(
+        m_process,
+        [process, &options, &error]() {
+            try {
+                process->startAndWait();
+                options = process->options();
+            } catch (std::runtime_error& exception) {
+                error = exception.what();
+            }
+        },
+        Qt::BlockingQueuedConnection);
 
-    waitForStateOrThrow(Engine::Idling);
+    if (!error.isEmpty()) {
+        m_started = false;
+        throw std::runtime_error(error.toStdString());
+    }
+    m_parsedOptions = options;
 }
 
-void Engine::startAnalysis(const Board& current) {
-    if (isAnalysing()) return;
+void Engine::startAnalysis(const Board& current,
+                           const SearchLimits& limits) {
+    startSearch("fen " + current.toFen(), limits);
+}
 
-    if (!started()) start();
-    waitForStateOrThrow(Engine::Idling);
+void Engine::startAnalysis(const Board& start, const QVector<Move>& moves,
+                           const SearchLimits& limits) {
+    static const QString startFen = Board().toFen();
+    QString fen = start.toFen();
+    QString position = fen == startFen ? "startpos" : "fen " + fen;
 
-    setState(Engine::Working);
-    // Set all options.
-    for (const QString& key : m_config.options())
-        setOption(key, m_config.option(key));
+    if (!moves.isEmpty()) {
+        position += " moves";
+        for (const Move& move : moves)
+            position += " " + Stringify::longAlgebraicNotationString(move);
+    }
+    startSearch(position, limits);
+}
 
-    send("position fen " + current.toFen());
-    send("go infinite");
+void Engine::startSearch(const QString& position, const SearchLimits& limits) {
+    EngineProcess* process = m_process;
+    quint64 searchId = ++m_searchId;
+
+    m_started = true;
+    m_analysing = true;
+    m_pondering = limits.ponder;
+    QMetaObject::invokeMethod(m_process,
+                              [process, position, limits, searchId]() {
+                                  process->startAnalysis(position, limits,
+                                                         searchId);
+                              });
 }
 
 void Engine::stopAnalysis() {
-    if (!isAnalysing()) return;
-    setState(Engine::Stopping);
-    send("stop");
+    // Variants that are still in flight are no longer interesting.
+    ++m_searchId;
+    m_analysing = false;
+    m_pondering = false;
+    QMetaObject::invokeMethod(m_process, &EngineProcess::stopAnalysis,
+                              Qt::QueuedConnection);
+}
 
-    waitForStateOrThrow(Engine::Idling);
+void Engine::newGame() {
+    QMetaObject::invokeMethod(m_process, &EngineProcess::newGame,
+                              Qt::QueuedConnection);
 }
 
 void Engine::setOption(const QString& name, const QString& value) {
-    send(QString("setoption name %1 value %2").arg(name, value));
+    EngineProcess* process = m_process;
+    QMetaObject::invokeMethod(m_process, [process, name, value]() {
+        process->setOption(name, value);
+    });
 }
 
-bool Engine::isAnalysing() const { return m_state == Engine::Working; }
+void Engine::setRecordFile(const QString& path) {
+    EngineProcess* process = m_process;
+    QMetaObject::invokeMethod(
+        m_process, [process, path]() { process->setRecordFile(path); });
+}
 
-bool Engine::started() const { return m_process->state() == QProcess::Running; }
+void Engine::ponderHit() {
+    if (!m_pondering) return;
 
-EngineConfig Engine::config() { return m_config; }
+    EngineProcess* process = m_process;
+    quint64 searchId = m_searchId;
+    m_pondering = false;
+    QMetaObject::invokeMethod(
+        m_process, [process, searchId]() { process->ponderHit(searchId); });
+}
 
-const QList<EngineOption>& Engine::options() { return m_parsedOptions; }
+bool Engine::isPondering() const { return m_pondering; }
 
-void Engine::onStarted() { send("uci"); }
+qint64 Engine::lastPonderTime() const { return m_lastPonderTime; }
 
-void Engine::onReadyRead() {
-    while (m_process->canReadLine()) {
-        QString line = m_process->readLine();
-        // Make Windows users happy.
-        if (line.contains("\r\n"))
-            line.chop(2);
-        else
-            line.chop(1);
+bool Engine::isAnalysing() const { return m_analysing; }
 
-        setState(parseLine(line));
-    }
-}
+bool Engine::started() const { return m_started; }
 
-void Engine::waitForStateOrThrow(State expectedState) {
-    while (m_state != expectedState) {
-        if (!m_process->waitForReadyRead(m_timeoutMs))
-            throw std::runtime_error("Engine stopped responding.");
-    }
-}
+Engine::State Engine::state() const { return m_state; }
 
-void Engine::parseOption(const QString& line) {
-    static QStringList keywords = {"option",  "name",  "type",   "check",
-                                   "spin",    "combo", "button", "string",
-                                   "default", "min",   "max",    "var"};
+qint64 Engine::lastSearchTime() const { return m_lastSearchTime; }
 
-    QStringList tokens = line.split(" ");
-    QString name;
+EngineConfig Engine::config() { return m_config; }
 
-    for (int i = 0; i < tokens.size(); ++i) {
-        if (tokens[i] == "name") {
-            while (!keywords.contains(tokens[++i])) {
-                name.append(tokens[i]);
-                name.append(' ');
-            }
-            name.chop(1);
-            --i;
-        } else if (tokens[i] == "type") {
-            QString type = tokens[++i];
-            EngineOption option;
-
-            if (type == "check") {
-                ++i;
-                option = EngineOption::checkbox(name, tokens[++i] == "true");
-            } else if (type == "button") {
-                option = EngineOption::button(name);
-            } else if (type == "string") {
-                ++i;
-                QString value;
-                while (++i < tokens.size()) {
-                    value.append(tokens[i]);
-                    value.append(' ');
-                }
-                value.chop(1);
-                option = EngineOption::string(name, value);
-            } else if (type == "spin") {
-                int defaultValue;
-                int minValue;
-                int maxValue;
-                while (++i < tokens.size()) {
-                    if (tokens[i] == "default")
-                        defaultValue = tokens[++i].toInt();
-                    else if (tokens[i] == "min")
-                        minValue = tokens[++i].toInt();
-                    else if (tokens[i] == "max")
-                        maxValue = tokens[++i].toInt();
-                }
-                option = EngineOption::spinbox(name, minValue, maxValue,
-                                               defaultValue);
-            } else {
-                qDebug() << "Warning: ignored option: " << line;
-                break;
-            }
-            m_parsedOptions.push_back(option);
-        }
-    }
+const QList<EngineOption>& Engine::options() { return m_parsedOptions; }
+
+void Engine::onStateChanged(Engine::State state) {
+    State previous = m_state;
+    m_state = state;
+
+    if (state != Engine::Idling) return;
+    if (previous == Engine::Initializing) emit ready();
+    if (previous == Engine::Stopping) emit stopped();
 }
 
-void Engine::parseInfo(const QString& line) {
-    // It is variant info
-    if (line.contains("score")) {
-        QStringList tokens = line.split(" ");
-        QStringList moves;
-        VariantInfo info;
-
-        for (int i = 0; i < tokens.size(); i++) {
-            const QString& token = tokens[i];
-
-            if (token == "score") {
-                const QString& type = tokens[++i];
-                if (type == "cp")
-                    info.setScore(tokens[++i].toInt());
-                else if (type == "mate")
-                    info.setMate(tokens[++i].toInt());
-            } else if (token == "depth") {
-                info.setDepth(tokens[++i].toInt());
-            } else if (token == "multipv") {
-                info.setId(tokens[++i].toInt());
-            } else if (token == "pv") {
-                ++i;
-                while (i < tokens.size()) moves.append(tokens[i++]);
-
-                info.setMoveList(moves);
-            } else if (token == "nps") {
-                info.setNps(tokens[++i].toInt());
-            }
-        }
+void Engine::onOptionsParsed(QList<EngineOption> options) {
+    m_parsedOptions = options;
+    emit optionsParsed(options);
+}
 
-        emit variantParsed(info);
-    } else {
-        // It is engine info.
-    }
+void Engine::onVariantsAvailable() {
+    // Clear the flag first, variants pushed from now on will notify again.
+    m_variants->notified.store(false);
+
+    // Only the newest line of every multipv id is worth delivering.
+    QPair<quint64, PackedVariantInfo> item;
+    QMap<int, PackedVariantInfo> latest;
+    while (m_variants->queue.pop(item))
+        if (item.first == m_searchId) latest[item.second.id()] = item.second;
+
+    for (const PackedVariantInfo& info : latest)
+        emit variantParsed(info.unpack());
 }
 
-Engine::State Engine::parseLine(const QString& line) {
-    Q_ASSERT(m_state != Engine::Idling && "Engine talks while it is idle.");
-
-    switch (m_state) {
-        case Engine::Initializing:
-            // End of the initialization, engine is now idle
-            if (line.startsWith("uciok")) {
-                emit optionsParsed(m_parsedOptions);
-                return Engine::Idling;
-            } else if (line.startsWith("option"))
-                parseOption(line);
-            break;
-        case Engine::Working:
-            if (line.startsWith("info")) parseInfo(line);
-            break;
-        case Engine::Stopping:
-            if (line.startsWith("bestmove")) return Engine::Idling;
-            break;
-        default:
-            break;
-    }
-    // No state change
-    return m_state;
+void Engine::onFailed(QString reason) {
+    m_started = false;
+    m_analysing = false;
+    m_pondering = false;
+    emit failed(reason);
 }
 
-void Engine::setState(State state) { m_state = state; }
+void Engine::onBestMoveFound(quint64 searchId, Move bestMove, Move ponderMove,
+                             VariantInfo info, qint64 timeUs) {
+    if (searchId != m_searchId) return;
+    m_lastSearchTime = timeUs;
 
-void Engine::send(const QString& command) {
-    m_process->write(command.toStdString().c_str());
-    m_process->write("\n");
+    // Deliver variants still waiting in the queue before the result.
+    onVariantsAvailable();
+    m_analysing = false;
+    m_pondering = false;
+    emit bestMoveFound(bestMove, ponderMove, info);
 }
 
-QString Engine::readLine() const { return QString(m_process->readLine()); }
+void Engine::onPonderEnded(quint64, bool hit, qint64 timeUs) {
+    // Misses belong to already superseded searches, report them anyway.
+    m_lastPonderTime = timeUs;
+    emit ponderEnded(hit, timeUs);
+}
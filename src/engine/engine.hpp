@@ -1,39 +1,117 @@
 #ifndef ENGINE_HPP
 #define ENGINE_HPP
-#include <QProcess>
+#include <QPair>
+#include <QThread>
 #include <QVector>
+#include <atomic>
+#include <memory>
 
 #include "engine/engine-config.hpp"
 #include "engine/engine-option.hpp"
+#include "engine/search-limits.hpp"
 #include "engine/variant-info.hpp"
+#include "util/spsc-queue.hpp"
+
+/*! \brief Variants passed from the engine I/O thread to the GUI thread. */
+struct VariantQueue {
+    /*!< Parsed variants tagged with the id of the search they belong to,
+     * packed so that pushing does not allocate */
+    SpscQueue<QPair<quint64, PackedVariantInfo>> queue{1024};
+    /*!< Set while a notification about new variants is in flight */
+    std::atomic<bool> notified{false};
+};
 
 class Board;
+class EngineProcess;
+/*! \brief UCI engine.
+ *
+ * The engine process and its output parser run in a dedicated thread, so
+ * engine output never competes with painting. Control methods never block:
+ * commands are queued and sent once the engine reaches a state in which it
+ * accepts them. Progress is reported with ready(), stopped() and failed()
+ * signals.
+ */
 class Engine : public QObject {
     Q_OBJECT
 public:
     enum State { Working, Stopping, Idling, Initializing, Finished };
+    Q_ENUM(State)
 
     explicit Engine(const EngineConfig& config, const int timeoutMs = 2000);
     ~Engine();
 
-    /*! \brief Starts an engine */
+    /*! \brief Starts an engine, ready() is emitted once it is initialized */
     void start();
 
-    /*! \brief Puts an engine into an ifinite analysis mode */
-    void startAnalysis(const Board& current);
-
-    /*! \brief Stops analysis and blocks until an engine shuts up. */
+    /*! \brief Starts an engine and blocks until it is initialized, throws on
+     * failure. Meant for configuration dialogs, not for the analysis path. */
+    void startAndWait();
+
+    /*! \brief Starts analysis of the position, infinite unless \a limits are
+     * given. A finite search reports its result with bestMoveFound().
+     *
+     * If the engine is busy, the running search is stopped first and the new
+     * one begins as soon as the engine acknowledges it.
+     */
+    void startAnalysis(const Board& current,
+                       const SearchLimits& limits = SearchLimits());
+
+    /*! \brief Starts analysis of the position reached by \a moves from
+     * \a start.
+     *
+     * Engine receives the moves instead of the final position, so it knows
+     * the game history, e.g. for repetitions, and may reuse its search from
+     * the previous move.
+     */
+    void startAnalysis(const Board& start, const QVector<Move>& moves,
+                       const SearchLimits& limits = SearchLimits());
+
+    /*! \brief Requests analysis stop, stopped() is emitted when the engine
+     * shuts up. */
     void stopAnalysis();
 
+    /*! \brief Tells the pondering engine that the opponent has played the
+     * expected move, the ponder search goes on as a normal one and ends
+     * with bestMoveFound().
+     *
+     * On a ponder miss simply start the search of the actual position, the
+     * ponder search is stopped first without blocking.
+     */
+    void ponderHit();
+
+    /*! \brief Returns true if the last search was started with
+     * SearchLimits::ponder and no ponderhit has been sent yet */
+    bool isPondering() const;
+
+    /*! \brief Returns time of the last finished pondering in microseconds,
+     * up to the ponderhit or the stop of the search */
+    qint64 lastPonderTime() const;
+
+    /*! \brief Tells the engine that the next search belongs to a new game,
+     * "ucinewgame" is sent right before it. */
+    void newGame();
+
     /*! \brief Sets engine option. */
     void setOption(const QString& name, const QString& value);
 
-    /*! \brief Returns true if engine is currently analysing the game */
+    /*! \brief Logs UCI traffic from now on into the file, see UciRecorder.
+     * Empty path stops logging. */
+    void setRecordFile(const QString& path);
+
+    /*! \brief Returns true if engine is analysing or about to analyse */
     bool isAnalysing() const;
 
-    /*! \brief Returns true when engine process is started */
+    /*! \brief Returns true when engine start was requested and it has not
+     * failed since */
     bool started() const;
 
+    /*! \brief Returns last state reported by the engine thread */
+    State state() const;
+
+    /*! \brief Returns duration of the last finished search in microseconds,
+     * measured in the engine thread from "go" to "bestmove" */
+    qint64 lastSearchTime() const;
+
     /*! \brief Returns copy of the engine config. */
     EngineConfig config();
 
@@ -42,37 +120,45 @@ public:
 signals:
     void variantParsed(VariantInfo);
     void optionsParsed(QList<EngineOption>);
+    /*! \brief Emitted when the engine finished its initialization */
+    void ready();
+    /*! \brief Emitted when the engine acknowledged stop request */
+    void stopped();
+    /*! \brief Emitted when the engine cannot be started or does not respond */
+    void failed(QString reason);
+    /*! \brief Emitted when a finite search has ended, \a info is the last
+     * principal variant of the search */
+    void bestMoveFound(Move bestMove, Move ponderMove, VariantInfo info);
+    /*! \brief Emitted when pondering ends with a ponderhit or a miss */
+    void ponderEnded(bool hit, qint64 timeUs);
 private slots:
-    void onStarted();
-    void onReadyRead();
+    void onStateChanged(Engine::State state);
+    void onOptionsParsed(QList<EngineOption> options);
+    void onVariantsAvailable();
+    void onFailed(QString reason);
+    void onBestMoveFound(quint64 searchId, Move bestMove, Move ponderMove,
+                         VariantInfo info, qint64 timeUs);
+    void onPonderEnded(quint64 searchId, bool hit, qint64 timeUs);
 
 private:
-    /*! \brief Waits for state change to a specific one or throws. */
-    void waitForStateOrThrow(State expectedState);
+    /*! \brief Queues search of the position given as arguments of the
+     * "position" command */
+    void startSearch(const QString& position, const SearchLimits& limits);
 
-    /*! \brief Parses option */
-    void parseOption(const QString& line);
-
-    /*! \brief Parses info */
-    void parseInfo(const QString& line);
-
-    /*! \brief Parses line from the engine */
-    State parseLine(const QString& line);
-
-    /*! \brief Sets current state */
-    void setState(State state);
-
-    /*! \brief Sends command string to the engine */
-    void send(const QString& command);
-
-    /*! \brief Reads line from the engine */
-    QString readLine() const;
-
-    /*!< \brief Default timeout for engine actions */
     const int m_timeoutMs;
-    QProcess* m_process;
-    State m_state;
     EngineConfig m_config;
+    State m_state;
+    bool m_started;
+    bool m_analysing;
+    /*!< \brief Id of the latest requested search, older variants are dropped */
+    quint64 m_searchId;
+    qint64 m_lastSearchTime;
+    bool m_pondering;
+    qint64 m_lastPonderTime;
+    std::shared_ptr<VariantQueue> m_variants;
+    QThread* m_thread;
+    /*!< \brief Process and parser, owned by m_thread */
+    EngineProcess* m_process;
 
     /*!< \brief List of parsed options declared by the engine. */
     QList<EngineOption> m_parsedOptions;
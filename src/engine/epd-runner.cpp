@@ -0,0 +1,194 @@
+#include "engine/epd-runner.hpp"
+
+#include <QDebug>
+#include <QThread>
+#include <algorithm>
+
+EpdRunner::EpdRunner(const EngineConfig& config, const SearchLimits& limits,
+                     QObject* parent)
+    : QObject(parent),
+      m_config(config),
+      m_limits(limits),
+      m_workerCount(QThread::idealThreadCount()),
+      m_next(0),
+      m_done(0),
+      m_finished(false) {}
+
+EpdRunner::~EpdRunner() = default;
+
+void EpdRunner::setWorkerCount(int count) { m_workerCount = qMax(1, count); }
+
+bool EpdRunner::addPosition(const EpdRecord& record) {
+    if (record.bestMoves.isEmpty() && record.avoidMoves.isEmpty())
+        return false;
+
+    m_positions.append(record);
+    m_results.append(Result());
+    m_attempts.append(0);
+    return true;
+}
+
+void EpdRunner::start() {
+    int workers = qMin(m_workerCount, int(m_positions.size()));
+    for (int i = 0; i < workers; ++i) {
+        auto worker = std::make_unique<Worker>();
+        Worker* pWorker = worker.get();
+        worker->engine = std::make_unique<Engine>(m_config);
+
+        QObject::connect(worker->engine.get(), &Engine::ready, this,
+                         [this, pWorker]() { dispatch(*pWorker); });
+        QObject::connect(worker->engine.get(), &Engine::variantParsed, this,
+                         [this, pWorker](VariantInfo info) {
+                             onVariantParsed(*pWorker, info);
+                         });
+        QObject::connect(
+            worker->engine.get(), &Engine::bestMoveFound, this,
+            [this, pWorker](Move bestMove, Move, VariantInfo info) {
+                onBestMoveFound(*pWorker, bestMove, info);
+            });
+        QObject::connect(worker->engine.get(), &Engine::failed, this,
+                         [this, pWorker](QString reason) {
+                             onFailed(*pWorker, reason);
+                         });
+        worker->engine->start();
+        m_workers.push_back(std::move(worker));
+    }
+    finishIfDone();
+}
+
+int EpdRunner::solved() const {
+    return std::count_if(m_results.begin(), m_results.end(),
+                         [](const Result& result) { return result.solved; });
+}
+
+QString EpdRunner::summary() const {
+    QVector<qint64> times;
+    QVector<qint64> nodes;
+    for (const Result& result : m_results) {
+        if (!result.solved) continue;
+        times.append(result.time);
+        nodes.append(result.nodes);
+    }
+
+    QString text = QString("Solved %1 of %2 (%3%)")
+                       .arg(times.size())
+                       .arg(total())
+                       .arg(total() ? 100.0 * times.size() / total() : 0.0,
+                            0, 'f', 1);
+    if (times.isEmpty()) return text;
+
+    auto describe = [](QVector<qint64> values, const char* unit) {
+        std::sort(values.begin(), values.end());
+        qint64 sum = 0;
+        for (qint64 value : values) sum += value;
+        return QString("mean %1%4, median %2%4, max %3%4")
+            .arg(sum / values.size())
+            .arg(values[values.size() / 2])
+            .arg(values.last())
+            .arg(unit);
+    };
+    text += "\nTime to solve: " + describe(times, " ms");
+    text += "\nNodes to solve: " + describe(nodes, "");
+    return text;
+}
+
+void EpdRunner::dispatch(Worker& worker) {
+    if (worker.position >= 0) return;
+
+    if (!m_retry.isEmpty()) {
+        worker.position = m_retry.takeFirst();
+    } else if (m_next < m_positions.size()) {
+        worker.position = m_next++;
+    } else {
+        // Nothing left, let the process go.
+        retire(worker);
+        finishIfDone();
+        return;
+    }
+
+    worker.result = Result();
+    worker.engine->startAnalysis(m_positions[worker.position].board,
+                                 m_limits);
+}
+
+void EpdRunner::onVariantParsed(Worker& worker, const VariantInfo& info) {
+    if (worker.position < 0 || info.id() > 1 || info.pv().isEmpty()) return;
+
+    // Only the last switch to a right move counts.
+    Result& result = worker.result;
+    if (!isSolution(worker.position, info.pv().first())) {
+        result.time = -1;
+    } else if (result.time < 0) {
+        result.time = info.time();
+        result.nodes = info.nodes();
+        result.depth = info.depth();
+    }
+}
+
+void EpdRunner::onBestMoveFound(Worker& worker, Move bestMove,
+                                VariantInfo info) {
+    int position = worker.position;
+    Result& result = worker.result;
+    result.bestMove = bestMove;
+    result.solved = isSolution(position, bestMove);
+    if (!result.solved) {
+        result.time = -1;
+    } else if (result.time < 0) {
+        // Engine printed no line with the move.
+        result.time = info.time();
+        result.nodes = info.nodes();
+        result.depth = info.depth();
+    }
+
+    m_results[position] = result;
+    worker.position = -1;
+    ++m_done;
+    emit positionFinished(position);
+    dispatch(worker);
+}
+
+void EpdRunner::onFailed(Worker& worker, QString reason) {
+    if (worker.position < 0) {
+        qWarning() << "Engine failed to start:" << reason;
+        retire(worker);
+        finishIfDone();
+        return;
+    }
+
+    int position = worker.position;
+    worker.position = -1;
+    if (++m_attempts[position] < MaxAttempts) {
+        m_retry.append(position);
+    } else {
+        // Counts as unsolved, the suite goes on.
+        qWarning() << "Skipping" << m_positions[position].id << ":" << reason;
+        ++m_done;
+        emit positionFinished(position);
+    }
+    // Search request restarts the dead process.
+    dispatch(worker);
+}
+
+void EpdRunner::retire(Worker& worker) {
+    // We are most likely inside a signal of the engine.
+    if (worker.engine) worker.engine.release()->deleteLater();
+}
+
+void EpdRunner::finishIfDone() {
+    if (m_finished) return;
+
+    for (const auto& worker : m_workers)
+        if (worker->engine) return;
+
+    m_finished = true;
+    if (m_done < total()) qWarning() << "No engine left to run positions.";
+    // Queued, start() may get here before the caller enters event loop.
+    QMetaObject::invokeMethod(this, &EpdRunner::finished, Qt::QueuedConnection);
+}
+
+bool EpdRunner::isSolution(int position, Move move) const {
+    const EpdRecord& record = m_positions[position];
+    if (move == Move::NullMove || record.avoidMoves.contains(move))
+        return false;
+    return record.bestMoves.isEmpty() || record.bestMoves.contains(move);
+}
@@ -0,0 +1,101 @@
+#ifndef EPD_RUNNER_HPP
+#define EPD_RUNNER_HPP
+#include <QList>
+#include <QObject>
+#include <QVector>
+#include <memory>
+#include <vector>
+
+#include "engine/engine.hpp"
+#include "pgn/epd-reader.hpp"
+
+/*! \brief Runs an EPD test suite with a pool of engine processes.
+ *
+ * Workers are engine processes that search one position at a time under
+ * the same limits, as in BatchAnalyzer. A position is solved if the final
+ * best move is one of its bm moves and none of its am moves. The solution
+ * is found when the main line last switched to a right move. A right move
+ * that was dropped and found again counts from the second time.
+ */
+class EpdRunner : public QObject {
+    Q_OBJECT
+public:
+    struct Result {
+        /*!< Final best move, null if the engine failed on the position */
+        Move bestMove = Move::NullMove;
+        bool solved = false;
+        /*!< Engine time in milliseconds, nodes and depth when the solution
+         * was found, time is -1 if it was not */
+        qint64 time = -1;
+        qint64 nodes = 0;
+        int depth = 0;
+    };
+
+    EpdRunner(const EngineConfig& config, const SearchLimits& limits,
+              QObject* parent = nullptr);
+    ~EpdRunner();
+
+    /*! \brief Sets number of engine processes, defaults to number of cores */
+    void setWorkerCount(int count);
+
+    /*! \brief Queues position of the suite.
+     * \returns false if the record has neither bm nor am moves
+     */
+    bool addPosition(const EpdRecord& record);
+
+    /*! \brief Starts engines, finished() is queued when all positions are
+     * done, also when there is nothing to do */
+    void start();
+
+    int total() const { return m_positions.size(); }
+    int done() const { return m_done; }
+    int solved() const;
+
+    const QVector<EpdRecord>& positions() const { return m_positions; }
+    const QVector<Result>& results() const { return m_results; }
+
+    /*! \brief Returns solved count with mean, median and maximal time and
+     * nodes to solve, one item per line */
+    QString summary() const;
+signals:
+    /*! \brief Result of position \a index is known */
+    void positionFinished(int index);
+    void finished();
+
+private:
+    struct Worker {
+        std::unique_ptr<Engine> engine;
+        /*!< Index of the searched position or -1 */
+        int position = -1;
+        /*!< Result collected from the info lines so far */
+        Result result;
+    };
+
+    void dispatch(Worker& worker);
+    void onVariantParsed(Worker& worker, const VariantInfo& info);
+    void onBestMoveFound(Worker& worker, Move bestMove, VariantInfo info);
+    void onFailed(Worker& worker, QString reason);
+    /*! \brief Stops engine of the worker */
+    void retire(Worker& worker);
+    void finishIfDone();
+    bool isSolution(int position, Move move) const;
+
+    /*!< Maximal number of engine failures on a single position */
+    static const int MaxAttempts = 3;
+
+    EngineConfig m_config;
+    SearchLimits m_limits;
+    int m_workerCount;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    QVector<EpdRecord> m_positions;
+    QVector<Result> m_results;
+    /*!< Index of the next position to hand out */
+    int m_next;
+    /*!< Positions handed back after an engine failure */
+    QList<int> m_retry;
+    QVector<int> m_attempts;
+    int m_done;
+    bool m_finished;
+};
+
+#endif  // EPD_RUNNER_HPP
@@ -0,0 +1,55 @@
+#include "engine/search-limits.hpp"
+
+#include "util/stringify.hpp"
+
+bool SearchLimits::isInfinite() const {
+    return depth <= 0 && nodes <= 0 && moveTime <= 0 && !hasClock();
+}
+
+bool SearchLimits::hasClock() const { return whiteTime > 0 || blackTime > 0; }
+
+qint64 SearchLimits::maxDuration() const {
+    // Lowest speed a working engine is expected to search at.
+    static const qint64 MinNodesPerSecond = 10000;
+
+    qint64 duration = 0;
+    if (moveTime > 0) duration = moveTime;
+    if (hasClock()) {
+        // Side to move is not known here, either clock bounds the search.
+        qint64 clock = qMax(whiteTime + whiteIncrement,
+                            blackTime + blackIncrement);
+        duration = duration > 0 ? qMin(duration, clock) : clock;
+    }
+    if (nodes > 0) {
+        qint64 nodeTime = nodes * 1000 / MinNodesPerSecond;
+        duration = duration > 0 ? qMin(duration, nodeTime) : nodeTime;
+    }
+    return duration;
+}
+
+QString SearchLimits::toUci() const {
+    QString command = "go";
+
+    if (ponder) command += " ponder";
+    if (hasClock()) {
+        command += QString(" wtime %1 btime %2").arg(whiteTime).arg(blackTime);
+        if (whiteIncrement > 0)
+            command += QString(" winc %1").arg(whiteIncrement);
+        if (blackIncrement > 0)
+            command += QString(" binc %1").arg(blackIncrement);
+        if (movesToGo > 0)
+            command += QString(" movestogo %1").arg(movesToGo);
+    }
+    if (depth > 0) command += QString(" depth %1").arg(depth);
+    if (nodes > 0) command += QString(" nodes %1").arg(nodes);
+    if (moveTime > 0) command += QString(" movetime %1").arg(moveTime);
+    if (isInfinite()) command += " infinite";
+
+    // Engines read moves up to the end of the line, keep them last.
+    if (!searchMoves.isEmpty()) {
+        command += " searchmoves";
+        for (const Move& move : searchMoves)
+            command += " " + Stringify::longAlgebraicNotationString(move);
+    }
+    return command;
+}
@@ -0,0 +1,48 @@
+#ifndef SEARCH_LIMITS_HPP
+#define SEARCH_LIMITS_HPP
+#include <QString>
+#include <QVector>
+
+#include "game/move.hpp"
+
+/*! \brief Limits of a single engine search.
+ *
+ * Zero means the limit is not set, search without any limit is an infinite
+ * analysis which runs until it is stopped.
+ */
+struct SearchLimits {
+    /*!< Maximal search depth in plies */
+    int depth = 0;
+    /*!< Maximal number of searched nodes */
+    qint64 nodes = 0;
+    /*!< Exact search time in milliseconds */
+    int moveTime = 0;
+    /*!< Remaining clock times in milliseconds */
+    qint64 whiteTime = 0;
+    qint64 blackTime = 0;
+    /*!< Increments per move in milliseconds */
+    qint64 whiteIncrement = 0;
+    qint64 blackIncrement = 0;
+    /*!< Number of moves to the next time control */
+    int movesToGo = 0;
+    /*!< Root moves the search is restricted to, empty for all moves */
+    QVector<Move> searchMoves;
+    /*!< Search is pondering on the expected opponent's move */
+    bool ponder = false;
+
+    /*! \brief Returns true if no limit is set */
+    bool isInfinite() const;
+
+    /*! \brief Returns true if the search is limited by clocks */
+    bool hasClock() const;
+
+    /*! \brief Returns longest time the search may take in milliseconds, 0
+     * if it is not bounded. Node limits assume a slow engine, a search
+     * limited by depth only is not bounded. */
+    qint64 maxDuration() const;
+
+    /*! \brief Returns UCI "go" command of these limits */
+    QString toUci() const;
+};
+
+#endif  // SEARCH_LIMITS_HPP
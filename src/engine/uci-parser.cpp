@@ -0,0 +1,148 @@
+#include "engine/uci-parser.hpp"
+
+#include <cstring>
+
+bool UciTokenizer::next(const char*& tokenBegin, const char*& tokenEnd) {
+    while (m_current < m_end && (*m_current == ' ' || *m_current == '\t'))
+        ++m_current;
+    if (m_current == m_end) return false;
+
+    tokenBegin = m_current;
+    while (m_current < m_end && *m_current != ' ' && *m_current != '\t')
+        ++m_current;
+    tokenEnd = m_current;
+    return true;
+}
+
+bool UciParser::equals(const char* begin, const char* end,
+                       const char* keyword) {
+    size_t length = std::strlen(keyword);
+    return size_t(end - begin) == length &&
+           std::memcmp(begin, keyword, length) == 0;
+}
+
+bool UciParser::startsWith(const char* begin, const char* end,
+                           const char* keyword) {
+    size_t length = std::strlen(keyword);
+    return size_t(end - begin) >= length &&
+           std::memcmp(begin, keyword, length) == 0;
+}
+
+qint64 UciParser::toInt(const char* begin, const char* end) {
+    bool negative = false;
+    qint64 value = 0;
+
+    if (begin < end && (*begin == '-' || *begin == '+'))
+        negative = *begin++ == '-';
+    for (; begin < end; ++begin) {
+        if (*begin < '0' || *begin > '9') return 0;
+        value = value * 10 + (*begin - '0');
+    }
+    return negative ? -value : value;
+}
+
+bool UciParser::parseMove(const char* begin, const char* end, Move& move) {
+    int length = end - begin;
+    if (length != 4 && length != 5) return false;
+
+    for (int i = 0; i < 4; i += 2) {
+        if (begin[i] < 'a' || begin[i] > 'h') return false;
+        if (begin[i + 1] < '1' || begin[i + 1] > '8') return false;
+    }
+
+    move.From = Coord2D<int>(begin[0] - 'a', '8' - begin[1]);
+    move.To = Coord2D<int>(begin[2] - 'a', '8' - begin[3]);
+    move.PromotionPiece = Piece::Type::None;
+
+    if (length == 5) {
+        switch (begin[4]) {
+            case 'q':
+                move.PromotionPiece = Piece::Type::Queen;
+                break;
+            case 'r':
+                move.PromotionPiece = Piece::Type::Rook;
+                break;
+            case 'b':
+                move.PromotionPiece = Piece::Type::Bishop;
+                break;
+            case 'n':
+                move.PromotionPiece = Piece::Type::Knight;
+                break;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+bool UciParser::parseInfo(const QByteArray& line, VariantInfo& info) {
+    return parseInfo(line.constData(), line.constData() + line.size(), info);
+}
+
+bool UciParser::parseInfo(const char* begin, const char* end,
+                          VariantInfo& info) {
+    UciTokenizer tokens(begin, end);
+    const char* token;
+    const char* tokenEnd;
+    const char* value;
+    const char* valueEnd;
+    bool hasScore = false;
+
+    info.clear();
+    // Skip "info"
+    if (!tokens.next(token, tokenEnd) || !equals(token, tokenEnd, "info"))
+        return false;
+
+    // Reads value of the current keyword.
+    auto nextValue = [&]() { return tokens.next(value, valueEnd); };
+
+    while (tokens.next(token, tokenEnd)) {
+        if (equals(token, tokenEnd, "depth")) {
+            if (nextValue()) info.setDepth(toInt(value, valueEnd));
+        } else if (equals(token, tokenEnd, "seldepth")) {
+            if (nextValue()) info.setSelDepth(toInt(value, valueEnd));
+        } else if (equals(token, tokenEnd, "multipv")) {
+            if (!nextValue()) break;
+            // Lines are numbered from 1, other ids have no slot.
+            int id = toInt(value, valueEnd);
+            if (id < 1) return false;
+            info.setId(id);
+        } else if (equals(token, tokenEnd, "score")) {
+            if (!nextValue()) break;
+            bool mate = equals(value, valueEnd, "mate");
+            if (!mate && !equals(value, valueEnd, "cp")) continue;
+            if (!nextValue()) break;
+
+            hasScore = true;
+            if (mate)
+                info.setMate(toInt(value, valueEnd));
+            else
+                info.setScore(toInt(value, valueEnd));
+        } else if (equals(token, tokenEnd, "lowerbound")) {
+            info.setBound(VariantInfo::LowerBound);
+        } else if (equals(token, tokenEnd, "upperbound")) {
+            info.setBound(VariantInfo::UpperBound);
+        } else if (equals(token, tokenEnd, "nodes")) {
+            if (nextValue()) info.setNodes(toInt(value, valueEnd));
+        } else if (equals(token, tokenEnd, "nps")) {
+            if (nextValue()) info.setNps(toInt(value, valueEnd));
+        } else if (equals(token, tokenEnd, "time")) {
+            if (nextValue()) info.setTime(toInt(value, valueEnd));
+        } else if (equals(token, tokenEnd, "hashfull")) {
+            if (nextValue()) info.setHashFull(toInt(value, valueEnd));
+        } else if (equals(token, tokenEnd, "tbhits")) {
+            if (nextValue()) info.setTbHits(toInt(value, valueEnd));
+        } else if (equals(token, tokenEnd, "pv")) {
+            QVector<Move>& pv = info.pv();
+            Move move;
+            // PV lasts until the end of the line or the first non-move.
+            while (nextValue() && parseMove(value, valueEnd, move))
+                pv.append(move);
+        } else if (equals(token, tokenEnd, "string")) {
+            // Free text until the end of the line.
+            break;
+        }
+    }
+
+    return hasScore;
+}
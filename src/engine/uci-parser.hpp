@@ -0,0 +1,58 @@
+#ifndef UCI_PARSER_HPP
+#define UCI_PARSER_HPP
+#include <QByteArray>
+
+#include "engine/variant-info.hpp"
+
+/*! \brief Splits raw engine output into space separated tokens in place. */
+class UciTokenizer {
+public:
+    UciTokenizer(const char* begin, const char* end)
+        : m_current(begin), m_end(end) {}
+
+    /*! \brief Moves to the next token.
+     * \returns false when there are no more tokens
+     */
+    bool next(const char*& tokenBegin, const char*& tokenEnd);
+
+    /*! \brief Returns not yet tokenized rest of the line */
+    const char* rest() const { return m_current; }
+
+private:
+    const char* m_current;
+    const char* m_end;
+};
+
+/*! \brief Allocation-free parser of UCI engine output. */
+class UciParser {
+public:
+    UciParser() = delete;
+
+    /*! \brief Parses "info" line into \a info.
+     *
+     * All fields of \a info are reset first, storage of its move list is
+     * reused.
+     * \returns true if the line describes a variant, that is it has a score
+     * and a valid multipv id
+     */
+    static bool parseInfo(const char* begin, const char* end,
+                          VariantInfo& info);
+    static bool parseInfo(const QByteArray& line, VariantInfo& info);
+
+    /*! \brief Parses move in long algebraic notation, e.g. e7e8q.
+     * \returns false if the token is not a valid move
+     */
+    static bool parseMove(const char* begin, const char* end, Move& move);
+
+    /*! \brief Tests whether token is equal to the keyword */
+    static bool equals(const char* begin, const char* end, const char* keyword);
+
+    /*! \brief Tests whether line starts with the keyword */
+    static bool startsWith(const char* begin, const char* end,
+                           const char* keyword);
+
+    /*! \brief Parses signed decimal integer, returns 0 if invalid */
+    static qint64 toInt(const char* begin, const char* end);
+};
+
+#endif  // UCI_PARSER_HPP
@@ -0,0 +1,29 @@
+#include "engine/uci-recorder.hpp"
+
+#include <cstdio>
+
+bool UciRecorder::open(const QString& path) {
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+    m_clock.start();
+    return true;
+}
+
+void UciRecorder::close() {
+    if (m_file.isOpen()) m_file.close();
+}
+
+void UciRecorder::record(Direction direction, const char* begin,
+                         const char* end) {
+    if (!m_file.isOpen()) return;
+
+    char prefix[32];
+    long long time = m_clock.nsecsElapsed() / 1000;
+    int length = std::snprintf(prefix, sizeof(prefix), "%lld %c ", time,
+                               static_cast<char>(direction));
+    m_file.write(prefix, length);
+    m_file.write(begin, end - begin);
+    m_file.write("\n", 1);
+}
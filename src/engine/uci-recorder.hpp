@@ -0,0 +1,32 @@
+#ifndef UCI_RECORDER_HPP
+#define UCI_RECORDER_HPP
+#include <QElapsedTimer>
+#include <QFile>
+
+/*! \brief Log of the UCI traffic of one engine process.
+ *
+ * Every line of the log is a single message:
+ *
+ *     <microseconds since the log was opened> <direction> <message>
+ *
+ * where direction is '>' for commands sent to the engine and '<' for engine
+ * output. The uci-replay tool plays such a log back as a stand-in engine.
+ */
+class UciRecorder {
+public:
+    enum Direction { ToEngine = '>', FromEngine = '<' };
+
+    /*! \brief Starts a new log, \returns false if it cannot be written */
+    bool open(const QString& path);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    /*! \brief Appends message to the log */
+    void record(Direction direction, const char* begin, const char* end);
+
+private:
+    QFile m_file;
+    QElapsedTimer m_clock;
+};
+
+#endif  // UCI_RECORDER_HPP
@@ -1,30 +1,114 @@
 #include "engine/variant-info.hpp"
 
-VariantInfo::VariantInfo()
-    : m_id(1), m_score(0), m_depth(0), m_mate(0), m_nps(0) {}
+VariantInfo::VariantInfo() { clear(); }
 
-void VariantInfo::setMoveList(const QStringList& moveList) {
-    m_moveList = moveList;
+void VariantInfo::clear() {
+    m_pv.clear();
+    m_id = 1;
+    m_score = 0;
+    m_depth = 0;
+    m_selDepth = 0;
+    m_mate = 0;
+    m_bound = Exact;
+    m_nodes = 0;
+    m_nps = 0;
+    m_time = 0;
+    m_hashFull = 0;
+    m_tbHits = 0;
 }
 
+void VariantInfo::setPv(const QVector<Move>& pv) { m_pv = pv; }
+
 void VariantInfo::setId(const int id) { m_id = id; }
 
 void VariantInfo::setMate(const int moves) { m_mate = moves; }
 
 void VariantInfo::setDepth(const int depth) { m_depth = depth; }
 
+void VariantInfo::setSelDepth(const int selDepth) { m_selDepth = selDepth; }
+
 void VariantInfo::setScore(const int score) { m_score = score; }
 
-void VariantInfo::setNps(const int nodesPerSecond) { m_nps = nodesPerSecond; }
+void VariantInfo::setBound(const Bound bound) { m_bound = bound; }
+
+void VariantInfo::setNodes(const qint64 nodes) { m_nodes = nodes; }
+
+void VariantInfo::setNps(const qint64 nodesPerSecond) {
+    m_nps = nodesPerSecond;
+}
+
+void VariantInfo::setTime(const qint64 milliseconds) { m_time = milliseconds; }
+
+void VariantInfo::setHashFull(const int permill) { m_hashFull = permill; }
 
-const QStringList& VariantInfo::moveList() const { return m_moveList; }
+void VariantInfo::setTbHits(const qint64 tbHits) { m_tbHits = tbHits; }
+
+const QVector<Move>& VariantInfo::pv() const { return m_pv; }
+
+QVector<Move>& VariantInfo::pv() { return m_pv; }
 
 int VariantInfo::id() const { return m_id; }
 
 int VariantInfo::depth() const { return m_depth; }
 
-int VariantInfo::nps() const { return m_nps; }
+int VariantInfo::selDepth() const { return m_selDepth; }
+
+qint64 VariantInfo::nodes() const { return m_nodes; }
+
+qint64 VariantInfo::nps() const { return m_nps; }
+
+qint64 VariantInfo::time() const { return m_time; }
+
+int VariantInfo::hashFull() const { return m_hashFull; }
+
+qint64 VariantInfo::tbHits() const { return m_tbHits; }
 
 int VariantInfo::score() const { return m_score; }
 
 int VariantInfo::mate() const { return m_mate; }
+
+VariantInfo::Bound VariantInfo::bound() const { return m_bound; }
+
+PackedVariantInfo::PackedVariantInfo() : m_pvLength(0) {}
+
+void PackedVariantInfo::clear() {
+    m_info.clear();
+    m_pvLength = 0;
+}
+
+void PackedVariantInfo::assign(const VariantInfo& info) {
+    m_info = info;
+    // Releases the shared pv right away, \a info is its only owner again
+    // and reuses the storage for the next line without detaching.
+    m_info.pv() = QVector<Move>();
+
+    const QVector<Move>& pv = info.pv();
+    m_pvLength = qMin(int(pv.size()), int(MaxPvLength));
+    for (int i = 0; i < m_pvLength; ++i) m_pv[i] = packMove(pv[i]);
+}
+
+VariantInfo PackedVariantInfo::unpack() const {
+    VariantInfo info = m_info;
+    QVector<Move>& pv = info.pv();
+    pv.reserve(m_pvLength);
+    for (int i = 0; i < m_pvLength; ++i) pv.append(unpackMove(m_pv[i]));
+    return info;
+}
+
+quint16 PackedVariantInfo::packMove(const Move& move) {
+    int promotion = move.PromotionPiece == Piece::Type::None
+                        ? 0
+                        : static_cast<int>(move.PromotionPiece);
+    return (move.From.x + 8 * move.From.y) |
+           (move.To.x + 8 * move.To.y) << 6 | promotion << 12;
+}
+
+Move PackedVariantInfo::unpackMove(quint16 packed) {
+    int from = packed & 63;
+    int to = (packed >> 6) & 63;
+    int promotion = (packed >> 12) & 7;
+
+    return Move(Coord2D<int>(from % 8, from / 8), Coord2D<int>(to % 8, to / 8),
+                promotion ? static_cast<Piece::Type>(promotion)
+                          : Piece::Type::None);
+}
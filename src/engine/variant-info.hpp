@@ -1,32 +1,95 @@
 #ifndef VARIANT_INFO_HPP
 #define VARIANT_INFO_HPP
-#include <QStringList>
+#include <QVector>
+
+#include "game/move.hpp"
 
 class VariantInfo {
 public:
+    /*! \brief Kind of the reported score */
+    enum Bound { Exact, LowerBound, UpperBound };
+
     VariantInfo();
 
-    void setMoveList(const QStringList& moveList);
+    /*! \brief Resets all fields, keeps allocated move list storage */
+    void clear();
+
+    void setPv(const QVector<Move>& pv);
     void setId(const int id);
     void setMate(const int moves);
     void setScore(const int score);
+    void setBound(const Bound bound);
     void setDepth(const int depth);
-    void setNps(const int nodesPerSecond);
+    void setSelDepth(const int selDepth);
+    void setNodes(const qint64 nodes);
+    void setNps(const qint64 nodesPerSecond);
+    void setTime(const qint64 milliseconds);
+    void setHashFull(const int permill);
+    void setTbHits(const qint64 tbHits);
 
-    const QStringList& moveList() const;
+    /*! \brief Returns principal variation */
+    const QVector<Move>& pv() const;
+    /*! \brief Returns principal variation for in-place filling */
+    QVector<Move>& pv();
     int id() const;
     int score() const;
     int mate() const;
+    Bound bound() const;
     int depth() const;
-    int nps() const;
+    int selDepth() const;
+    qint64 nodes() const;
+    qint64 nps() const;
+    qint64 time() const;
+    int hashFull() const;
+    qint64 tbHits() const;
 
 private:
-    QStringList m_moveList;
+    QVector<Move> m_pv;
     int m_id;
     int m_score;
     int m_depth;
+    int m_selDepth;
     int m_mate;
-    int m_nps;
+    Bound m_bound;
+    qint64 m_nodes;
+    qint64 m_nps;
+    qint64 m_time;
+    int m_hashFull;
+    qint64 m_tbHits;
+};
+
+/*! \brief VariantInfo with the principal variation packed into a fixed
+ * buffer.
+ *
+ * Assigning a variant never allocates and shares no storage with it, so
+ * the engine I/O thread keeps and queues variants without touching the
+ * heap. Moves beyond MaxPvLength are dropped.
+ */
+class PackedVariantInfo {
+public:
+    enum { MaxPvLength = 128 };
+
+    PackedVariantInfo();
+
+    /*! \brief Resets to an empty variant */
+    void clear();
+
+    /*! \brief Copies \a info, its pv storage stays unshared */
+    void assign(const VariantInfo& info);
+
+    /*! \brief Returns the variant with its pv, allocates */
+    VariantInfo unpack() const;
+
+    int id() const { return m_info.id(); }
+
+private:
+    static quint16 packMove(const Move& move);
+    static Move unpackMove(quint16 packed);
+
+    /*!< All fields but the pv, which is always empty */
+    VariantInfo m_info;
+    int m_pvLength;
+    quint16 m_pv[MaxPvLength];
 };
 
 #endif
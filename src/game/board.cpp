@@ -162,18 +162,13 @@ QString Board::toFen() const {
     // Side to move
     fen += (currentPlayer().isWhite() ? " w " : " b ");
 
-    // Castling rights
-    if (!hasShortCastlingRights(Player::white()) &&
-        !hasShortCastlingRights(Player::black()) &&
-        !hasLongCastlingRights(Player::black()) &&
-        !hasLongCastlingRights(Player::white()))
-        fen += " - ";
-    else {
-        fen += hasShortCastlingRights(Player::white()) ? "K" : "";
-        fen += hasLongCastlingRights(Player::white()) ? "Q" : "";
-        fen += hasShortCastlingRights(Player::black()) ? "k" : "";
-        fen += hasLongCastlingRights(Player::black()) ? "q" : "";
-    }
+    // Castling rights, fields are separated by single spaces for setFen()
+    QString castling;
+    castling += hasShortCastlingRights(Player::white()) ? "K" : "";
+    castling += hasLongCastlingRights(Player::white()) ? "Q" : "";
+    castling += hasShortCastlingRights(Player::black()) ? "k" : "";
+    castling += hasLongCastlingRights(Player::black()) ? "q" : "";
+    fen += castling.isEmpty() ? QString("-") : castling;
 
     // En passant
     if (isLegalCoord(m_state.EnPassantCoords.x, m_state.EnPassantCoords.y))
@@ -227,10 +222,76 @@ bool Board::isCheck() const {
 }
 
 bool Board::isCheckmate() const {
-    // TODO: stub
-    return false;
+    return countChecksFor(currentPlayer()) > 0 && legalMoves().isEmpty();
+}
+
+bool Board::isStalemate() const {
+    return countChecksFor(currentPlayer()) == 0 && legalMoves().isEmpty();
+}
+
+bool Board::isInsufficientMaterial() const {
+    int minorPieces = 0;
+    // Bishops standing on light and dark squares
+    int bishopColors[2] = {0, 0};
+
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            const Piece& piece = pieceAt(x, y);
+
+            if (piece.isNone() || piece.isKing()) continue;
+            if (piece.isPawn() || piece.isRook() || piece.isQueen())
+                return false;
+            if (piece.isBishop()) ++bishopColors[(x + y) % 2];
+            ++minorPieces;
+        }
+    }
+    // Lone minor piece, or bishops all on the squares of one color.
+    return minorPieces <= 1 || bishopColors[0] == minorPieces ||
+           bishopColors[1] == minorPieces;
+}
+
+QVector<Move> Board::legalMoves() const {
+    static const Piece::Type promotions[] = {
+        Piece::Type::Queen, Piece::Type::Rook, Piece::Type::Bishop,
+        Piece::Type::Knight};
+    QVector<Move> moves;
+    Player player = currentPlayer();
+
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            const Piece& piece = pieceAt(x, y);
+            if (piece.owner() != player) continue;
+
+            // Squares the piece may go to, isLegal() sorts out the rest.
+            CoordsVector targets = getAttackedCoords(piece, player, {x, y});
+            if (piece.isPawn()) {
+                int step = player.isWhite() ? -1 : 1;
+                targets.push_back({x, y + step});
+                targets.push_back({x, y + 2 * step});
+            } else if (piece.isKing()) {
+                targets.push_back({x + 2, y});
+                targets.push_back({x - 2, y});
+            }
+
+            for (const Coord2D<int>& target : targets) {
+                if (!isLegalCoord(target)) continue;
+
+                Move move(Coord2D<int>(x, y), target);
+                if (!isLegal(move)) continue;
+
+                if (piece.isPawn() && (target.y == 0 || target.y == 7)) {
+                    for (Piece::Type promotion : promotions)
+                        moves.push_back(Move(move.From, move.To, promotion));
+                } else
+                    moves.push_back(move);
+            }
+        }
+    }
+    return moves;
 }
 
+int Board::halfMoveClock() const { return m_state.HalfMoveClock; }
+
 bool Board::hasShortCastlingRights(const Player& player) const {
     return m_state.ShortCastlingRight.at(player);
 }
@@ -92,6 +92,20 @@ public:
     /*! \brief Tests whether board position is a checkmate. */
     bool isCheckmate() const;
 
+    /*! \brief Tests whether current player has no legal move and is not in
+     * check. */
+    bool isStalemate() const;
+
+    /*! \brief Tests whether neither player has enough material to mate. */
+    bool isInsufficientMaterial() const;
+
+    /*! \brief Returns all legal moves of the current player. */
+    QVector<Move> legalMoves() const;
+
+    /*! \brief Returns number of half-moves since the last capture or pawn
+     * move */
+    int halfMoveClock() const;
+
     /*! \brief Tests whether given player has short castling rights. */
     bool hasShortCastlingRights(const Player& player) const;
 
@@ -32,6 +32,8 @@ const TreeNode* TreeNode::root() const {
 
 const TreeNode* TreeNode::parentLine() const { return m_parentLine; }
 
+const Move& TreeNode::parentMove() const { return m_parentMove; }
+
 bool TreeNode::hasNext(Move move) const { return m_moves.contains(move); }
 
 bool TreeNode::hasNeighbours() const { return m_moves.size(); }
@@ -178,6 +180,37 @@ void Tree::clear() {
         delete m_root.delTransition(move);
 }
 
+void Tree::setComment(const QString& comment) {
+    m_current->m_comment = comment;
+}
+
+void Tree::addNag(int nag) {
+    if (!m_current->m_nags.contains(nag)) m_current->m_nags.append(nag);
+}
+
+bool Tree::back() {
+    if (!m_current->parent()) return false;
+
+    m_current = m_current->parent();
+    return true;
+}
+
+void Tree::setTag(const QString& name, const QString& value) {
+    for (auto& tag : m_tags) {
+        if (tag.first == name) {
+            tag.second = value;
+            return;
+        }
+    }
+    m_tags.append({name, value});
+}
+
+QString Tree::tag(const QString& name) const {
+    for (const auto& tag : m_tags)
+        if (tag.first == name) return tag.second;
+    return QString();
+}
+
 void Tree::setCurrent(TreeNode* node) {
     Q_ASSERT(node && "Setting null node.");
 
@@ -1,6 +1,10 @@
 #ifndef GAME_TREE_HPP
 #define GAME_TREE_HPP
+#include <QList>
 #include <QMap>
+#include <QPair>
+#include <QString>
+#include <QVector>
 
 #include "game/board.hpp"
 
@@ -30,12 +34,18 @@ public:
     /*! \brief Returns parent line node */
     const TreeNode* parentLine() const;
 
+    /*! \brief Returns move leading from the parent to this node */
+    const Move& parentMove() const;
+
     /*! \brief Checks whether \a move is one of the next moves. */
     bool hasNext(Move move) const;
 
     /*! \brief Tests whether this node has neighbours */
     bool hasNeighbours() const;
 
+    /*! \brief Tests whether there is a move besides the main line one */
+    bool hasVariations() const { return m_moves.size() > 1; }
+
     /*! \brief Returns next move in the mainline */
     Move nextMove() const;
 
@@ -72,6 +82,12 @@ public:
 
     const Board *getBoard() const;
 
+    /*! \brief Returns comment following the move of this node */
+    const QString& comment() const { return m_comment; }
+
+    /*! \brief Returns numeric annotation glyphs of the move, e.g. 1 for "!" */
+    const QVector<int>& nags() const { return m_nags; }
+
 private:
     /** Same set of methods as above but for internal / friend class usage only,
      * to avoid stupid const_casting everywhere */
@@ -92,6 +108,8 @@ private:
 
     Move m_parentMove;
     mutable std::unique_ptr<Board> m_board;
+    QString m_comment;
+    QVector<int> m_nags;
 };
 
 class Tree {
@@ -136,11 +154,33 @@ public:
 
     const Board* getBoard() const { return m_current->getBoard(); }
 
+    /*! \brief Sets comment of the current node, comment of the root goes
+     * before the first move */
+    void setComment(const QString &comment);
+
+    /*! \brief Adds numeric annotation glyph to the current node */
+    void addNag(int nag);
+
+    /*! \brief Sets current node to its parent
+     * \returns false at the root
+     */
+    bool back();
+
+    /*! \brief Sets PGN tag, tags keep the order in which they are set */
+    void setTag(const QString &name, const QString &value);
+
+    /*! \brief Returns value of PGN tag, empty if there is none */
+    QString tag(const QString &name) const;
+
+    const QList<QPair<QString, QString>> &tags() const { return m_tags; }
+
 private:
     /*! \brief Root node */
     TreeNode m_root;
     /*! \brief Currently active node */
     TreeNode* m_current;
+    /*! \brief PGN tags of the game */
+    QList<QPair<QString, QString>> m_tags;
 };
 
 #endif
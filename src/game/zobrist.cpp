@@ -0,0 +1,85 @@
+#include "game/zobrist.hpp"
+
+#include "game/board.hpp"
+
+namespace {
+
+struct Keys {
+    quint64 pieces[6][2][64];
+    quint64 castling[4];
+    quint64 enPassant[8];
+    quint64 side;
+
+    Keys() {
+        // SplitMix64, changing the seed invalidates stored hashes.
+        quint64 state = 0x9e3779b97f4a7c15ull;
+        auto next = [&state]() {
+            quint64 z = (state += 0x9e3779b97f4a7c15ull);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return z ^ (z >> 31);
+        };
+
+        for (auto& piece : pieces)
+            for (auto& color : piece)
+                for (quint64& key : color) key = next();
+        for (quint64& key : castling) key = next();
+        for (quint64& key : enPassant) key = next();
+        side = next();
+    }
+};
+
+const Keys& keys() {
+    static const Keys instance;
+    return instance;
+}
+
+}  // namespace
+
+quint64 Zobrist::pieceKey(int piece, int color, int square) {
+    return keys().pieces[piece][color][square];
+}
+
+quint64 Zobrist::castlingKey(int index) { return keys().castling[index]; }
+
+quint64 Zobrist::enPassantKey(int file) { return keys().enPassant[file]; }
+
+quint64 Zobrist::sideKey() { return keys().side; }
+
+quint64 Zobrist::hash(const Board& board) {
+    quint64 hash = 0;
+
+    for (int rank = 0; rank < 8; ++rank) {
+        for (int file = 0; file < 8; ++file) {
+            const Piece& piece = board.pieceAt(file, rank);
+            if (piece.isNone()) continue;
+
+            hash ^= pieceKey(static_cast<int>(piece.type()),
+                             piece.owner().isWhite() ? 0 : 1, file + 8 * rank);
+        }
+    }
+
+    if (board.hasShortCastlingRights(Player::white())) hash ^= castlingKey(0);
+    if (board.hasLongCastlingRights(Player::white())) hash ^= castlingKey(1);
+    if (board.hasShortCastlingRights(Player::black())) hash ^= castlingKey(2);
+    if (board.hasLongCastlingRights(Player::black())) hash ^= castlingKey(3);
+
+    // Board keeps the en passant square after every double push, it only
+    // tells positions apart if a pawn can actually capture there.
+    Player side = board.currentPlayer();
+    Coord2D<int> target = board.getBoardState().EnPassantCoords;
+    if (board.isLegalCoord(target)) {
+        int y = target.y + (side.isWhite() ? 1 : -1);
+        for (int x : {target.x - 1, target.x + 1}) {
+            if (!board.isLegalCoord(x, y)) continue;
+            const Piece& piece = board.pieceAt(x, y);
+            if (piece.isPawn() && piece.owner() == side) {
+                hash ^= enPassantKey(target.x);
+                break;
+            }
+        }
+    }
+
+    if (side.isBlack()) hash ^= sideKey();
+    return hash;
+}
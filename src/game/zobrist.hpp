@@ -0,0 +1,29 @@
+#ifndef ZOBRIST_HPP
+#define ZOBRIST_HPP
+#include <QtGlobal>
+
+class Board;
+/*! \brief 64-bit Zobrist hash of a position.
+ *
+ * Keys come from a generator with a fixed seed, so hashes are stable across
+ * runs and can be stored on disk. The hash covers piece placement, side to
+ * move, castling rights and the en passant file, but not the move counters.
+ * The en passant file counts only if a pawn can capture there, so
+ * transpositions ending with a double push hash the same. Files keyed by
+ * the hash carry a version to bump when it changes.
+ */
+class Zobrist {
+public:
+    Zobrist() = delete;
+
+    static quint64 hash(const Board& board);
+
+    /*! \brief Returns key of a piece, \a piece is Piece::Type, \a color is 0
+     * for white, \a square is file + 8 * rank index */
+    static quint64 pieceKey(int piece, int color, int square);
+    static quint64 castlingKey(int index);
+    static quint64 enPassantKey(int file);
+    static quint64 sideKey();
+};
+
+#endif  // ZOBRIST_HPP
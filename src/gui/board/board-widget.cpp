@@ -1,10 +1,13 @@
 #include "gui/board/board-widget.hpp"
 
+#include <QPaintEvent>
 #include <QPainter>
+#include <QScreen>
 #include <algorithm>
 
 #include "gui/board/board-widget-state.hpp"
 #include "game/piece-set.hpp"
+#include "util/profiler.hpp"
 
 static const int MinSize = 256;
 
@@ -15,11 +18,16 @@ BoardWidget::BoardWidget(QWidget* parent,
       m_boardState(new BoardWidgetState()),
       m_pieceSet(nullptr),
       m_gameState(nullptr),
-      m_flipped(false) {
+      m_flipped(false),
+      m_animatedMove(Move::NullMove) {
     setMinimumSize(MinSize, MinSize);
     setMouseTracking(true);
     ensureValidPieceSet();
 
+    m_animationTimer.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&m_animationTimer, &QTimer::timeout, this,
+                     &BoardWidget::onAnimationFrame);
+
     QObject::connect(&settings, &AbstractSettings::changed, this,
                      &BoardWidget::update);
 }
@@ -33,16 +41,52 @@ void BoardWidget::redraw() { repaint(); }
 
 void BoardWidget::emitMove(Move move) { emit moveMade(move); }
 
+void BoardWidget::animateMove(Move move) {
+    m_animationTimer.stop();
+    m_animatedMove = Move::NullMove;
+
+    if (move == Move::NullMove || m_gameState == nullptr) return;
+
+    int duration = m_settings.style().animationMs;
+    Piece piece = m_gameState->getBoard().pieceAt(move.to());
+    if (duration <= 0 || piece.isNone()) return;
+
+    m_animatedMove = move;
+    m_animatedPiece = piece;
+    m_animationRect = animationRect(0.0);
+    m_animationClock.start();
+
+    // Tick once per display refresh.
+    qreal refreshRate = screen() ? screen()->refreshRate() : 60.0;
+    m_animationTimer.start(std::max(1, int(1000.0 / refreshRate)));
+}
+
+void BoardWidget::onAnimationFrame() {
+    int duration = std::max(1, m_settings.style().animationMs);
+    double progress =
+        std::min(1.0, double(m_animationClock.elapsed()) / duration);
+    QRect rect = animationRect(progress);
+    QRect dirty = m_animationRect.united(rect);
+
+    m_animationRect = rect;
+    if (progress >= 1.0) {
+        m_animationTimer.stop();
+        m_animatedMove = Move::NullMove;
+    }
+    // Only the area covered by the sliding piece has to be repainted.
+    QWidget::update(dirty);
+}
+
 void BoardWidget::update() {
     m_width = width();
     m_height = height();
 
+    const BoardStyle& style = m_settings.style();
     int borderSize = 0;
 
-    if (m_settings.get("boolBorder").toBool())
-        borderSize = m_settings.get("intBorderSize").toInt();
+    if (style.hasBorder) borderSize = style.borderSize;
 
-    int margin = m_settings.get("intMarginSize").toInt();
+    int margin = style.marginSize;
     int totalMargin = borderSize + margin;
     m_fieldSize = (std::min(m_width, m_height) - 2. * totalMargin) / 8.0;
 
@@ -50,6 +94,7 @@ void BoardWidget::update() {
     double centeringY = 0.5 * (m_height - 2 * totalMargin - 8 * m_fieldSize);
     m_firstFieldX = totalMargin + centeringX;
     m_firstFieldY = totalMargin + centeringY;
+    ensureValidPieceSet();
     redraw();
 }
 
@@ -68,9 +113,10 @@ bool BoardWidget::isFieldAt(double x, double y, int* file, int* rank) const {
 
 void BoardWidget::resizeEvent(QResizeEvent*) { update(); }
 
-void BoardWidget::paintEvent(QPaintEvent*) {
+void BoardWidget::paintEvent(QPaintEvent* event) {
+    ProfileScope profile("BoardWidget::paintEvent");
     QPainter Painter(this);
-    draw(Painter);
+    draw(Painter, event->rect());
 }
 
 void BoardWidget::mousePressEvent(QMouseEvent* Event) {
@@ -92,7 +138,7 @@ void BoardWidget::mouseMoveEvent(QMouseEvent* Event) {
 }
 
 void BoardWidget::ensureValidPieceSet() {
-    QString currentName = m_settings.get("stringPieceStyle").toString();
+    const QString& currentName = m_settings.style().pieceStyle;
 
     if (m_pieceSet == nullptr || m_pieceSet->styleName() != currentName) {
         delete m_pieceSet;
@@ -100,30 +146,40 @@ void BoardWidget::ensureValidPieceSet() {
     }
 }
 
-void BoardWidget::draw(QPainter& context) {
+void BoardWidget::draw(QPainter& context, const QRect& exposed) {
     if (!isValid()) { return; }
-    drawBorder(context);
+    QRect squares(getFileOffset(0), getRankOffset(0), 8 * m_fieldSize,
+                  8 * m_fieldSize);
+
+    if (!squares.contains(exposed)) drawBorder(context);
     for (int rank = 0; rank < 8; rank++) {
         for (int file = 0; file < 8; file++) {
+            QRect field(getFileOffset(file), getRankOffset(rank), m_fieldSize,
+                        m_fieldSize);
+            if (!field.intersects(exposed)) continue;
+
             drawField(context, rank, file);
             drawPiece(context, rank, file);
         }
     }
     drawSelection(context);
     drawDraggedPiece(context);
+    drawAnimatedPiece(context);
 }
 
 void BoardWidget::drawBorder(QPainter& context) {
     static const char* Files[] = {"A", "B", "C", "D", "E", "F", "G", "H"};
     static const char* Ranks[] = {"1", "2", "3", "4", "5", "6", "7", "8"};
 
-    if (!m_settings.get("boolBorder").toBool()) return;
+    const BoardStyle& style = m_settings.style();
+
+    if (!style.hasBorder) return;
 
-    int size = m_settings.get("intBorderSize").toInt();
+    int size = style.borderSize;
 
     QPen Pen;
 
-    Pen.setColor(m_settings.get("colorBorder").value<QColor>());
+    Pen.setColor(style.border);
     Pen.setWidth(size);
     Pen.setJoinStyle(Qt::MiterJoin);
     context.setPen(Pen);
@@ -144,7 +200,7 @@ void BoardWidget::drawBorder(QPainter& context) {
     QBrush Brush = QBrush(Qt::white);
 
     context.setBrush(Brush);
-    context.setPen(m_settings.get("colorBorderText").value<QColor>());
+    context.setPen(style.borderText);
 
     for (int i = 0; i < 8; i++) {
         int j = absolute(i);
@@ -175,21 +231,32 @@ void BoardWidget::drawDraggedPiece(QPainter& context) {
     drawPiece(context, Dest, piece);
 }
 
-void BoardWidget::drawField(QPainter& context, int rank, int file) {
-    QBrush Brush;
+void BoardWidget::drawAnimatedPiece(QPainter& context) {
+    if (m_animatedMove == Move::NullMove) return;
+
+    drawPiece(context, m_animationRect, m_animatedPiece);
+}
+
+QRect BoardWidget::animationRect(double progress) const {
+    int fromX = getFileOffset(absolute(m_animatedMove.from().x));
+    int fromY = getRankOffset(absolute(m_animatedMove.from().y));
+    int toX = getFileOffset(absolute(m_animatedMove.to().x));
+    int toY = getRankOffset(absolute(m_animatedMove.to().y));
 
-    if ((rank + file) % 2 == 0)
-        Brush = QBrush(m_settings.get("colorSquareLight").value<QColor>());
-    else
-        Brush = QBrush(m_settings.get("colorSquareDark").value<QColor>());
+    return QRect(fromX + progress * (toX - fromX),
+                 fromY + progress * (toY - fromY), m_fieldSize, m_fieldSize);
+}
+
+void BoardWidget::drawField(QPainter& context, int rank, int file) {
+    const BoardStyle& style = m_settings.style();
+    const QColor& color =
+        (rank + file) % 2 == 0 ? style.squareLight : style.squareDark;
 
     context.fillRect(getFileOffset(file), getRankOffset(rank), m_fieldSize,
-                     m_fieldSize, Brush);
+                     m_fieldSize, color);
 }
 
 void BoardWidget::drawPiece(QPainter& context, QRectF dest, Piece piece) {
-    ensureValidPieceSet();
-
     const QRectF source(0, 0, m_fieldSize, m_fieldSize);
     context.drawPixmap(dest, m_pieceSet->getPiecePixmap(piece, m_fieldSize),
                        source);
@@ -202,6 +269,10 @@ void BoardWidget::drawPiece(QPainter& context, int rank, int file) {
 
     if (Piece.isNone() || m_boardState->m_draggedField == Coord2D<int>(x, y))
         return;
+    // Sliding piece is drawn separately.
+    if (m_animatedMove != Move::NullMove &&
+        m_animatedMove.to() == Coord2D<int>(x, y))
+        return;
 
     QRectF Dest(getFileOffset(file), getRankOffset(rank), m_fieldSize,
                 m_fieldSize);
@@ -215,7 +286,7 @@ void BoardWidget::drawSelection(QPainter& context) {
     int size = 2 * int(double(std::min(m_width, m_height)) / MinSize);
     QBrush Brush = QBrush(QColor(0, 0, 0, 0));
     QPen Pen;
-    Pen.setColor(m_settings.get("colorPicking").value<QColor>());
+    Pen.setColor(m_settings.style().picking);
     Pen.setWidth(size);
     Pen.setJoinStyle(Qt::MiterJoin);
 
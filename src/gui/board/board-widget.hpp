@@ -1,6 +1,8 @@
 #ifndef BOARDWIDGET_HPP
 #define BOARDWIDGET_HPP
 
+#include <QElapsedTimer>
+#include <QTimer>
 #include <QWidget>
 
 #include "game/state.hpp"
@@ -27,6 +29,9 @@ public:
     bool isFieldAt(double x, double y, int* file, int* rank) const;
     const State& getGameState() const { return *m_gameState; }
     void setGameState(const State* pState) { m_gameState = pState; }
+    /* Slides the piece that has just made the move in the game state, null
+       move stops the running animation */
+    void animateMove(Move move);
 
 protected:
     virtual void resizeEvent(QResizeEvent*) override;
@@ -49,14 +54,20 @@ private:
     }
     /* Ensures valid piece set */
     void ensureValidPieceSet();
-    /* Draws board contents */
-    void draw(QPainter& ctx);
+    /* Draws board contents intersecting exposed rectangle */
+    void draw(QPainter& ctx, const QRect& exposed);
     /* Draws piece at x,y in the canvas using SVG renderer */
     void drawPiece(QPainter& ctx, QRectF dest, Piece piece);
     /* Draws piece at given (rank, file) */
     void drawPiece(QPainter& ctx, int rank, int file);
     /* Draws floating / dragging piece if any */
     void drawDraggedPiece(QPainter& ctx);
+    /* Draws sliding piece if any */
+    void drawAnimatedPiece(QPainter& ctx);
+    /* Returns sliding piece rectangle at given progress of animation */
+    QRect animationRect(double progress) const;
+    /* Advances animation by one frame */
+    void onAnimationFrame();
     /* Draws single square at (rank, file) of the chessboard */
     void drawField(QPainter& ctx, int rank, int file);
     /* Draws selection border */
@@ -83,6 +94,12 @@ private:
     /* Beginning of the chessboard squares */
     int m_firstFieldX;
     int m_firstFieldY;
+    /* Animation properties, animated move is null when nothing slides */
+    Move m_animatedMove;
+    Piece m_animatedPiece;
+    QRect m_animationRect;
+    QElapsedTimer m_animationClock;
+    QTimer m_animationTimer;
 };
 
 #endif  // BOARDWIDGET_HPP
@@ -0,0 +1,167 @@
+#include "gui/board/thumbnail-grid-widget.hpp"
+
+#include <QPaintEvent>
+#include <QPainter>
+#include <algorithm>
+
+#include "game/piece-set.hpp"
+#include "util/profiler.hpp"
+
+static const int MinFieldSize = 4;
+static const int CellSpacing = 6;
+
+PositionSnapshot::PositionSnapshot() { m_squares.fill(0); }
+
+PositionSnapshot PositionSnapshot::fromBoard(const Board& board) {
+    PositionSnapshot snapshot;
+
+    for (int rank = 0; rank < 8; rank++) {
+        for (int file = 0; file < 8; file++) {
+            const Piece& piece = board.pieceAt(file, rank);
+            if (piece.isNone()) continue;
+
+            quint8 code = int(piece.type()) + 1;
+            if (piece.owner().isBlack()) code |= 8;
+            snapshot.m_squares[rank * 8 + file] = code;
+        }
+    }
+    return snapshot;
+}
+
+Piece PositionSnapshot::pieceAt(int file, int rank) const {
+    quint8 code = m_squares[rank * 8 + file];
+    if (code == 0) return Piece();
+
+    return Piece(Piece::Type((code & 7) - 1),
+                 (code & 8) ? Player::black() : Player::white());
+}
+
+ThumbnailGridWidget::ThumbnailGridWidget(QWidget* parent,
+                                         BoardSettings& settings)
+    : QWidget(parent),
+      m_settings(settings),
+      m_pieceSet(new PieceSet(settings.style().pieceStyle)),
+      m_columns(1),
+      m_fieldSize(MinFieldSize),
+      m_captionHeight(fontMetrics().height()) {
+    // Every board covers its own cell, there is nothing behind them to erase.
+    setAttribute(Qt::WA_OpaquePaintEvent);
+
+    QObject::connect(&settings, &AbstractSettings::changed, this,
+                     &ThumbnailGridWidget::onSettingsChanged);
+}
+
+ThumbnailGridWidget::~ThumbnailGridWidget() { delete m_pieceSet; }
+
+void ThumbnailGridWidget::setBoardCount(int count) {
+    m_boards.resize(count);
+    relayout();
+}
+
+void ThumbnailGridWidget::setPosition(int index,
+                                      const PositionSnapshot& position) {
+    Q_ASSERT(index >= 0 && index < m_boards.size());
+
+    if (m_boards[index].position == position) return;
+    m_boards[index].position = position;
+    update(cellRect(index));
+}
+
+void ThumbnailGridWidget::setPosition(int index, const Board& board) {
+    setPosition(index, PositionSnapshot::fromBoard(board));
+}
+
+void ThumbnailGridWidget::setTitle(int index, const QString& title) {
+    Q_ASSERT(index >= 0 && index < m_boards.size());
+
+    if (m_boards[index].title == title) return;
+    m_boards[index].title = title;
+    update(cellRect(index));
+}
+
+void ThumbnailGridWidget::resizeEvent(QResizeEvent*) { relayout(); }
+
+void ThumbnailGridWidget::paintEvent(QPaintEvent* event) {
+    ProfileScope profile("ThumbnailGridWidget::paintEvent");
+    QPainter painter(this);
+
+    painter.fillRect(event->rect(), palette().window());
+    for (int i = 0; i < m_boards.size(); i++)
+        if (cellRect(i).intersects(event->rect())) drawBoard(painter, i);
+}
+
+void ThumbnailGridWidget::onSettingsChanged() {
+    if (m_pieceSet->styleName() != m_settings.style().pieceStyle) {
+        delete m_pieceSet;
+        m_pieceSet = new PieceSet(m_settings.style().pieceStyle);
+    }
+    relayout();
+}
+
+void ThumbnailGridWidget::relayout() {
+    int count = std::max(1, int(m_boards.size()));
+
+    // Pick the number of columns giving the biggest boards.
+    m_columns = 1;
+    m_fieldSize = 0;
+    for (int columns = 1; columns <= count; columns++) {
+        int rows = (count + columns - 1) / columns;
+        int cellWidth = width() / columns - CellSpacing;
+        int cellHeight = height() / rows - CellSpacing - m_captionHeight;
+        int fieldSize = std::min(cellWidth, cellHeight) / 8;
+
+        if (fieldSize > m_fieldSize) {
+            m_fieldSize = fieldSize;
+            m_columns = columns;
+        }
+    }
+    m_fieldSize = std::max(m_fieldSize, MinFieldSize);
+
+    const BoardStyle& style = m_settings.style();
+    m_background = QPixmap(8 * m_fieldSize, 8 * m_fieldSize);
+    QPainter painter(&m_background);
+    for (int rank = 0; rank < 8; rank++)
+        for (int file = 0; file < 8; file++)
+            painter.fillRect(
+                file * m_fieldSize, rank * m_fieldSize, m_fieldSize,
+                m_fieldSize,
+                (rank + file) % 2 == 0 ? style.squareLight : style.squareDark);
+
+    setMinimumHeight(((count + m_columns - 1) / m_columns) *
+                     (8 * MinFieldSize + m_captionHeight + CellSpacing));
+    update();
+}
+
+QRect ThumbnailGridWidget::cellRect(int index) const {
+    int boardSize = 8 * m_fieldSize;
+    int column = index % m_columns;
+    int row = index / m_columns;
+
+    return QRect(column * (boardSize + CellSpacing),
+                 row * (boardSize + m_captionHeight + CellSpacing), boardSize,
+                 boardSize + m_captionHeight);
+}
+
+void ThumbnailGridWidget::drawBoard(QPainter& context, int index) {
+    const Thumbnail& thumbnail = m_boards[index];
+    QRect cell = cellRect(index);
+    QRect caption(cell.x(), cell.y(), cell.width(), m_captionHeight);
+    QPoint origin(cell.x(), cell.y() + m_captionHeight);
+
+    context.setPen(palette().color(QPalette::WindowText));
+    context.drawText(caption, Qt::AlignLeft | Qt::AlignVCenter,
+                     context.fontMetrics().elidedText(
+                         thumbnail.title, Qt::ElideRight, caption.width()));
+    context.drawPixmap(origin, m_background);
+
+    for (int rank = 0; rank < 8; rank++) {
+        for (int file = 0; file < 8; file++) {
+            Piece piece = thumbnail.position.pieceAt(file, rank);
+            if (piece.isNone()) continue;
+
+            context.drawPixmap(origin.x() + file * m_fieldSize,
+                               origin.y() + rank * m_fieldSize,
+                               m_pieceSet->getPiecePixmap(piece, m_fieldSize));
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef THUMBNAIL_GRID_WIDGET_HPP
+#define THUMBNAIL_GRID_WIDGET_HPP
+#include <QPixmap>
+#include <QVector>
+#include <QWidget>
+#include <array>
+
+#include "game/board.hpp"
+#include "settings/settings-factory.hpp"
+
+class PieceSet;
+
+/* Compact, comparable copy of piece placement. */
+class PositionSnapshot {
+public:
+    PositionSnapshot();
+
+    static PositionSnapshot fromBoard(const Board& board);
+
+    /* Returns piece at given (file, rank) */
+    Piece pieceAt(int file, int rank) const;
+
+    bool operator==(const PositionSnapshot& rhs) const {
+        return m_squares == rhs.m_squares;
+    }
+    bool operator!=(const PositionSnapshot& rhs) const {
+        return !(*this == rhs);
+    }
+
+private:
+    /* Piece type + 1 in the low bits, 8 set for black pieces, 0 is empty */
+    std::array<quint8, 64> m_squares;
+};
+
+/* Grid of small read-only boards, used to monitor many games at once.
+   All boards share a single piece set and a prerendered board background,
+   and only the boards whose position has changed are repainted. */
+class ThumbnailGridWidget : public QWidget {
+    Q_OBJECT
+public:
+    explicit ThumbnailGridWidget(
+        QWidget* parent = nullptr,
+        BoardSettings& settings = SettingsFactory::board());
+    ~ThumbnailGridWidget();
+
+    /* Sets number of displayed boards */
+    void setBoardCount(int count);
+    int boardCount() const { return m_boards.size(); }
+
+    /* Sets position of a board, repaints it only if it has changed */
+    void setPosition(int index, const PositionSnapshot& position);
+    void setPosition(int index, const Board& board);
+
+    /* Sets caption displayed above a board */
+    void setTitle(int index, const QString& title);
+
+protected:
+    virtual void resizeEvent(QResizeEvent*) override;
+    virtual void paintEvent(QPaintEvent*) override;
+private slots:
+    /* Handles settings change */
+    void onSettingsChanged();
+
+private:
+    struct Thumbnail {
+        PositionSnapshot position;
+        QString title;
+    };
+
+    /* Recomputes grid geometry and the cached background */
+    void relayout();
+    /* Returns rectangle of the whole cell, caption included */
+    QRect cellRect(int index) const;
+    /* Draws single board */
+    void drawBoard(QPainter& ctx, int index);
+
+    BoardSettings& m_settings;
+    PieceSet* m_pieceSet;
+    QVector<Thumbnail> m_boards;
+    /* Prerendered empty chessboard of the current field size */
+    QPixmap m_background;
+    /* Geometry properties */
+    int m_columns;
+    int m_fieldSize;
+    int m_captionHeight;
+};
+
+#endif  // THUMBNAIL_GRID_WIDGET_HPP
@@ -0,0 +1,104 @@
+#include "gui/build-progress-widget.hpp"
+
+#include <QCoreApplication>
+#include <QHBoxLayout>
+
+static const int PollIntervalMs = 100;
+/*!< Steps of the progress bar */
+static const int BarMaximum = 1000;
+
+BuildProgressWidget::BuildProgressWidget(QWidget* parent)
+    : QWidget(parent),
+      m_label(new QLabel()),
+      m_bar(new QProgressBar()),
+      m_cancelButton(new QPushButton("Cancel")),
+      m_thread(nullptr),
+      m_built(false) {
+    auto* layout = new QHBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(m_label);
+    layout->addWidget(m_bar, 1);
+    layout->addWidget(m_cancelButton);
+
+    QObject::connect(m_cancelButton, &QPushButton::clicked, this,
+                     &BuildProgressWidget::onCancelClicked);
+    QObject::connect(&m_pollTimer, &QTimer::timeout, this,
+                     &BuildProgressWidget::onPoll);
+    hide();
+}
+
+BuildProgressWidget::~BuildProgressWidget() { abort(); }
+
+void BuildProgressWidget::start(const QString& label, Build build) {
+    abort();
+
+    m_progress.done = 0;
+    m_progress.total = 0;
+    m_progress.canceled = false;
+    m_built = false;
+    m_description = label;
+
+    m_label->setText(label);
+    // Busy indicator until the build knows its total.
+    m_bar->setRange(0, 0);
+    m_bar->show();
+    m_cancelButton->setEnabled(true);
+    m_cancelButton->show();
+    show();
+
+    m_thread = QThread::create(
+        [this, build]() { m_built = build(m_progress); });
+    QObject::connect(m_thread, &QThread::finished, this,
+                     &BuildProgressWidget::onThreadFinished);
+    m_thread->start();
+    m_pollTimer.start(PollIntervalMs);
+}
+
+void BuildProgressWidget::abort() {
+    if (!m_thread) return;
+
+    m_pollTimer.stop();
+    m_progress.canceled = true;
+    m_thread->disconnect(this);
+    m_thread->wait();
+    // Finished signal may be queued already.
+    QCoreApplication::removePostedEvents(this, QEvent::MetaCall);
+    delete m_thread;
+    m_thread = nullptr;
+    hide();
+}
+
+void BuildProgressWidget::onCancelClicked() {
+    m_progress.canceled = true;
+    m_cancelButton->setEnabled(false);
+    m_label->setText(tr("%1, canceling...").arg(m_description));
+}
+
+void BuildProgressWidget::onPoll() {
+    qint64 total = m_progress.total;
+    if (total <= 0) return;
+
+    m_bar->setRange(0, BarMaximum);
+    m_bar->setValue(int(qMin(m_progress.done.load(), total) * BarMaximum /
+                        total));
+}
+
+void BuildProgressWidget::onThreadFinished() {
+    m_pollTimer.stop();
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+
+    bool built = m_built && !m_progress.canceled;
+    if (built) {
+        hide();
+    } else {
+        // Failure stays in sight, the data is missing until next open.
+        m_bar->hide();
+        m_cancelButton->hide();
+        m_label->setText(m_progress.canceled
+                             ? tr("%1 canceled.").arg(m_description)
+                             : tr("%1 failed.").arg(m_description));
+    }
+    emit finished(built);
+}
@@ -0,0 +1,56 @@
+#ifndef BUILD_PROGRESS_WIDGET_HPP
+#define BUILD_PROGRESS_WIDGET_HPP
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QThread>
+#include <QTimer>
+#include <QWidget>
+#include <functional>
+
+#include "database/build-progress.hpp"
+
+/*! \brief Runs an index build on a worker thread, showing its progress
+ * with a cancel button.
+ *
+ * The widget is visible while the build runs and when it failed.
+ */
+class BuildProgressWidget : public QWidget {
+    Q_OBJECT
+public:
+    /*! \brief Build to run, \returns false if it failed */
+    typedef std::function<bool(BuildProgress&)> Build;
+
+    explicit BuildProgressWidget(QWidget* parent = nullptr);
+    ~BuildProgressWidget();
+
+    /*! \brief Starts \a build described by \a label, a running build is
+     * aborted first */
+    void start(const QString& label, Build build);
+
+    /*! \brief Cancels running build and waits for it, finished() is not
+     * emitted. Owners call it before data the build reads goes away. */
+    void abort();
+    bool isRunning() const { return m_thread != nullptr; }
+signals:
+    /*! \brief Emitted once the build ends, \a built is false if it failed
+     * or was canceled */
+    void finished(bool built);
+private slots:
+    void onCancelClicked();
+    void onPoll();
+    void onThreadFinished();
+
+private:
+    QLabel* m_label;
+    QProgressBar* m_bar;
+    QPushButton* m_cancelButton;
+    QTimer m_pollTimer;
+    QThread* m_thread;
+    QString m_description;
+    BuildProgress m_progress;
+    /*!< Result of the build, written by the worker before it finishes */
+    bool m_built;
+};
+
+#endif  // BUILD_PROGRESS_WIDGET_HPP
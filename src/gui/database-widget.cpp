@@ -0,0 +1,121 @@
+#include "gui/database-widget.hpp"
+
+#include <QHeaderView>
+#include <QTabWidget>
+#include <QThread>
+#include <QVBoxLayout>
+
+#include "game/zobrist.hpp"
+#include "gui/build-progress-widget.hpp"
+#include "gui/explorer-widget.hpp"
+
+// Decoding tags of every listed game is the slow part of a lookup.
+static const int MaxListedGames = 1000;
+
+static const char* const Columns[] = {"White", "Black", "Result", "Date",
+                                      "Event"};
+
+DatabaseWidget::DatabaseWidget(QWidget* parent)
+    : QWidget(parent),
+      m_explorer(new ExplorerWidget()),
+      m_indexBuild(new BuildProgressWidget()),
+      m_summary(new QLabel()),
+      m_table(new QTableWidget()) {
+    m_table->setColumnCount(5);
+    m_table->setHorizontalHeaderLabels(
+        {Columns[0], Columns[1], Columns[2], Columns[3], Columns[4]});
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+
+    auto* games = new QWidget();
+    auto* gamesLayout = new QVBoxLayout(games);
+    gamesLayout->addWidget(m_indexBuild);
+    gamesLayout->addWidget(m_summary);
+    gamesLayout->addWidget(m_table);
+
+    auto* tabs = new QTabWidget(this);
+    tabs->addTab(m_explorer, "Explorer");
+    tabs->addTab(games, "Games");
+    auto* layout = new QVBoxLayout(this);
+    layout->addWidget(tabs);
+
+    QObject::connect(m_table, &QTableWidget::cellDoubleClicked, this,
+                     &DatabaseWidget::onCellDoubleClicked);
+    QObject::connect(m_explorer, &ExplorerWidget::moveSelected, this,
+                     &DatabaseWidget::moveSelected);
+    QObject::connect(m_indexBuild, &BuildProgressWidget::finished, this,
+                     &DatabaseWidget::onIndexBuilt);
+}
+
+// Builds read the database, which goes away before the child widgets.
+DatabaseWidget::~DatabaseWidget() {
+    m_explorer->abortBuild();
+    m_indexBuild->abort();
+}
+
+QSize DatabaseWidget::sizeHint() const { return QSize(500, 250); }
+
+bool DatabaseWidget::open(const QString& path) {
+    m_explorer->abortBuild();
+    m_indexBuild->abort();
+    m_positions.close();
+    if (!m_database.open(path)) return false;
+    if (!m_explorer->open(m_database, path)) return false;
+    m_path = path;
+    if (m_positions.open(path) &&
+        m_positions.indexedGames() == m_database.gameCount())
+        return true;
+
+    // Indexing is a one-off cost per database.
+    m_positions.close();
+    m_summary->clear();
+    const GameDatabase& database = m_database;
+    m_indexBuild->start(tr("Indexing positions"),
+                        [&database, path](BuildProgress& progress) {
+                            return PositionIndex::build(
+                                database, path, QThread::idealThreadCount(),
+                                &progress);
+                        });
+    return true;
+}
+
+void DatabaseWidget::setBoard(const Board& board) {
+    m_board = board;
+    m_explorer->setBoard(board);
+    if (!m_positions.isOpen()) return;
+
+    quint64 hash = Zobrist::hash(board);
+    qint64 total = m_positions.gameCount(hash);
+    m_games = m_positions.games(hash, MaxListedGames);
+    m_summary->setText(
+        total > m_games.size()
+            ? tr("%1 games, first %2 shown").arg(total).arg(m_games.size())
+            : tr("%1 games").arg(total));
+
+    m_table->setRowCount(m_games.size());
+    for (int row = 0; row < m_games.size(); row++) {
+        QList<QPair<QString, QString>> tags = m_database.tags(m_games[row]);
+        for (int column = 0; column < m_table->columnCount(); column++) {
+            QString value;
+            for (const auto& tag : tags)
+                if (tag.first == QLatin1String(Columns[column]))
+                    value = tag.second;
+
+            QTableWidgetItem* item = m_table->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                m_table->setItem(row, column, item);
+            }
+            item->setText(value);
+        }
+    }
+}
+
+void DatabaseWidget::onCellDoubleClicked(int row, int) {
+    if (row >= 0 && row < m_games.size()) emit gameSelected(m_games[row]);
+}
+
+void DatabaseWidget::onIndexBuilt(bool built) {
+    if (built && m_positions.open(m_path)) setBoard(m_board);
+}
@@ -0,0 +1,60 @@
+#ifndef DATABASE_WIDGET_HPP
+#define DATABASE_WIDGET_HPP
+#include <QLabel>
+#include <QTableWidget>
+#include <QVector>
+#include <QWidget>
+
+#include "database/game-database.hpp"
+#include "database/position-index.hpp"
+#include "game/board.hpp"
+
+class BuildProgressWidget;
+class ExplorerWidget;
+/*! \brief Panel with the opening explorer of a database and the list of
+ * its games that reach the board position.
+ */
+class DatabaseWidget : public QWidget {
+    Q_OBJECT
+public:
+    explicit DatabaseWidget(QWidget* parent = nullptr);
+    ~DatabaseWidget();
+
+    /*! \brief Opens database at \a path, building its position index and
+     * explorer when they are missing or older than the database.
+     *
+     * Missing index is built in the background, games are listed once it
+     * is ready.
+     * \returns false if the database cannot be opened
+     */
+    bool open(const QString& path);
+    const GameDatabase& database() const { return m_database; }
+
+    virtual QSize sizeHint() const;
+public slots:
+    /*! \brief Shows moves played in \a board and games reaching it */
+    void setBoard(const Board& board);
+signals:
+    /*! \brief Emitted when a game is double-clicked */
+    void gameSelected(qint64 index);
+    /*! \brief Emitted when a move of the explorer is double-clicked */
+    void moveSelected(Move move);
+private slots:
+    void onCellDoubleClicked(int row, int column);
+    void onIndexBuilt(bool built);
+
+private:
+    GameDatabase m_database;
+    QString m_path;
+    PositionIndex m_positions;
+    /*!< Board shown, listed again once the index is built */
+    Board m_board;
+    ExplorerWidget* m_explorer;
+    BuildProgressWidget* m_indexBuild;
+    QLabel* m_summary;
+    QTableWidget* m_table;
+    /*!< Game ids of the table rows */
+    QVector<quint32> m_games;
+};
+
+#endif  // DATABASE_WIDGET_HPP
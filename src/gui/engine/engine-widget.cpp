@@ -1,32 +1,61 @@
 #include "gui/engine/engine-widget.hpp"
 
 #include <QDebug>
+#include <algorithm>
 
+#include "book/polyglot-book.hpp"
+#include "engine/analysis-cache.hpp"
+#include "game/zobrist.hpp"
 #include "settings/settings-factory.hpp"
+#include "tablebase/tablebase.hpp"
 #include "ui_engine-widget.h"
 #include "util/html-move-tree-builder.hpp"
+#include "util/profiler.hpp"
 #include "util/stringify.hpp"
 
+// Lines beyond it are not worth a row, the analysis cache keeps as many.
+static const int MaxVariants = 255;
+
 EngineWidget::EngineWidget(EnginePtr pEngine, const QString& engineName,
                            QWidget* parent)
     : m_engineName(engineName),
       QWidget(parent),
       ui(new Ui::EngineWidget),
-      m_engine(std::move(pEngine)) {
+      m_engine(std::move(pEngine)),
+      m_engineKey(0),
+      m_positionKey(Zobrist::hash(m_currentBoard)),
+      m_maxVariants(1) {
     ui->setupUi(this);
+    if (m_engine) {
+        EngineConfig config = m_engine->config();
+        m_engineKey = AnalysisCache::engineKey(config);
+        // Engines report a single line unless configured otherwise.
+        for (const QString& option : config.options())
+            if (option.compare("MultiPV", Qt::CaseInsensitive) == 0)
+                m_maxVariants =
+                    qBound(1, config.option(option).toInt(), MaxVariants);
+    }
+
+    m_redrawTimer.setSingleShot(true);
 
     QObject::connect(ui->analyzeButton, &QPushButton::clicked, this,
                      &EngineWidget::onAnalyzeClicked);
     QObject::connect(ui->stopButton, &QPushButton::clicked, this,
                      &EngineWidget::onStopClicked);
+    QObject::connect(&m_redrawTimer, &QTimer::timeout, this,
+                     &EngineWidget::redraw);
 
     QObject::connect(m_engine.get(), &Engine::variantParsed, this,
                      &EngineWidget::onVariantParsed);
+    QObject::connect(m_engine.get(), &Engine::failed, this,
+                     &EngineWidget::onEngineFailed);
 
     // Update name of the selected engine;
     ui->name->setText(m_engineName);
     ui->name->repaint();
     reset();
+    showBookMoves();
+    showTablebase();
 }
 
 EngineWidget::~EngineWidget() { delete ui; }
@@ -36,86 +65,44 @@ QSize EngineWidget::sizeHint() const { return QSize(10, 10); }
 void EngineWidget::setBoard(const Board& board) {
     if (!m_engine) {
         m_currentBoard = board;
+        showBookMoves();
+        showTablebase();
         return;
     }
 
-    bool isAnalysing = m_engine->isAnalysing();
-
-    if (isAnalysing) m_engine->stopAnalysis();
-    m_variants.clear();
+    clearVariants();
     m_currentBoard = board;
+    m_positionKey = Zobrist::hash(board);
+    showCachedVariants();
+    showBookMoves();
+    showTablebase();
 
-    if (isAnalysing) {
-        m_variants.clear();
-        m_engine->startAnalysis(m_currentBoard);
-    }
+    // Engine restarts the search on its own once the old one is stopped.
+    if (m_engine->isAnalysing()) m_engine->startAnalysis(m_currentBoard);
 }
 
 void EngineWidget::redraw() {
-    static const QString outputFmt = "<table><th></th><th></th>%1</table>";
-    static const QString evalFmt =
-        "<td style='font-size: %3px'><strong>(%1%2)</strong></td>";
-    static const QString movesFmt = "<td>%1</td>";
-    static const QString lineFmt = "<tr>%1%2</tr>";
+    ProfileScope profile("EngineWidget::redraw");
     static const QString statusFmt = "<b>Depth: %1 (%2 kn/s)</b>";
     QString lines;
+    bool changed = false;
 
-    HtmlSettings& settings = SettingsFactory::html();
+    for (int i = 0; i < m_variants.size(); i++) {
+        const VariantInfo& info = m_variants[i];
+        RenderedVariant& rendered = m_rendered[i];
 
-    for (const VariantInfo& info : m_variants) {
-        double kiloNodes = info.nps() / 1000.0;
-        QString status = statusFmt.arg(QString::number(info.depth()),
-                                       QString::number(kiloNodes));
-        HtmlMoveTreeBuilder builder;
-        Board board = m_currentBoard;
-        QString score;
-
-        ui->status->setText(status);
-
-        if (info.mate()) {
-            score = evalFmt.arg("#", QString::number(info.mate()));
-        } else {
-            const auto defaultScoreFontSizePx = 16;
-
-            int whiteCp =
-                board.currentPlayer().isBlack() ? -info.score() : info.score();
-            score = evalFmt.arg(
-                whiteCp > 0 ? "+" : "",
-                QString::number(whiteCp / 100.0, 'f', 2),
-                QString::number(defaultScoreFontSizePx *
-                                settings.get("fontScaling").value<double>()));
+        if (rendered.dirty) {
+            double kiloNodes = info.nps() / 1000.0;
+            ui->status->setText(statusFmt.arg(QString::number(info.depth()),
+                                              QString::number(kiloNodes)));
+            rendered.html = renderVariant(rendered, info);
+            rendered.dirty = false;
+            changed = true;
         }
-
-        if (board.currentPlayer().isBlack())
-            builder.addMoveNumber(QString::number(board.fullMoveCount()) +
-                                  "... ");
-
-        for (int i = 0; i < info.moveList().size(); i++) {
-            const QString& moveString = info.moveList()[i];
-            Move move = Stringify::longAlgebraicNotationToMove(moveString);
-
-            if (board.currentPlayer().isWhite())
-                builder.addMoveNumber(QString::number(board.fullMoveCount()) +
-                                      ". ");
-
-            QString algebraicMove =
-                Stringify::algebraicNotationString(board, move);
-            if (i == info.moveList().size() - 1 && info.mate()) {
-                algebraicMove.chop(1);
-                algebraicMove.append('#');
-            }
-            builder.addMove(algebraicMove);
-
-            if (!board.makeMove(move)) {
-                qDebug() << "BUG: " << board.toFen() << "move: " << moveString;
-                Q_ASSERT(!"Invalid move");
-            }
-        }
-        lines.append(outputFmt.arg(
-            lineFmt.arg(score, movesFmt.arg(builder.htmlWithStyle()))));
+        lines.append(rendered.html);
     }
 
-    ui->engineOutput->setHtml(lines);
+    if (changed) ui->engineOutput->setHtml(lines);
 }
 
 void EngineWidget::reset() {
@@ -128,17 +115,208 @@ void EngineWidget::reset() {
     }
 }
 
+void EngineWidget::clearVariants() {
+    m_redrawTimer.stop();
+    m_variants.clear();
+    m_rendered.clear();
+}
+
+void EngineWidget::showCachedVariants() {
+    for (VariantInfo info :
+         AnalysisCache::instance().lookup(m_positionKey, m_engineKey)) {
+        // Cut the line at the first move that does not fit the position,
+        // which would be a hash collision or a damaged entry.
+        Board board = m_currentBoard;
+        int legal = 0;
+        while (legal < info.pv().size() && board.makeMove(info.pv()[legal]))
+            ++legal;
+        if (legal == 0) continue;
+
+        info.pv().resize(legal);
+        setVariant(info);
+    }
+    if (!m_variants.isEmpty()) scheduleRedraw();
+}
+
+void EngineWidget::showBookMoves() {
+    QVector<PolyglotBook::Entry> entries =
+        PolyglotBook::instance().entries(m_currentBoard);
+    quint32 total = 0;
+    for (const PolyglotBook::Entry& entry : entries) total += entry.weight;
+
+    QStringList moves;
+    for (const PolyglotBook::Entry& entry : entries) {
+        QString san =
+            Stringify::algebraicNotationString(m_currentBoard, entry.move);
+        moves.append(total ? QString("%1 (%2%)").arg(san).arg(
+                                 entry.weight * 100 / total)
+                           : san);
+    }
+    ui->book->setText(moves.isEmpty() ? QString()
+                                      : "Book: " + moves.join(", "));
+}
+
+void EngineWidget::showTablebase() {
+    const Tablebase& tablebase = Tablebase::instance();
+    Move move;
+    Tablebase::Wdl wdl;
+    int dtz;
+    if (!tablebase.canProbe(m_currentBoard) ||
+        !tablebase.probeRoot(m_currentBoard, move, wdl, dtz)) {
+        ui->tablebase->setText(QString());
+        return;
+    }
+
+    QString mover = m_currentBoard.currentPlayer().isWhite() ? "White"
+                                                            : "Black";
+    QString other = m_currentBoard.currentPlayer().isWhite() ? "Black"
+                                                            : "White";
+    QString result;
+    switch (wdl) {
+    case Tablebase::Win:
+        result = mover + " wins";
+        break;
+    case Tablebase::CursedWin:
+        result = mover + " wins, drawn by the fifty-move rule";
+        break;
+    case Tablebase::Draw:
+        result = "Draw";
+        break;
+    case Tablebase::BlessedLoss:
+        result = other + " wins, drawn by the fifty-move rule";
+        break;
+    case Tablebase::Loss:
+        result = other + " wins";
+        break;
+    }
+    if (dtz != 0) result += QString(", DTZ %1").arg(qAbs(dtz));
+    if (move != Move::NullMove)
+        result += ", " + Stringify::algebraicNotationString(m_currentBoard,
+                                                            move);
+    ui->tablebase->setText("Tablebase: " + result);
+}
+
+void EngineWidget::setVariant(const VariantInfo& info) {
+    if (info.id() < 1 || info.id() > m_maxVariants) return;
+
+    // Lines of other multipv ids are kept so that their caches survive.
+    if (m_variants.size() < info.id()) {
+        m_variants.resize(info.id());
+        m_rendered.resize(info.id());
+    }
+
+    // Cached line stays until the engine gets as deep.
+    VariantInfo& current = m_variants[info.id() - 1];
+    if (!current.pv().isEmpty() && current.depth() > info.depth()) return;
+
+    current = info;
+    m_rendered[info.id() - 1].dirty = true;
+}
+
+void EngineWidget::scheduleRedraw() {
+    if (m_redrawTimer.isActive()) return;
+
+    EnginesSettings& settings = SettingsFactory::engines();
+    int frameRate = std::max(1, settings.get("intOutputFrameRate").toInt());
+    m_redrawTimer.start(1000 / frameRate);
+}
+
+void EngineWidget::updateSan(RenderedVariant& rendered,
+                             const VariantInfo& info) {
+    const QVector<Move>& moves = info.pv();
+
+    // Moves shared with the previous line do not need to be converted again.
+    int common = 0;
+    while (common < moves.size() && common < rendered.moves.size() &&
+           moves[common] == rendered.moves[common])
+        ++common;
+
+    rendered.moves = moves;
+    rendered.san.resize(common);
+    rendered.boards.resize(common + 1);
+    if (common == 0) rendered.boards[0] = m_currentBoard;
+
+    for (int i = common; i < moves.size(); i++) {
+        Board board = rendered.boards[i];
+        const Move& move = moves[i];
+
+        rendered.san.append(Stringify::algebraicNotationString(board, move));
+
+        if (!board.makeMove(move)) {
+            qDebug() << "BUG: " << board.toFen() << "move: "
+                     << Stringify::longAlgebraicNotationString(move);
+            Q_ASSERT(!"Invalid move");
+        }
+        rendered.boards.append(board);
+    }
+}
+
+QString EngineWidget::renderVariant(RenderedVariant& rendered,
+                                    const VariantInfo& info) {
+    static const QString outputFmt = "<table><th></th><th></th>%1</table>";
+    static const QString evalFmt =
+        "<td style='font-size: %3px'><strong>(%1%2)</strong></td>";
+    static const QString movesFmt = "<td>%1</td>";
+    static const QString lineFmt = "<tr>%1%2</tr>";
+
+    HtmlSettings& settings = SettingsFactory::html();
+    HtmlMoveTreeBuilder builder;
+    QString score;
+
+    updateSan(rendered, info);
+
+    if (info.mate()) {
+        score = evalFmt.arg("#", QString::number(info.mate()));
+    } else {
+        const auto defaultScoreFontSizePx = 16;
+
+        int whiteCp = m_currentBoard.currentPlayer().isBlack() ? -info.score()
+                                                               : info.score();
+        score = evalFmt.arg(
+            whiteCp > 0 ? "+" : "", QString::number(whiteCp / 100.0, 'f', 2),
+            QString::number(defaultScoreFontSizePx *
+                            settings.get("fontScaling").value<double>()));
+    }
+
+    if (m_currentBoard.currentPlayer().isBlack())
+        builder.addMoveNumber(
+            QString::number(m_currentBoard.fullMoveCount()) + "... ");
+
+    for (int i = 0; i < rendered.san.size(); i++) {
+        const Board& board = rendered.boards[i];
+
+        if (board.currentPlayer().isWhite())
+            builder.addMoveNumber(QString::number(board.fullMoveCount()) +
+                                  ". ");
+
+        QString algebraicMove = rendered.san[i];
+        if (i == rendered.san.size() - 1 && info.mate()) {
+            algebraicMove.chop(1);
+            algebraicMove.append('#');
+        }
+        builder.addMove(algebraicMove);
+    }
+
+    return outputFmt.arg(
+        lineFmt.arg(score, movesFmt.arg(builder.htmlWithStyle())));
+}
+
 void EngineWidget::onVariantParsed(VariantInfo info) {
-    m_variants.resize(info.id());
-    m_variants[info.id() - 1] = info;
-    redraw();
+    AnalysisCache::instance().store(m_positionKey, m_engineKey, info);
+    setVariant(info);
+    scheduleRedraw();
+}
+
+void EngineWidget::onEngineFailed(QString reason) {
+    ui->status->setText(QString("<b>%1</b>").arg(reason));
 }
 
 void EngineWidget::onAnalyzeClicked() {
     // No engine and no engine was selected by the user.
     if (!m_engine) return;
 
-    m_variants.clear();
+    clearVariants();
+    showCachedVariants();
     m_engine->startAnalysis(m_currentBoard);
 }
 
@@ -1,18 +1,19 @@
 #ifndef ENGINE_WIDGET_HPP
 #define ENGINE_WIDGET_HPP
 
+#include <QTimer>
 #include <QVector>
 #include <QWidget>
 #include <memory>
 
-#include "engine/engine.hpp"
+#include "engine/engine-pool.hpp"
 #include "game/board.hpp"
 
 namespace Ui {
 class EngineWidget;
 }
 
-typedef std::unique_ptr<Engine> EnginePtr;
+typedef EnginePool::Lease EnginePtr;
 
 class Tree;
 class EngineWidget : public QWidget {
@@ -28,6 +29,7 @@ public slots:
     void setBoard(const Board& board);
 private slots:
     void onVariantParsed(VariantInfo);
+    void onEngineFailed(QString);
     void onAnalyzeClicked();
     void onStopClicked();
 public slots:
@@ -35,11 +37,59 @@ public slots:
     void reset();
 
 private:
+    /*! \brief Rendering cache of a single principal variation. */
+    struct RenderedVariant {
+        /*!< Moves the cache was built from */
+        QVector<Move> moves;
+        /*!< Standard algebraic notation of the moves */
+        QStringList san;
+        /*!< Positions before each move, boards[0] is the current board */
+        QVector<Board> boards;
+        /*!< Html table row, valid unless dirty */
+        QString html;
+        bool dirty = true;
+    };
+
+    /*! \brief Clears parsed variants and their rendering caches. */
+    void clearVariants();
+
+    /*! \brief Shows variants of the current position found in the analysis
+     * cache. */
+    void showCachedVariants();
+
+    /*! \brief Shows moves of the opening book in the current position. */
+    void showBookMoves();
+
+    /*! \brief Shows tablebase result and best move in the current
+     * position. */
+    void showTablebase();
+
+    /*! \brief Puts variant into its multipv slot unless a deeper one is
+     * shown. */
+    void setVariant(const VariantInfo& info);
+
+    /*! \brief Schedules redraw according to the configured frame rate. */
+    void scheduleRedraw();
+
+    /*! \brief Updates SAN cache of the variant reusing its common prefix. */
+    void updateSan(RenderedVariant& rendered, const VariantInfo& info);
+
+    /*! \brief Renders html row of the variant. */
+    QString renderVariant(RenderedVariant& rendered, const VariantInfo& info);
+
     QString m_engineName;
     Ui::EngineWidget* ui;
     EnginePtr m_engine;
     Board m_currentBoard;
+    /*!< Analysis cache keys of the engine and of the current position */
+    quint64 m_engineKey;
+    quint64 m_positionKey;
+    /*!< MultiPV the engine is configured with, higher ids are dropped */
+    int m_maxVariants;
     QVector<VariantInfo> m_variants;
+    QVector<RenderedVariant> m_rendered;
+    /*!< Coalesces engine output into at most one redraw per frame */
+    QTimer m_redrawTimer;
 };
 
 #endif  // ENGINE_WIDGET_HPP
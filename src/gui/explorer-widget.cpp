@@ -0,0 +1,95 @@
+#include "gui/explorer-widget.hpp"
+
+#include <QHeaderView>
+#include <QThread>
+#include <QVBoxLayout>
+
+#include "database/game-database.hpp"
+#include "gui/build-progress-widget.hpp"
+#include "util/stringify.hpp"
+
+ExplorerWidget::ExplorerWidget(QWidget* parent)
+    : QWidget(parent),
+      m_build(new BuildProgressWidget(this)),
+      m_table(new QTableWidget(this)) {
+    m_table->setColumnCount(6);
+    m_table->setHorizontalHeaderLabels(
+        {"Move", "Games", "White %", "Draw %", "Black %", "Rating"});
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+
+    auto* layout = new QVBoxLayout(this);
+    layout->addWidget(m_build);
+    layout->addWidget(m_table);
+
+    QObject::connect(m_table, &QTableWidget::cellDoubleClicked, this,
+                     &ExplorerWidget::onCellDoubleClicked);
+    QObject::connect(m_build, &BuildProgressWidget::finished, this,
+                     &ExplorerWidget::onBuilt);
+}
+
+QSize ExplorerWidget::sizeHint() const { return QSize(400, 250); }
+
+bool ExplorerWidget::open(const GameDatabase& database, const QString& path) {
+    m_build->abort();
+    m_path = path;
+    if (m_explorer.open(path) &&
+        m_explorer.indexedGames() == database.gameCount())
+        return true;
+
+    // Statistics are computed once per database, lookups only read them.
+    m_explorer.close();
+    m_build->start(tr("Computing move statistics"),
+                   [&database, path](BuildProgress& progress) {
+                       return OpeningExplorer::build(
+                           database, path, QThread::idealThreadCount(),
+                           &progress);
+                   });
+    return true;
+}
+
+void ExplorerWidget::abortBuild() { m_build->abort(); }
+
+void ExplorerWidget::setBoard(const Board& board) {
+    m_board = board;
+    QVector<OpeningExplorer::MoveStats> moves = m_explorer.moves(board);
+    auto percent = [](quint32 count, quint32 total) {
+        return total ? QString::number(count * 100.0 / total, 'f', 1)
+                     : QString("-");
+    };
+
+    m_moves.clear();
+    m_table->setRowCount(moves.size());
+    for (int row = 0; row < moves.size(); row++) {
+        const OpeningExplorer::MoveStats& current = moves[row];
+        quint32 scored =
+            current.whiteWins + current.draws + current.blackWins;
+        QStringList cells = {
+            Stringify::algebraicNotationString(board, current.move),
+            QString::number(current.games),
+            percent(current.whiteWins, scored),
+            percent(current.draws, scored),
+            percent(current.blackWins, scored),
+            current.averageRating ? QString::number(current.averageRating)
+                                  : QString("-")};
+        m_moves.append(current.move);
+
+        for (int column = 0; column < cells.size(); column++) {
+            QTableWidgetItem* item = m_table->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                m_table->setItem(row, column, item);
+            }
+            item->setText(cells[column]);
+        }
+    }
+}
+
+void ExplorerWidget::onCellDoubleClicked(int row, int) {
+    if (row >= 0 && row < m_moves.size()) emit moveSelected(m_moves[row]);
+}
+
+void ExplorerWidget::onBuilt(bool built) {
+    if (built && m_explorer.open(m_path)) setBoard(m_board);
+}
@@ -0,0 +1,51 @@
+#ifndef EXPLORER_WIDGET_HPP
+#define EXPLORER_WIDGET_HPP
+#include <QTableWidget>
+#include <QVector>
+#include <QWidget>
+
+#include "database/opening-explorer.hpp"
+#include "game/board.hpp"
+
+class BuildProgressWidget;
+class GameDatabase;
+/*! \brief Opening explorer, statistics of moves played in the board position.
+ */
+class ExplorerWidget : public QWidget {
+    Q_OBJECT
+public:
+    explicit ExplorerWidget(QWidget* parent = nullptr);
+
+    /*! \brief Opens explorer of \a database stored at \a path, building it
+     * in the background when it is missing or older than the database.
+     * \a database must outlive the build, see abortBuild().
+     * \returns false if the explorer cannot be opened
+     */
+    bool open(const GameDatabase& database, const QString& path);
+
+    /*! \brief Cancels running build and waits for it */
+    void abortBuild();
+
+    virtual QSize sizeHint() const;
+public slots:
+    /*! \brief Shows moves played in \a board */
+    void setBoard(const Board& board);
+signals:
+    /*! \brief Emitted when a move is double-clicked */
+    void moveSelected(Move move);
+private slots:
+    void onCellDoubleClicked(int row, int column);
+    void onBuilt(bool built);
+
+private:
+    OpeningExplorer m_explorer;
+    QString m_path;
+    /*!< Board shown, listed again once the explorer is built */
+    Board m_board;
+    BuildProgressWidget* m_build;
+    QTableWidget* m_table;
+    /*!< Moves of the table rows */
+    QVector<Move> m_moves;
+};
+
+#endif  // EXPLORER_WIDGET_HPP
@@ -3,20 +3,40 @@
 #include <QtCore/qnamespace.h>
 #include <QtCore/qobject.h>
 
+#include <QFile>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDir>
 #include <QInputDialog>
 #include <QMessageBox>
+#include <QStandardPaths>
 #include <algorithm>
 
+#include "book/polyglot-book.hpp"
+#include "engine/analysis-cache.hpp"
 #include "game/board.hpp"
+#include "gui/database-widget.hpp"
 #include "gui/engine/engine-widget.hpp"
+#include "gui/match-widget.hpp"
+#include "gui/profiler-widget.hpp"
 #include "gui/settings/engine-settings-dialog.hpp"
 #include "gui/settings/settings-dialog.hpp"
+#include "match/match-runner.hpp"
+#include "pgn/pgn-writer.hpp"
 #include "settings/settings-factory.hpp"
+#include "tablebase/tablebase.hpp"
 #include "ui_main-window.h"
+#include "util/profiler.hpp"
 #include "util/widgets.hpp"
 
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), m_ui(new Ui::MainWindow), m_settingsDialog(nullptr) {
+    : QMainWindow(parent),
+      m_ui(new Ui::MainWindow),
+      m_settingsDialog(nullptr),
+      m_profilerDock(nullptr),
+      m_databaseDock(nullptr),
+      m_databaseWidget(nullptr) {
     m_ui->setupUi(this);
     setWindowTitle("QtChess");
     // Setup widgets
@@ -40,15 +60,79 @@ MainWindow::MainWindow(QWidget *parent)
                      SLOT(onBoardReset()));
     QObject::connect(m_ui->actionSetFen, SIGNAL(triggered()), this,
                      SLOT(onSetFen()));
+    QObject::connect(m_ui->actionSetPgn, SIGNAL(triggered()), this,
+                     SLOT(onSetPgn()));
     QObject::connect(m_ui->actionQuit, SIGNAL(triggered()), this,
                      SLOT(close()));
     QObject::connect(m_ui->actionEngineConfigs, SIGNAL(triggered()), this,
                      SLOT(onConfigEngine()));
 
+    QAction *openPgnAction = new QAction("&Open PGN...", this);
+    m_ui->menuFile->insertAction(m_ui->actionReset, openPgnAction);
+    QObject::connect(openPgnAction, &QAction::triggered, this,
+                     &MainWindow::onOpenPgn);
+    QAction *savePgnAction = new QAction("&Save PGN...", this);
+    m_ui->menuFile->insertAction(m_ui->actionReset, savePgnAction);
+    QObject::connect(savePgnAction, &QAction::triggered, this,
+                     &MainWindow::onSavePgn);
+    QAction *openDatabaseAction = new QAction("Open &database...", this);
+    m_ui->menuFile->insertAction(m_ui->actionReset, openDatabaseAction);
+    QObject::connect(openDatabaseAction, &QAction::triggered, this,
+                     &MainWindow::onOpenDatabase);
+
+    QAction *profilerAction = m_ui->menuView->addAction("Profiler");
+    QObject::connect(profilerAction, &QAction::triggered, this,
+                     &MainWindow::createProfilerPanel);
+    QAction *matchAction = m_ui->menuTools->addAction("Engine match...");
+    QObject::connect(matchAction, &QAction::triggered, this,
+                     &MainWindow::onEngineMatch);
+
     // Connect text widget signals
     QObject::connect(m_ui->GameTextWidget, &MoveTreeWidget::moveSelected, this,
                      &MainWindow::onPositionSet);
     onEngineListChanged(SettingsFactory::engines().names());
+
+    // Analysis of visited positions survives restarts, 0 MB disables it.
+    qint64 cacheMb =
+        SettingsFactory::engines().get("intAnalysisCacheMb").toInt();
+    if (cacheMb > 0) {
+        QString dir =
+            QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        QDir().mkpath(dir);
+        AnalysisCache::instance().open(dir + "/analysis-cache.bin",
+                                       cacheMb * 1024 * 1024);
+    }
+
+    // Book moves are shown beside engine output.
+    EnginesSettings &engines = SettingsFactory::engines();
+    QString randomFile = engines.get("stringPolyglotRandomFile").toString();
+    if (!randomFile.isEmpty() && !PolyglotBook::loadRandomTable(randomFile))
+        QMessageBox::warning(
+            this, "Opening book",
+            tr("'%1' does not hold the Polyglot Random64 table")
+                .arg(randomFile));
+    QString bookPath = engines.get("stringBookPath").toString();
+    if (!bookPath.isEmpty() && !PolyglotBook::instance().open(bookPath))
+        QMessageBox::warning(
+            this, "Opening book",
+            PolyglotBook::hasStandardTable()
+                ? tr("Cannot open book '%1'").arg(bookPath)
+                : tr("Cannot open book '%1'. Books of other programs need "
+                     "the Polyglot Random64 file set in the settings.")
+                      .arg(bookPath));
+
+    // Tables are only listed here, they are mapped when first probed.
+    QString syzygyPath = engines.get("stringSyzygyPath").toString();
+    if (!syzygyPath.isEmpty() && Tablebase::instance().init(syzygyPath) == 0)
+        QMessageBox::warning(
+            this, "Tablebases",
+            tr("No Syzygy tables found in '%1'").arg(syzygyPath));
+
+    // Engines answer right away when their panel is opened.
+    if (SettingsFactory::engines().get("boolPrewarmEngines").toBool()) {
+        for (const EngineConfig &config : SettingsFactory::engines().configs())
+            m_enginePool.prewarm(config);
+    }
 }
 
 MainWindow::~MainWindow() { delete m_ui; }
@@ -79,8 +163,15 @@ void MainWindow::onBoardReset() {
 void MainWindow::onPositionChanged() { stateChanged(); }
 
 void MainWindow::onPositionSet(size_t uid) {
+    const TreeNode *previous = m_state.getTree()->currentNode();
+    const TreeNode *node = TreeNode::fromUid(uid);
+
     m_state.setByTreeNode(TreeNode::fromUid(uid));
-    stateChanged();
+    // Stepping forward by one move slides the piece.
+    if (node->parent() == previous)
+        stateChanged(node->parentMove());
+    else
+        stateChanged();
 }
 
 void MainWindow::onSetFen() {
@@ -104,6 +195,108 @@ void MainWindow::onSetFen() {
     }
 }
 
+void MainWindow::onSetPgn() {
+    bool accepted = false;
+    QString pgn = QInputDialog::getMultiLineText(
+        this, "Enter game", "PGN:", QString(), &accepted);
+    if (!accepted) return;
+
+    QByteArray data = pgn.toUtf8();
+    PgnReader reader(data.constData(), data.constData() + data.size());
+    if (!loadGame(reader))
+        QMessageBox::information(this, "PGN invalid",
+                                 tr("Passed text is not a valid PGN game: %1")
+                                     .arg(reader.lastError()));
+}
+
+void MainWindow::onOpenPgn() {
+    QString path = QFileDialog::getOpenFileName(
+        this, "Open PGN", QString(), "PGN files (*.pgn);;All files (*)");
+    if (path.isEmpty()) return;
+
+    QFile input(path);
+    if (!input.open(QIODevice::ReadOnly)) {
+        QMessageBox::information(this, "Cannot open file",
+                                 tr("Cannot open '%1'").arg(path));
+        return;
+    }
+    PgnReader reader(&input);
+    if (!loadGame(reader))
+        QMessageBox::information(
+            this, "PGN invalid",
+            tr("'%1' has no valid game: %2").arg(path, reader.lastError()));
+}
+
+void MainWindow::onSavePgn() {
+    QString path = QFileDialog::getSaveFileName(
+        this, "Save PGN", QString(), "PGN files (*.pgn);;All files (*)");
+    if (path.isEmpty()) return;
+
+    QFile output(path);
+    bool saved = output.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    if (saved) {
+        PgnWriter writer(&output);
+        writer.writeGame(*m_state.getTree());
+        saved = writer.flush();
+    }
+    if (!saved)
+        QMessageBox::information(this, "Cannot save file",
+                                 tr("Cannot write '%1'").arg(path));
+}
+
+void MainWindow::onOpenDatabase() {
+    QString path = QFileDialog::getOpenFileName(this, "Open database");
+    if (path.isEmpty()) return;
+
+    auto *widget = new DatabaseWidget();
+    if (!widget->open(path)) {
+        delete widget;
+        QMessageBox::information(this, "Cannot open database",
+                                 tr("'%1' is not a game database").arg(path));
+        return;
+    }
+
+    // Only one database is shown at a time.
+    if (m_databaseDock) {
+        m_databaseDock->setWidget(widget);
+        m_databaseWidget->deleteLater();
+    } else {
+        m_databaseDock = new CloseDockWidget(this);
+        m_databaseDock->setWidget(widget);
+        this->addDockWidget(Qt::BottomDockWidgetArea, m_databaseDock);
+        QObject::connect(m_databaseDock, &CloseDockWidget::closed, [this]() {
+            m_databaseDock->deleteLater();
+            m_databaseDock = nullptr;
+            m_databaseWidget = nullptr;
+        });
+    }
+    m_databaseWidget = widget;
+    m_databaseDock->setWindowTitle(QFileInfo(path).fileName());
+    QObject::connect(widget, &DatabaseWidget::gameSelected, this,
+                     &MainWindow::onDatabaseGameSelected);
+    QObject::connect(widget, &DatabaseWidget::moveSelected, this,
+                     &MainWindow::onMoveMade);
+    widget->setBoard(m_state.getBoard());
+    m_databaseDock->show();
+}
+
+void MainWindow::onDatabaseGameSelected(qint64 index) {
+    std::unique_ptr<Tree> game = m_databaseWidget->database().game(index);
+    if (!game) return;
+
+    m_state.setTree(std::move(game));
+    stateChanged();
+}
+
+bool MainWindow::loadGame(PgnReader &reader) {
+    std::unique_ptr<Tree> game = reader.readGame();
+    if (!game) return false;
+
+    m_state.setTree(std::move(game));
+    stateChanged();
+    return true;
+}
+
 void MainWindow::closeEvent(QCloseEvent *) {
     auto &layout = SettingsFactory::layout();
     layout.set(LayoutSettings::MAIN_WINDOW_GEOMETRY, saveGeometry());
@@ -111,12 +304,15 @@ void MainWindow::closeEvent(QCloseEvent *) {
     layout.save();
 }
 
-void MainWindow::stateChanged() {
+void MainWindow::stateChanged(Move animatedMove) {
+    ProfileScope profile("MainWindow::stateChanged");
+    m_ui->Board->animateMove(animatedMove);
     m_ui->Board->redraw();
     m_ui->GameTextWidget->redraw();
     std::for_each(m_engineWidgets.begin(), m_engineWidgets.end(), [this](EngineWidget *p) {
         p->setBoard(this->m_state.getBoard());
     });
+    if (m_databaseWidget) m_databaseWidget->setBoard(m_state.getBoard());
 }
 
 void MainWindow::onConfigEngine() {
@@ -158,7 +354,17 @@ void MainWindow::onEngineListChanged(QStringList engineList) {
 void MainWindow::createEnginePanel(const QString &name) {
     auto *dock = new CloseDockWidget(this);
     auto engineConfig = SettingsFactory::engines().config(name);
-    EnginePtr pEngine = std::make_unique<Engine>(engineConfig);
+
+    // Sessions are recorded for offline replay when a directory is set.
+    QString recordFile;
+    QString logDir =
+        SettingsFactory::engines().get("stringUciLogDir").toString();
+    if (!logDir.isEmpty()) {
+        QString stamp =
+            QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss");
+        recordFile = QString("%1/%2-%3.uci").arg(logDir, name, stamp);
+    }
+    EnginePtr pEngine = m_enginePool.lease(engineConfig, recordFile);
     auto *enginePanel = new EngineWidget(std::move(pEngine), name, this);
     dock->setWidget(enginePanel);
     this->addDockWidget(Qt::RightDockWidgetArea, dock);
@@ -171,3 +377,72 @@ void MainWindow::createEnginePanel(const QString &name) {
                      });
     dock->show();
 }
+
+void MainWindow::createProfilerPanel() {
+    if (m_profilerDock) {
+        m_profilerDock->raise();
+        return;
+    }
+
+    m_profilerDock = new CloseDockWidget("Profiler", this);
+    m_profilerDock->setWidget(new ProfilerWidget(m_profilerDock));
+    this->addDockWidget(Qt::BottomDockWidgetArea, m_profilerDock);
+    QObject::connect(m_profilerDock, &CloseDockWidget::closed, [this]() {
+        m_profilerDock->deleteLater();
+        m_profilerDock = nullptr;
+    });
+    m_profilerDock->show();
+}
+
+void MainWindow::onEngineMatch() {
+    QStringList engines = SettingsFactory::engines().names();
+    if (engines.isEmpty()) {
+        QMessageBox::information(this, "Engine match",
+                                 "Configure at least one engine first.");
+        return;
+    }
+
+    bool ok;
+    QString first = QInputDialog::getItem(this, "Engine match",
+                                          "First engine:", engines, 0, false,
+                                          &ok);
+    if (!ok) return;
+    QString second = QInputDialog::getItem(this, "Engine match",
+                                           "Second engine:", engines, 0, false,
+                                           &ok);
+    if (!ok) return;
+    int games = QInputDialog::getInt(this, "Engine match", "Number of games:",
+                                     100, 1, 1000000, 1, &ok);
+    if (!ok) return;
+
+    TimeControl timeControl;
+    QString timeString = QInputDialog::getText(
+        this, "Engine match", "Time control [s]:", QLineEdit::Normal, "10+0.1",
+        &ok);
+    if (!ok) return;
+    if (!timeControl.fromString(timeString)) {
+        QMessageBox::information(
+            this, "Engine match",
+            tr("'%1' is not a valid time control").arg(timeString));
+        return;
+    }
+
+    auto *runner =
+        new MatchRunner(SettingsFactory::engines().config(first),
+                        SettingsFactory::engines().config(second), timeControl);
+    runner->setGameCount(games);
+
+    // Games are not saved unless a file is chosen.
+    QString path = QFileDialog::getSaveFileName(this, "Save games", QString(),
+                                                "PGN files (*.pgn)");
+    if (!path.isEmpty() && !runner->setOutput(path))
+        QMessageBox::information(this, "Engine match",
+                                 tr("Cannot write to '%1'").arg(path));
+
+    auto *dock = new CloseDockWidget(first + " vs " + second, this);
+    dock->setWidget(new MatchWidget(runner, dock));
+    this->addDockWidget(Qt::BottomDockWidgetArea, dock);
+    QObject::connect(dock, &CloseDockWidget::closed,
+                     [dock]() { dock->deleteLater(); });
+    dock->show();
+}
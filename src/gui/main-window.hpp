@@ -3,14 +3,18 @@
 #include <QMainWindow>
 #include <set>
 
+#include "engine/engine-pool.hpp"
 #include "game/state.hpp"
 #include "gui/engine/engine-widget.hpp"
 #include "gui/settings/settings-dialog.hpp"
+#include "pgn/pgn-reader.hpp"
 
 namespace Ui {
 class MainWindow;
 }
 
+class CloseDockWidget;
+class DatabaseWidget;
 class MainWindow : public QMainWindow {
     Q_OBJECT
 public:
@@ -23,12 +27,23 @@ private slots:
     void onPositionChanged();
     void onPositionSet(size_t);
     void onSetFen();
+    void onSetPgn();
+    void onOpenPgn();
+    void onSavePgn();
+    void onOpenDatabase();
+    void onDatabaseGameSelected(qint64 index);
     void onConfigEngine();
     void onEngineListChanged(QStringList);
     void closeEvent(QCloseEvent *);
+    void createProfilerPanel();
+    void onEngineMatch();
 
 private:
-    void stateChanged();
+    void stateChanged(Move animatedMove = Move::NullMove);
+    /*! \brief Shows the first game read by \a reader
+     * \returns false if there is no valid game
+     */
+    bool loadGame(PgnReader &reader);
     void createEnginePanel(const QString &name);
 
     Ui::MainWindow *m_ui;
@@ -36,6 +51,13 @@ private:
     // Settings dialog
     SettingsDialog *m_settingsDialog;
     std::set<EngineWidget *> m_engineWidgets;
+    // Started engines kept between panel uses
+    EnginePool m_enginePool;
+    // Debug panel with GUI timings
+    CloseDockWidget *m_profilerDock;
+    // Games of the open database reaching the current position
+    CloseDockWidget *m_databaseDock;
+    DatabaseWidget *m_databaseWidget;
 };
 
 #endif  // MAIN_WINDOW_HPP
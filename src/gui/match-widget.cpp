@@ -0,0 +1,48 @@
+#include "gui/match-widget.hpp"
+
+#include <QVBoxLayout>
+
+#include "gui/board/thumbnail-grid-widget.hpp"
+#include "match/match-runner.hpp"
+
+MatchWidget::MatchWidget(MatchRunner* runner, QWidget* parent)
+    : QWidget(parent),
+      m_runner(runner),
+      m_grid(new ThumbnailGridWidget(this)),
+      m_statistics(new QLabel(this)),
+      m_finished(false) {
+    m_runner->setParent(this);
+    m_statistics->setWordWrap(true);
+
+    auto* layout = new QVBoxLayout(this);
+    layout->addWidget(m_statistics);
+    layout->addWidget(m_grid, 1);
+
+    QObject::connect(m_runner, &MatchRunner::gameStarted, this,
+                     [this](int slot, QString white, QString black) {
+                         m_grid->setTitle(slot, white + " - " + black);
+                     });
+    QObject::connect(m_runner, &MatchRunner::positionChanged, m_grid,
+                     [this](int slot, const Board& board) {
+                         m_grid->setPosition(slot, board);
+                     });
+    QObject::connect(m_runner, &MatchRunner::gameFinished, this,
+                     &MatchWidget::updateStatistics);
+    QObject::connect(m_runner, &MatchRunner::finished, this, [this]() {
+        m_finished = true;
+        updateStatistics();
+    });
+
+    m_grid->setBoardCount(qMin(m_runner->concurrency(),
+                               m_runner->gameCount()));
+    updateStatistics();
+    m_runner->start();
+}
+
+QSize MatchWidget::sizeHint() const { return QSize(600, 400); }
+
+void MatchWidget::updateStatistics() {
+    QString text = m_runner->statistics().toString();
+    if (m_finished) text = "<b>Finished.</b> " + text;
+    m_statistics->setText(text);
+}
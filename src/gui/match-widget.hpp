@@ -0,0 +1,26 @@
+#ifndef MATCH_WIDGET_HPP
+#define MATCH_WIDGET_HPP
+#include <QLabel>
+#include <QWidget>
+
+class MatchRunner;
+class ThumbnailGridWidget;
+/*! \brief Panel showing running games and standings of an engine match. */
+class MatchWidget : public QWidget {
+    Q_OBJECT
+public:
+    /*! \brief Takes ownership of the runner and starts it */
+    explicit MatchWidget(MatchRunner* runner, QWidget* parent = nullptr);
+
+    virtual QSize sizeHint() const;
+
+private:
+    void updateStatistics();
+
+    MatchRunner* m_runner;
+    ThumbnailGridWidget* m_grid;
+    QLabel* m_statistics;
+    bool m_finished;
+};
+
+#endif  // MATCH_WIDGET_HPP
@@ -8,6 +8,7 @@
 
 #include "settings/settings-factory.hpp"
 #include "util/html-move-tree-builder.hpp"
+#include "util/profiler.hpp"
 #include "util/stringify.hpp"
 
 
@@ -75,7 +76,10 @@ MoveTreeWidget::MoveTreeWidget(QWidget* parent)
 
 QSize MoveTreeWidget::sizeHint() const { return QSize(250, 100); }
 
-void MoveTreeWidget::redraw() { setHtml(TreeHtml::html(m_state->getTree())); }
+void MoveTreeWidget::redraw() {
+    ProfileScope profile("MoveTreeWidget::redraw");
+    setHtml(TreeHtml::html(m_state->getTree()));
+}
 
 void MoveTreeWidget::onMoveClicked(size_t uid) {
     emit moveSelected(uid);
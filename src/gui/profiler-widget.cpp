@@ -0,0 +1,79 @@
+#include "gui/profiler-widget.hpp"
+
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QMessageBox>
+#include <QVBoxLayout>
+
+#include "util/profiler.hpp"
+
+static const int RefreshIntervalMs = 500;
+
+ProfilerWidget::ProfilerWidget(QWidget* parent)
+    : QWidget(parent),
+      m_table(new QTableWidget(this)),
+      m_resetButton(new QPushButton("Reset")),
+      m_exportButton(new QPushButton("Export trace...")) {
+    m_table->setColumnCount(5);
+    m_table->setHorizontalHeaderLabels(
+        {"Section", "Count", "p50 [ms]", "p99 [ms]", "Max [ms]"});
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    auto* buttons = new QHBoxLayout();
+    buttons->addWidget(m_resetButton);
+    buttons->addWidget(m_exportButton);
+    buttons->addStretch();
+
+    auto* layout = new QVBoxLayout(this);
+    layout->addLayout(buttons);
+    layout->addWidget(m_table);
+
+    QObject::connect(m_resetButton, &QPushButton::clicked,
+                     [] { Profiler::instance().clear(); });
+    QObject::connect(m_exportButton, &QPushButton::clicked, this,
+                     &ProfilerWidget::onExportClicked);
+    QObject::connect(&m_refreshTimer, &QTimer::timeout, this,
+                     &ProfilerWidget::refresh);
+
+    // Recording lasts as long as the panel exists.
+    Profiler::instance().setEnabled(true);
+    m_refreshTimer.start(RefreshIntervalMs);
+}
+
+ProfilerWidget::~ProfilerWidget() { Profiler::instance().setEnabled(false); }
+
+QSize ProfilerWidget::sizeHint() const { return QSize(400, 200); }
+
+void ProfilerWidget::refresh() {
+    QVector<Profiler::Stats> stats = Profiler::instance().stats();
+    auto ms = [](double us) { return QString::number(us / 1000.0, 'f', 3); };
+
+    m_table->setRowCount(stats.size());
+    for (int row = 0; row < stats.size(); row++) {
+        const Profiler::Stats& current = stats[row];
+        QStringList cells = {current.section, QString::number(current.count),
+                             ms(current.p50), ms(current.p99),
+                             ms(current.max)};
+
+        for (int column = 0; column < cells.size(); column++) {
+            QTableWidgetItem* item = m_table->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                m_table->setItem(row, column, item);
+            }
+            item->setText(cells[column]);
+        }
+    }
+}
+
+void ProfilerWidget::onExportClicked() {
+    QString path = QFileDialog::getSaveFileName(
+        this, "Export Chrome trace", "qtchess-trace.json", "JSON (*.json)");
+    if (path.isEmpty()) return;
+
+    if (!Profiler::instance().exportChromeTrace(path))
+        QMessageBox::warning(this, "Export failed",
+                             tr("Cannot write trace to '%1'").arg(path));
+}
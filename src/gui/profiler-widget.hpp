@@ -0,0 +1,29 @@
+#ifndef PROFILER_WIDGET_HPP
+#define PROFILER_WIDGET_HPP
+#include <QPushButton>
+#include <QTableWidget>
+#include <QTimer>
+#include <QWidget>
+
+/*! \brief Debug panel showing GUI timings collected by the Profiler. */
+class ProfilerWidget : public QWidget {
+    Q_OBJECT
+public:
+    explicit ProfilerWidget(QWidget* parent = nullptr);
+    ~ProfilerWidget();
+
+    virtual QSize sizeHint() const;
+public slots:
+    /*! \brief Refreshes statistics table */
+    void refresh();
+private slots:
+    void onExportClicked();
+
+private:
+    QTableWidget* m_table;
+    QPushButton* m_resetButton;
+    QPushButton* m_exportButton;
+    QTimer m_refreshTimer;
+};
+
+#endif  // PROFILER_WIDGET_HPP
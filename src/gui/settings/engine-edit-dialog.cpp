@@ -72,7 +72,7 @@ bool EngineEditDialog::settingsValid() {
 
         // Try to start an engine.
         try {
-            Engine(m_config).start();
+            Engine(m_config).startAndWait();
             // It started!
             return true;
         } catch (std::runtime_error& error) {
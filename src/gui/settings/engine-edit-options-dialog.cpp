@@ -27,7 +27,7 @@ void EngineEditOptionsDialog::rebuildTable() {
 
     table->clearContents();
     Engine engine(m_config);
-    engine.start();
+    engine.startAndWait();
 
     for (const EngineOption& option : engine.options()) {
         QWidget* widget;
@@ -0,0 +1,260 @@
+#include "match/match-game.hpp"
+
+#include "game/zobrist.hpp"
+#include "util/stringify.hpp"
+
+/*! \brief Returns key of the position for the repetition rule: pieces,
+ * side to move, castling rights and en passant file only if the capture is
+ * possible, the move counters do not count. */
+static quint64 repetitionKey(const Board& board) {
+    return Zobrist::hash(board);
+}
+
+MatchGame::MatchGame(Engine* white, Engine* black, const Board& start,
+                     const TimeControl& timeControl, QObject* parent)
+    : QObject(parent),
+      m_white(white),
+      m_black(black),
+      m_start(start),
+      m_board(start),
+      m_timeControl(timeControl),
+      m_clock{timeControl.base() * 1000, timeControl.base() * 1000},
+      m_ponder(false),
+      m_ponderMove{Move::NullMove, Move::NullMove},
+      m_book(nullptr),
+      m_bookPlies(0),
+      m_result(Unfinished) {
+    m_repetitions[repetitionKey(m_board)] = 1;
+}
+
+void MatchGame::setBook(const PolyglotBook* book, int maxPlies,
+                        quint64 seed) {
+    m_book = book;
+    m_bookPlies = maxPlies;
+    m_bookRandom.seed(seed);
+}
+
+void MatchGame::start() {
+    for (Player side : {Player::white(), Player::black()}) {
+        Engine* current = engine(side);
+        m_connections.append(QObject::connect(
+            current, &Engine::bestMoveFound, this,
+            [this, side](Move move, Move ponderMove, VariantInfo) {
+                onBestMoveFound(side, move, ponderMove);
+            }));
+        m_connections.append(
+            QObject::connect(current, &Engine::failed, this,
+                             [this, side](QString reason) {
+                                 onFailed(side, reason);
+                             }));
+        if (!current->started()) current->start();
+        // Engines are reused by MatchRunner, they must not carry over
+        // hash tables or history of the previous game.
+        current->newGame();
+    }
+
+    if (!adjudicate()) requestMove();
+}
+
+QString MatchGame::resultString() const {
+    switch (m_result) {
+        case WhiteWins:
+            return "1-0";
+        case BlackWins:
+            return "0-1";
+        case Draw:
+            return "1/2-1/2";
+        default:
+            return "*";
+    }
+}
+
+Engine* MatchGame::engine(Player side) const {
+    return side.isWhite() ? m_white : m_black;
+}
+
+SearchLimits MatchGame::clockLimits() const {
+    SearchLimits limits;
+    limits.whiteTime = qMax<qint64>(1, m_clock[0] / 1000);
+    limits.blackTime = qMax<qint64>(1, m_clock[1] / 1000);
+    limits.whiteIncrement = m_timeControl.increment();
+    limits.blackIncrement = m_timeControl.increment();
+    return limits;
+}
+
+void MatchGame::requestMove() {
+    // Book moves are played at once and cost no clock time.
+    Move move = bookMove();
+    if (move != Move::NullMove) {
+        playMove(move);
+        if (!adjudicate()) requestMove();
+        return;
+    }
+
+    Player side = m_board.currentPlayer();
+    Engine* current = engine(side);
+    Move expected = m_ponderMove[index(side)];
+    m_ponderMove[index(side)] = Move::NullMove;
+
+    if (expected != Move::NullMove && current->isPondering() &&
+        !m_moves.isEmpty() && m_moves.last() == expected) {
+        current->ponderHit();
+        return;
+    }
+    // Full history lets the engine see repetitions and keep its hash. A ponder
+    // search on a wrong guess is stopped by the new one.
+    current->startAnalysis(m_start, m_moves, clockLimits());
+}
+
+Move MatchGame::bookMove() {
+    if (!m_book || m_moves.size() >= m_bookPlies) return Move::NullMove;
+
+    Move move = m_book->pick(m_board, m_bookRandom.generate());
+    if (move == Move::NullMove) m_book = nullptr;
+    return move;
+}
+
+void MatchGame::playMove(Move move) {
+    m_san.append(Stringify::algebraicNotationString(m_board, move));
+    m_moves.append(move);
+    m_board.makeMove(move);
+    ++m_repetitions[repetitionKey(m_board)];
+    emit moveMade(move);
+}
+
+void MatchGame::startPonder(Player side, Move ponderMove) {
+    // Engine playing both sides would have to ponder on its own time.
+    if (m_white == m_black || ponderMove == Move::NullMove ||
+        !m_board.isLegal(ponderMove))
+        return;
+
+    QVector<Move> moves = m_moves;
+    moves.append(ponderMove);
+    SearchLimits limits = clockLimits();
+    limits.ponder = true;
+
+    m_ponderMove[index(side)] = ponderMove;
+    engine(side)->startAnalysis(m_start, moves, limits);
+}
+
+void MatchGame::onBestMoveFound(Player side, Move move, Move ponderMove) {
+    if (m_result != Unfinished) return;
+    if (side != m_board.currentPlayer()) {
+        // Ponder search has ended on its own, the engine searches afresh.
+        m_ponderMove[index(side)] = Move::NullMove;
+        return;
+    }
+
+    QString name = engine(side)->config().name();
+    Result loss = side.isWhite() ? BlackWins : WhiteWins;
+
+    m_clock[index(side)] -= engine(side)->lastSearchTime();
+    if (m_clock[index(side)] < 0) {
+        // Flag does not win when nobody can mate the flagged side.
+        if (m_board.isInsufficientMaterial())
+            finish(Draw, "time forfeit", name + " loses on time, no material");
+        else
+            finish(loss, "time forfeit", name + " loses on time");
+        return;
+    }
+    m_clock[index(side)] += m_timeControl.increment() * 1000;
+
+    if (move == Move::NullMove || !m_board.isLegal(move)) {
+        finish(loss, "rules infraction", name + " makes an illegal move");
+        return;
+    }
+
+    playMove(move);
+    if (adjudicate()) return;
+    requestMove();
+    if (m_ponder) startPonder(side, ponderMove);
+}
+
+void MatchGame::onFailed(Player side, QString reason) {
+    if (m_result != Unfinished) return;
+
+    finish(side.isWhite() ? BlackWins : WhiteWins, "abandoned",
+           QString("%1 disconnects: %2")
+               .arg(engine(side)->config().name(), reason));
+}
+
+bool MatchGame::adjudicate() {
+    Player side = m_board.currentPlayer();
+
+    if (m_board.isCheckmate()) {
+        finish(side.isWhite() ? BlackWins : WhiteWins, "normal",
+               side.isWhite() ? "Black mates" : "White mates");
+    } else if (m_board.isStalemate()) {
+        finish(Draw, "normal", "Draw by stalemate");
+    } else if (m_board.isInsufficientMaterial()) {
+        finish(Draw, "normal", "Draw by insufficient mating material");
+    } else if (m_board.halfMoveClock() >= 100) {
+        finish(Draw, "normal", "Draw by fifty moves rule");
+    } else if (m_repetitions.value(repetitionKey(m_board)) >= 3) {
+        finish(Draw, "normal", "Draw by threefold repetition");
+    }
+    return m_result != Unfinished;
+}
+
+void MatchGame::finish(Result result, const QString& termination,
+                       const QString& reason) {
+    m_result = result;
+    m_termination = termination;
+    m_reason = reason;
+
+    for (const QMetaObject::Connection& connection : m_connections)
+        QObject::disconnect(connection);
+    m_connections.clear();
+
+    // Engine may still think if the game ended by its opponent's failure.
+    m_white->stopAnalysis();
+    m_black->stopAnalysis();
+
+    emit finished(result);
+}
+
+QString MatchGame::toPgn(const QList<QPair<QString, QString>>& tags) const {
+    static const QString startFen = Board().toFen();
+    QString pgn;
+
+    for (const auto& tag : tags)
+        pgn += QString("[%1 \"%2\"]\n").arg(tag.first, tag.second);
+    // Board::toFen() writes the six single-spaced fields PgnReader wants.
+    QString fen = m_start.toFen();
+    if (fen != startFen) {
+        pgn += "[SetUp \"1\"]\n";
+        pgn += QString("[FEN \"%1\"]\n").arg(fen);
+    }
+    pgn += QString("[Result \"%1\"]\n").arg(resultString());
+    if (!m_termination.isEmpty())
+        pgn += QString("[Termination \"%1\"]\n").arg(m_termination);
+    pgn += "\n";
+
+    QStringList tokens;
+    int moveNumber = m_start.fullMoveCount();
+    bool white = m_start.currentPlayer().isWhite();
+    if (!white && !m_san.isEmpty())
+        tokens.append(QString("%1...").arg(moveNumber));
+
+    for (const QString& san : m_san) {
+        if (white) tokens.append(QString("%1.").arg(moveNumber));
+        tokens.append(san);
+        if (!white) ++moveNumber;
+        white = !white;
+    }
+    if (!m_reason.isEmpty()) tokens.append(QString("{%1}").arg(m_reason));
+    tokens.append(resultString());
+
+    // Export format keeps lines below 80 characters.
+    QString line;
+    for (const QString& token : tokens) {
+        if (!line.isEmpty() && line.size() + 1 + token.size() > 79) {
+            pgn += line + "\n";
+            line.clear();
+        }
+        if (!line.isEmpty()) line += ' ';
+        line += token;
+    }
+    pgn += line + "\n\n";
+    return pgn;
+}
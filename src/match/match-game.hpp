@@ -0,0 +1,119 @@
+#ifndef MATCH_GAME_HPP
+#define MATCH_GAME_HPP
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QVector>
+
+#include "book/polyglot-book.hpp"
+#include "engine/engine.hpp"
+#include "game/board.hpp"
+#include "match/time-control.hpp"
+
+/*! \brief Single game between two engines.
+ *
+ * Clocks are charged with the search time measured in the engine thread,
+ * from sending "go" to reading "bestmove", so that the load of the GUI thread
+ * does not count against the engines. The game ends on mate, stalemate,
+ * insufficient material, the fifty-move rule, threefold repetition, time
+ * forfeit, an illegal move or an engine failure.
+ *
+ * With pondering enabled the engine that has just moved searches the move it
+ * expects from its opponent on the opponent's time. If the guess is right the
+ * search goes on after "ponderhit" and only the time from then on is charged,
+ * otherwise the ponder search is stopped and the real position is searched.
+ *
+ * With an opening book the first plies are picked from the book by weight,
+ * without asking the engines and without using their clocks. The game leaves
+ * the book for good at the first position the book does not know.
+ */
+class MatchGame : public QObject {
+    Q_OBJECT
+public:
+    enum Result { Unfinished, WhiteWins, BlackWins, Draw };
+
+    MatchGame(Engine* white, Engine* black, const Board& start,
+              const TimeControl& timeControl, QObject* parent = nullptr);
+
+    /*! \brief Lets engines think on the opponent's time, engines should
+     * have the "Ponder" option set. Disabled by default. */
+    void setPonder(bool enabled) { m_ponder = enabled; }
+
+    /*! \brief Plays up to \a maxPlies plies from \a book. Games with the
+     * same \a seed pick the same moves, so that both colors of an opening
+     * get the same line. */
+    void setBook(const PolyglotBook* book, int maxPlies, quint64 seed);
+
+    /*! \brief Asks the side to move for its move */
+    void start();
+
+    Result result() const { return m_result; }
+
+    /*! \brief Returns result in PGN notation, e.g. "1-0" */
+    QString resultString() const;
+
+    /*! \brief Returns human readable reason of the game end */
+    const QString& reason() const { return m_reason; }
+
+    /*! \brief Returns value of the PGN Termination tag */
+    const QString& termination() const { return m_termination; }
+
+    const Board& board() const { return m_board; }
+    const Board& startBoard() const { return m_start; }
+    const QVector<Move>& moves() const { return m_moves; }
+
+    /*! \brief Returns game in PGN, \a tags go first in the given order */
+    QString toPgn(const QList<QPair<QString, QString>>& tags) const;
+signals:
+    void moveMade(Move move);
+    void finished(MatchGame::Result result);
+
+private:
+    void requestMove();
+    /*! \brief Returns move picked from the book, null if out of book */
+    Move bookMove();
+    /*! \brief Plays legal \a move on the board */
+    void playMove(Move move);
+    /*! \brief Starts \a side thinking on the opponent's time, expecting
+     * \a ponderMove */
+    void startPonder(Player side, Move ponderMove);
+    /*! \brief Returns search limits with the current clocks */
+    SearchLimits clockLimits() const;
+    void onBestMoveFound(Player side, Move move, Move ponderMove);
+    void onFailed(Player side, QString reason);
+    /*! \brief Ends the game if the rules say so */
+    bool adjudicate();
+    void finish(Result result, const QString& termination,
+                const QString& reason);
+
+    Engine* engine(Player side) const;
+    int index(Player side) const { return side.isWhite() ? 0 : 1; }
+
+    Engine* m_white;
+    Engine* m_black;
+    Board m_start;
+    Board m_board;
+    TimeControl m_timeControl;
+    /*!< Remaining time of white and black in microseconds */
+    qint64 m_clock[2];
+    bool m_ponder;
+    /*!< Move white and black ponder on, null if not pondering */
+    Move m_ponderMove[2];
+    /*!< Book the game follows, null once out of book */
+    const PolyglotBook* m_book;
+    int m_bookPlies;
+    QRandomGenerator m_bookRandom;
+    QVector<Move> m_moves;
+    QStringList m_san;
+    /*!< Occurrences of every position, keyed by its Zobrist hash */
+    QHash<quint64, int> m_repetitions;
+    Result m_result;
+    QString m_termination;
+    QString m_reason;
+    QList<QMetaObject::Connection> m_connections;
+};
+
+#endif  // MATCH_GAME_HPP
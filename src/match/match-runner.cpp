@@ -0,0 +1,157 @@
+#include "match/match-runner.hpp"
+
+#include <QDate>
+#include <QStringList>
+#include <QThread>
+
+MatchRunner::MatchRunner(const EngineConfig& first, const EngineConfig& second,
+                         const TimeControl& timeControl, QObject* parent)
+    : QObject(parent),
+      m_first(first),
+      m_second(second),
+      m_timeControl(timeControl),
+      m_gameCount(2),
+      m_concurrency(QThread::idealThreadCount()),
+      m_nextRound(0),
+      m_running(0),
+      m_ponder(false),
+      m_bookPlies(0) {}
+
+MatchRunner::~MatchRunner() {
+    for (Slot& slot : m_slots) delete slot.game;
+}
+
+bool MatchRunner::addOpening(const QString& line) {
+    QStringList tokens = line.simplified().split(' ');
+    if (tokens.size() < 4) return false;
+
+    // EPD has no move counters, operations follow the castling and en
+    // passant fields instead.
+    bool hasCounters = tokens.size() >= 6;
+    if (hasCounters) {
+        tokens[4].toInt(&hasCounters);
+        if (hasCounters) tokens[5].toInt(&hasCounters);
+    }
+    QString fen = tokens.mid(0, 4).join(' ') +
+                  (hasCounters ? " " + tokens[4] + " " + tokens[5] : " 0 1");
+
+    Board board;
+    if (!board.setFen(fen)) return false;
+
+    m_openings.append(board);
+    return true;
+}
+
+void MatchRunner::setGameCount(int count) { m_gameCount = qMax(1, count); }
+
+void MatchRunner::setConcurrency(int count) {
+    m_concurrency = qMax(1, count);
+}
+
+bool MatchRunner::setOutput(const QString& path) {
+    m_output.close();
+    m_output.setFileName(path);
+    return m_output.open(QIODevice::WriteOnly | QIODevice::Append);
+}
+
+bool MatchRunner::setBook(const QString& path, int maxPlies) {
+    m_bookPlies = maxPlies;
+    return m_book.open(path);
+}
+
+void MatchRunner::setSprt(double elo0, double elo1, double alpha,
+                          double beta) {
+    m_statistics.setSprt(elo0, elo1, alpha, beta);
+}
+
+void MatchRunner::start() {
+    if (m_openings.isEmpty()) m_openings.append(Board());
+
+    EngineConfig first = m_first;
+    EngineConfig second = m_second;
+    if (m_ponder) {
+        first.setOption("Ponder", "true");
+        second.setOption("Ponder", "true");
+    }
+
+    m_slots.resize(qMin(m_concurrency, m_gameCount));
+    for (size_t i = 0; i < m_slots.size(); ++i) {
+        m_slots[i].first = std::make_unique<Engine>(first);
+        m_slots[i].second = std::make_unique<Engine>(second);
+        m_slots[i].first->start();
+        m_slots[i].second->start();
+        startGame(i);
+    }
+}
+
+void MatchRunner::startGame(int slot) {
+    Slot& current = m_slots[slot];
+    current.round = m_nextRound++;
+
+    // Pairs of games share an opening, the first engine is white in even
+    // rounds.
+    const Board& opening = m_openings[(current.round / 2) % m_openings.size()];
+    bool firstIsWhite = current.round % 2 == 0;
+    Engine* white = firstIsWhite ? current.first.get() : current.second.get();
+    Engine* black = firstIsWhite ? current.second.get() : current.first.get();
+
+    current.game = new MatchGame(white, black, opening, m_timeControl, this);
+    MatchGame* game = current.game;
+    game->setPonder(m_ponder);
+    if (m_book.isOpen())
+        game->setBook(&m_book, m_bookPlies, current.round / 2);
+    QObject::connect(game, &MatchGame::moveMade, this, [this, slot, game]() {
+        emit positionChanged(slot, game->board());
+    });
+    QObject::connect(game, &MatchGame::finished, this,
+                     [this, slot]() { onGameFinished(slot); });
+
+    ++m_running;
+    emit gameStarted(slot, white->config().name(), black->config().name());
+    emit positionChanged(slot, opening);
+    game->start();
+}
+
+void MatchRunner::onGameFinished(int slot) {
+    Slot& current = m_slots[slot];
+    MatchGame* game = current.game;
+    bool firstIsWhite = current.round % 2 == 0;
+    QString white = firstIsWhite ? m_first.name() : m_second.name();
+    QString black = firstIsWhite ? m_second.name() : m_first.name();
+
+    double whiteScore = game->result() == MatchGame::WhiteWins ? 1
+                        : game->result() == MatchGame::Draw    ? 0.5
+                                                               : 0;
+    m_statistics.addResult(firstIsWhite ? whiteScore : 1 - whiteScore);
+
+    if (m_output.isOpen()) {
+        QList<QPair<QString, QString>> tags = {
+            {"Event", "Engine match"},
+            {"Site", "?"},
+            {"Date", QDate::currentDate().toString("yyyy.MM.dd")},
+            {"Round", QString::number(current.round + 1)},
+            {"White", white},
+            {"Black", black},
+            {"TimeControl", m_timeControl.toString()}};
+        m_output.write(game->toPgn(tags).toUtf8());
+        m_output.flush();
+    }
+
+    --m_running;
+    emit gameFinished(current.round, white, black, game->resultString());
+
+    // Game is deleted later, we are inside of its signal.
+    game->deleteLater();
+    current.game = nullptr;
+
+    bool decided = m_statistics.sprtState() != MatchStatistics::Continue;
+    if (!decided && m_nextRound < m_gameCount) {
+        startGame(slot);
+        return;
+    }
+
+    // No more games for this slot, let the engines go.
+    current.first.release()->deleteLater();
+    current.second.release()->deleteLater();
+    if (m_running == 0) emit finished();
+}
@@ -0,0 +1,104 @@
+#ifndef MATCH_RUNNER_HPP
+#define MATCH_RUNNER_HPP
+#include <QFile>
+#include <QObject>
+#include <QVector>
+#include <memory>
+#include <vector>
+
+#include "engine/engine.hpp"
+#include "match/match-game.hpp"
+#include "match/match-statistics.hpp"
+#include "match/time-control.hpp"
+
+/*! \brief Plays a match between two engines, several games at once.
+ *
+ * Every concurrent game has its own pair of engine processes, which are
+ * reused for the following games. Only the side to move searches, so one
+ * game per core saturates the machine with single threaded engines. Every
+ * opening is played twice with reversed colors. Finished games are appended
+ * to the PGN file in the order they end, with the Round tag giving their
+ * order in the schedule. An opening book extends the openings, both games of
+ * a pair follow the same book line.
+ */
+class MatchRunner : public QObject {
+    Q_OBJECT
+public:
+    MatchRunner(const EngineConfig& first, const EngineConfig& second,
+                const TimeControl& timeControl, QObject* parent = nullptr);
+    ~MatchRunner();
+
+    /*! \brief Adds opening position given as FEN or EPD line.
+     * \returns false if the position is invalid
+     */
+    bool addOpening(const QString& line);
+
+    /*! \brief Sets total number of games */
+    void setGameCount(int count);
+    int gameCount() const { return m_gameCount; }
+
+    /*! \brief Sets number of games played at once, defaults to number of
+     * cores */
+    void setConcurrency(int count);
+    int concurrency() const { return m_concurrency; }
+
+    /*! \brief Opens PGN file the games are appended to.
+     * \returns false if the file cannot be opened
+     */
+    bool setOutput(const QString& path);
+
+    /*! \brief Lets engines think on the opponent's time, sets their
+     * "Ponder" option. Both engines of a game search at once then, so play
+     * half as many games at once as there are cores. */
+    void setPonder(bool enabled) { m_ponder = enabled; }
+
+    /*! \brief Opens Polyglot book the games start with, at most
+     * \a maxPlies plies of it are played.
+     * \returns false if the book cannot be opened
+     */
+    bool setBook(const QString& path, int maxPlies);
+
+    /*! \brief Stops the match early once SPRT accepts either hypothesis */
+    void setSprt(double elo0, double elo1, double alpha = 0.05,
+                 double beta = 0.05);
+
+    /*! \brief Starts the match */
+    void start();
+
+    const MatchStatistics& statistics() const { return m_statistics; }
+signals:
+    void gameStarted(int slot, QString white, QString black);
+    void positionChanged(int slot, Board board);
+    void gameFinished(int round, QString white, QString black,
+                      QString result);
+    void finished();
+
+private:
+    struct Slot {
+        std::unique_ptr<Engine> first;
+        std::unique_ptr<Engine> second;
+        MatchGame* game = nullptr;
+        int round = 0;
+    };
+
+    void startGame(int slot);
+    void onGameFinished(int slot);
+
+    EngineConfig m_first;
+    EngineConfig m_second;
+    TimeControl m_timeControl;
+    QVector<Board> m_openings;
+    int m_gameCount;
+    int m_concurrency;
+    std::vector<Slot> m_slots;
+    /*!< Index of the next game to start */
+    int m_nextRound;
+    int m_running;
+    bool m_ponder;
+    PolyglotBook m_book;
+    int m_bookPlies;
+    MatchStatistics m_statistics;
+    QFile m_output;
+};
+
+#endif  // MATCH_RUNNER_HPP
@@ -0,0 +1,116 @@
+#include "match/match-statistics.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+MatchStatistics::MatchStatistics()
+    : m_wins(0),
+      m_draws(0),
+      m_losses(0),
+      m_sprt(false),
+      m_elo0(0),
+      m_elo1(5),
+      m_alpha(0.05),
+      m_beta(0.05) {}
+
+void MatchStatistics::addResult(double score) {
+    if (score > 0.75)
+        ++m_wins;
+    else if (score < 0.25)
+        ++m_losses;
+    else
+        ++m_draws;
+}
+
+double MatchStatistics::score() const {
+    if (!games()) return 0.5;
+    return (m_wins + 0.5 * m_draws) / games();
+}
+
+double MatchStatistics::variance() const {
+    if (!games()) return 0;
+
+    double s = score();
+    double n = games();
+    return (m_wins * (1 - s) * (1 - s) + m_draws * (0.5 - s) * (0.5 - s) +
+            m_losses * s * s) /
+           n;
+}
+
+double MatchStatistics::scoreToElo(double score) {
+    // Perfect scores have infinite difference, keep it finite.
+    score = std::clamp(score, 1e-3, 1 - 1e-3);
+    return -400 * std::log10(1 / score - 1);
+}
+
+double MatchStatistics::eloToScore(double elo) {
+    return 1 / (1 + std::pow(10, -elo / 400));
+}
+
+double MatchStatistics::eloDifference() const { return scoreToElo(score()); }
+
+double MatchStatistics::eloError() const {
+    if (games() < 2) return 0;
+
+    double deviation = std::sqrt(variance() / games());
+    double low = scoreToElo(score() - 1.959964 * deviation);
+    double high = scoreToElo(score() + 1.959964 * deviation);
+    return (high - low) / 2;
+}
+
+void MatchStatistics::setSprt(double elo0, double elo1, double alpha,
+                              double beta) {
+    m_sprt = true;
+    m_elo0 = elo0;
+    m_elo1 = elo1;
+    m_alpha = alpha;
+    m_beta = beta;
+}
+
+double MatchStatistics::llr() const {
+    double var = variance();
+    if (var <= 0) return 0;
+
+    double s0 = eloToScore(m_elo0);
+    double s1 = eloToScore(m_elo1);
+    return games() * (s1 - s0) * (2 * score() - s0 - s1) / (2 * var);
+}
+
+double MatchStatistics::lowerBound() const {
+    return std::log(m_beta / (1 - m_alpha));
+}
+
+double MatchStatistics::upperBound() const {
+    return std::log((1 - m_beta) / m_alpha);
+}
+
+MatchStatistics::SprtState MatchStatistics::sprtState() const {
+    if (!m_sprt) return Continue;
+
+    double ratio = llr();
+    if (ratio >= upperBound()) return AcceptH1;
+    if (ratio <= lowerBound()) return AcceptH0;
+    return Continue;
+}
+
+QString MatchStatistics::toString() const {
+    QString summary =
+        QString("Games: %1, +%2 =%3 -%4, score %5%, Elo %6 +/- %7")
+            .arg(games())
+            .arg(m_wins)
+            .arg(m_draws)
+            .arg(m_losses)
+            .arg(100 * score(), 0, 'f', 1)
+            .arg(eloDifference(), 0, 'f', 1)
+            .arg(eloError(), 0, 'f', 1);
+    if (m_sprt) {
+        static const char* states[] = {"continue", "H0 accepted",
+                                       "H1 accepted"};
+        summary += QString(", LLR %1 (%2, %3) %4")
+                       .arg(llr(), 0, 'f', 2)
+                       .arg(lowerBound(), 0, 'f', 2)
+                       .arg(upperBound(), 0, 'f', 2)
+                       .arg(states[sprtState()]);
+    }
+    return summary;
+}
@@ -0,0 +1,69 @@
+#ifndef MATCH_STATISTICS_HPP
+#define MATCH_STATISTICS_HPP
+#include <QString>
+
+/*! \brief Results of a match from the point of view of the first engine.
+ *
+ * Elo difference comes with a 95% confidence interval. The sequential
+ * probability ratio test decides between H0: elo = elo0 and H1: elo = elo1
+ * using the normal approximation of the score distribution.
+ */
+class MatchStatistics {
+public:
+    enum SprtState { Continue, AcceptH0, AcceptH1 };
+
+    MatchStatistics();
+
+    /*! \brief Adds game result, 1 for a win, 0.5 for a draw, 0 for a loss */
+    void addResult(double score);
+
+    int wins() const { return m_wins; }
+    int draws() const { return m_draws; }
+    int losses() const { return m_losses; }
+    int games() const { return m_wins + m_draws + m_losses; }
+
+    /*! \brief Returns average score per game */
+    double score() const;
+
+    /*! \brief Returns estimated Elo difference */
+    double eloDifference() const;
+
+    /*! \brief Returns half width of 95% confidence interval of the Elo
+     * difference */
+    double eloError() const;
+
+    /*! \brief Enables SPRT with the given hypotheses and error rates */
+    void setSprt(double elo0, double elo1, double alpha = 0.05,
+                 double beta = 0.05);
+    bool hasSprt() const { return m_sprt; }
+
+    /*! \brief Returns log-likelihood ratio of H1 against H0 */
+    double llr() const;
+    double lowerBound() const;
+    double upperBound() const;
+    SprtState sprtState() const;
+
+    /*! \brief Returns one line summary */
+    QString toString() const;
+
+    /*! \brief Converts expected score to Elo difference */
+    static double scoreToElo(double score);
+
+    /*! \brief Converts Elo difference to expected score */
+    static double eloToScore(double elo);
+
+private:
+    /*! \brief Returns variance of a single game score */
+    double variance() const;
+
+    int m_wins;
+    int m_draws;
+    int m_losses;
+    bool m_sprt;
+    double m_elo0;
+    double m_elo1;
+    double m_alpha;
+    double m_beta;
+};
+
+#endif  // MATCH_STATISTICS_HPP
@@ -0,0 +1,28 @@
+#include "match/time-control.hpp"
+
+#include <QStringList>
+#include <cmath>
+
+TimeControl::TimeControl(qint64 baseMs, qint64 incrementMs)
+    : m_base(baseMs), m_increment(incrementMs) {}
+
+bool TimeControl::fromString(const QString& string) {
+    QStringList parts = string.split('+');
+    if (parts.size() > 2) return false;
+
+    bool baseOk = true;
+    bool incrementOk = true;
+    double base = parts[0].toDouble(&baseOk);
+    double increment = parts.size() == 2 ? parts[1].toDouble(&incrementOk) : 0;
+    if (!baseOk || !incrementOk || base <= 0 || increment < 0) return false;
+
+    m_base = std::llround(base * 1000);
+    m_increment = std::llround(increment * 1000);
+    return true;
+}
+
+QString TimeControl::toString() const {
+    QString string = QString::number(m_base / 1000.0);
+    if (m_increment) string += "+" + QString::number(m_increment / 1000.0);
+    return string;
+}
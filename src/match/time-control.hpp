@@ -0,0 +1,29 @@
+#ifndef TIME_CONTROL_HPP
+#define TIME_CONTROL_HPP
+#include <QString>
+
+/*! \brief Sudden death time control with an increment per move. */
+class TimeControl {
+public:
+    TimeControl(qint64 baseMs = 60000, qint64 incrementMs = 0);
+
+    /*! \brief Parses time control in PGN notation, e.g. "60+0.6", in
+     * seconds.
+     * \returns false if the string is not a valid time control
+     */
+    bool fromString(const QString& string);
+
+    /*! \brief Returns time control in PGN notation */
+    QString toString() const;
+
+    qint64 base() const { return m_base; }
+    qint64 increment() const { return m_increment; }
+
+private:
+    /*!< Initial clock time in milliseconds */
+    qint64 m_base;
+    /*!< Time added after every move in milliseconds */
+    qint64 m_increment;
+};
+
+#endif  // TIME_CONTROL_HPP
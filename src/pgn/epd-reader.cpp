@@ -0,0 +1,116 @@
+#include "pgn/epd-reader.hpp"
+
+#include <QPair>
+#include <QStringList>
+
+#include "pgn/pgn-reader.hpp"
+
+namespace {
+
+/*! \brief Word or quoted string of the operations, or their terminator */
+struct Token {
+    QString text;
+    bool semicolon;
+};
+
+bool isNumber(const Token& token) {
+    bool ok = false;
+    if (!token.semicolon) token.text.toInt(&ok);
+    return ok;
+}
+
+}  // namespace
+
+bool EpdReader::parse(const QString& line, EpdRecord& record,
+                      QString* error) {
+    auto fail = [error](const QString& reason) {
+        if (error) *error = reason;
+        return false;
+    };
+    record = EpdRecord();
+
+    // Placement, side to move, castling and en passant.
+    QStringList fields;
+    int i = 0;
+    while (fields.size() < 4) {
+        while (i < line.size() && line[i].isSpace()) ++i;
+        int start = i;
+        while (i < line.size() && !line[i].isSpace()) ++i;
+        if (start == i) return fail("Missing position fields");
+        fields.append(line.mid(start, i - start));
+    }
+
+    QVector<Token> tokens;
+    while (i < line.size()) {
+        QChar c = line[i];
+        if (c.isSpace()) {
+            ++i;
+        } else if (c == ';') {
+            tokens.append({QString(), true});
+            ++i;
+        } else if (c == '"') {
+            // Strings may hold spaces and semicolons.
+            int close = line.indexOf('"', i + 1);
+            if (close < 0) return fail("Unterminated string");
+            tokens.append({line.mid(i + 1, close - i - 1), false});
+            i = close + 1;
+        } else {
+            int start = i;
+            while (i < line.size() && !line[i].isSpace() && line[i] != ';')
+                ++i;
+            tokens.append({line.mid(start, i - start), false});
+        }
+    }
+
+    QString halfMoves = "0";
+    QString fullMoves = "1";
+    int next = 0;
+    if (tokens.size() >= 2 && isNumber(tokens[0]) && isNumber(tokens[1])) {
+        halfMoves = tokens[0].text;
+        fullMoves = tokens[1].text;
+        next = 2;
+    }
+
+    QVector<QPair<QString, QStringList>> operations;
+    while (next < tokens.size()) {
+        if (tokens[next].semicolon) {
+            ++next;
+            continue;
+        }
+        QString opcode = tokens[next++].text;
+        QStringList operands;
+        while (next < tokens.size() && !tokens[next].semicolon)
+            operands.append(tokens[next++].text);
+
+        if (opcode == "hmvc" && !operands.isEmpty())
+            halfMoves = operands.first();
+        else if (opcode == "fmvn" && !operands.isEmpty())
+            fullMoves = operands.first();
+        operations.append({opcode, operands});
+    }
+
+    if (!record.board.setFen(fields.join(' ') + ' ' + halfMoves + ' ' +
+                             fullMoves))
+        return fail("Invalid position");
+
+    for (const auto& operation : operations) {
+        if (operation.first == "id") {
+            record.id = operation.second.join(' ');
+            continue;
+        }
+        if (operation.first != "bm" && operation.first != "am") continue;
+
+        QVector<Move>& moves = operation.first == "bm" ? record.bestMoves
+                                                       : record.avoidMoves;
+        for (const QString& operand : operation.second) {
+            QByteArray san = operand.toLatin1();
+            Move move;
+            if (!PgnReader::parseSan(san.constData(),
+                                     san.constData() + san.size(),
+                                     record.board, move))
+                return fail(QString("Invalid move %1").arg(operand));
+            moves.append(move);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,43 @@
+#ifndef EPD_READER_HPP
+#define EPD_READER_HPP
+#include <QString>
+#include <QVector>
+
+#include "game/board.hpp"
+
+/*! \brief Position of an EPD record with the operations used by test
+ * suites */
+struct EpdRecord {
+    Board board;
+    /*!< Operand of "id", empty if there is none */
+    QString id;
+    /*!< Operands of "bm", any of them solves the position */
+    QVector<Move> bestMoves;
+    /*!< Operands of "am", none of them may be played */
+    QVector<Move> avoidMoves;
+};
+
+/*! \brief Parser of Extended Position Description lines.
+ *
+ * A record is the first four FEN fields followed by operations, each an
+ * opcode, its operands and a semicolon, e.g.
+ *
+ *     r1b1kb1r/pp3ppp/... w kq - bm Qxf7+; id "WAC.004";
+ *
+ * Move counters come from the "hmvc" and "fmvn" operations. A full FEN with
+ * counters is accepted too, as many files carry them. Moves of "bm" and
+ * "am" are SAN. Other operations are skipped.
+ */
+class EpdReader {
+public:
+    EpdReader() = delete;
+
+    /*! \brief Parses single EPD line into \a record.
+     * \returns false if the position or a bm or am move is invalid,
+     * \a error then tells why
+     */
+    static bool parse(const QString& line, EpdRecord& record,
+                      QString* error = nullptr);
+};
+
+#endif  // EPD_READER_HPP
@@ -0,0 +1,165 @@
+#include "pgn/pgn-importer.hpp"
+
+#include <QFile>
+#include <QThread>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "pgn/pgn-reader.hpp"
+
+namespace {
+
+struct Chunk {
+    const char* begin;
+    const char* end;
+    std::vector<std::unique_ptr<Tree>> games;
+    std::vector<PgnImporter::Key> keys;
+    qint64 skipped = 0;
+    qint64 errorGame = 0;
+    QString error;
+    bool done = false;
+};
+
+/*! \brief Returns start of the first line beginning with "[Event " at or
+ * after \a from, or \a end if there is none */
+const char* nextGame(const char* from, const char* end) {
+    static const char tag[] = "\n[Event ";
+    const size_t length = sizeof(tag) - 1;
+
+    // Newline may be the byte right before the given position.
+    for (const char* p = from - 1; p < end;) {
+        p = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!p) break;
+        if (static_cast<size_t>(end - p) >= length &&
+            std::memcmp(p, tag, length) == 0)
+            return p + 1;
+        ++p;
+    }
+    return end;
+}
+
+}  // namespace
+
+PgnImporter::PgnImporter(const QString& path)
+    : m_path(path),
+      m_threadCount(QThread::idealThreadCount()),
+      m_gameCount(0),
+      m_skippedCount(0),
+      m_position(0) {}
+
+void PgnImporter::setThreadCount(int count) {
+    m_threadCount = qMax(1, count);
+}
+
+bool PgnImporter::run(const Consumer& consumer) {
+    return run(KeyFunction(), [&consumer](std::unique_ptr<Tree> game,
+                                          const Key&) {
+        consumer(std::move(game));
+    });
+}
+
+bool PgnImporter::run(const KeyFunction& key, const KeyedConsumer& consumer) {
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_lastError = file.errorString();
+        return false;
+    }
+    qint64 size = file.size();
+    if (size == 0) return true;
+
+    uchar* memory = file.map(0, size);
+    if (!memory) {
+        m_lastError = file.errorString();
+        return false;
+    }
+    const char* data = reinterpret_cast<const char*>(memory);
+    const char* end = data + size;
+
+    std::vector<Chunk> chunks;
+    for (const char* begin = data; begin < end;) {
+        const char* split =
+            end - begin > ChunkSize ? nextGame(begin + ChunkSize, end) : end;
+        chunks.emplace_back();
+        chunks.back().begin = begin;
+        chunks.back().end = split;
+        begin = split;
+    }
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    size_t next = 0;
+    size_t merged = 0;
+    const size_t window = 2 * m_threadCount;
+
+    auto work = [&]() {
+        for (;;) {
+            size_t index;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                // Do not run too far ahead of the consumer.
+                changed.wait(lock, [&]() {
+                    return next >= chunks.size() || next < merged + window;
+                });
+                if (next >= chunks.size()) return;
+                index = next++;
+            }
+
+            Chunk& chunk = chunks[index];
+            PgnReader reader(chunk.begin, chunk.end);
+            while (std::unique_ptr<Tree> game = reader.readGame()) {
+                if (key) chunk.keys.push_back(key(*game));
+                chunk.games.push_back(std::move(game));
+            }
+            chunk.skipped = reader.skippedCount();
+            chunk.errorGame = reader.lastErrorGame();
+            chunk.error = reader.lastError();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                chunk.done = true;
+            }
+            changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < m_threadCount; ++i) threads.emplace_back(work);
+
+    while (merged < chunks.size()) {
+        Chunk& chunk = chunks[merged];
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return chunk.done; });
+        }
+
+        if (!chunk.error.isEmpty()) {
+            // Game numbers of the reader count from the chunk start.
+            m_lastError = QString("Game %1: %2")
+                              .arg(m_gameCount + m_skippedCount +
+                                   chunk.errorGame)
+                              .arg(chunk.error);
+        }
+        m_skippedCount += chunk.skipped;
+        m_position = chunk.end - data;
+        for (size_t i = 0; i < chunk.games.size(); ++i) {
+            ++m_gameCount;
+            consumer(std::move(chunk.games[i]),
+                     key ? chunk.keys[i] : Key());
+        }
+        std::vector<std::unique_ptr<Tree>>().swap(chunk.games);
+        std::vector<Key>().swap(chunk.keys);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++merged;
+        }
+        changed.notify_all();
+    }
+
+    for (std::thread& thread : threads) thread.join();
+    file.unmap(memory);
+    return true;
+}
@@ -0,0 +1,69 @@
+#ifndef PGN_IMPORTER_HPP
+#define PGN_IMPORTER_HPP
+#include <QString>
+#include <array>
+#include <functional>
+#include <memory>
+
+#include "game/tree.hpp"
+
+/*! \brief Imports a PGN file on all cores.
+ *
+ * The file is memory mapped and cut into chunks of about ChunkSize bytes,
+ * each ending right before a line starting with "[Event ". Worker threads
+ * parse the chunks with PgnReader, the games are handed over in the order of
+ * the file. Chunk boundaries depend on the file only, so the result is the
+ * same for any number of threads. Only a few chunks per thread are parsed
+ * ahead of the consumer, which bounds memory use.
+ */
+class PgnImporter {
+public:
+    typedef std::function<void(std::unique_ptr<Tree>)> Consumer;
+    /*! \brief Key of a game, e.g. its hashes */
+    typedef std::array<quint64, 2> Key;
+    /*! \brief Computes key of a game, called on the parsing threads */
+    typedef std::function<Key(const Tree&)> KeyFunction;
+    typedef std::function<void(std::unique_ptr<Tree>, const Key&)>
+        KeyedConsumer;
+
+    enum { ChunkSize = 1 << 20 };
+
+    explicit PgnImporter(const QString& path);
+
+    /*! \brief Sets number of parsing threads, defaults to number of cores */
+    void setThreadCount(int count);
+    int threadCount() const { return m_threadCount; }
+
+    /*! \brief Imports every game, \a consumer is called on the calling
+     * thread in the order of the file.
+     * \returns false if the file cannot be read
+     */
+    bool run(const Consumer& consumer);
+
+    /*! \brief Imports every game like run(), \a key of each game is
+     * computed on the parsing threads and handed over with the game */
+    bool run(const KeyFunction& key, const KeyedConsumer& consumer);
+
+    /*! \brief Returns number of games handed over so far */
+    qint64 gameCount() const { return m_gameCount; }
+
+    /*! \brief Returns number of skipped invalid games */
+    qint64 skippedCount() const { return m_skippedCount; }
+
+    /*! \brief Returns bytes parsed up to the game handed over last */
+    qint64 position() const { return m_position; }
+
+    /*! \brief Returns reason of the last skipped game or of the failure of
+     * run(), with the game number */
+    const QString& lastError() const { return m_lastError; }
+
+private:
+    QString m_path;
+    int m_threadCount;
+    qint64 m_gameCount;
+    qint64 m_skippedCount;
+    qint64 m_position;
+    QString m_lastError;
+};
+
+#endif  // PGN_IMPORTER_HPP
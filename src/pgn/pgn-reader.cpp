@@ -0,0 +1,397 @@
+#include "pgn/pgn-reader.hpp"
+
+#include <cstring>
+
+/*! \brief Tests whether \a c may be a part of a move, move number or result
+ */
+static inline bool isSymbolChar(int c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           (c >= '0' && c <= '9') || c == '_' || c == '+' || c == '#' ||
+           c == '=' || c == ':' || c == '-' || c == '/';
+}
+
+static inline bool isWhitespace(int c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f' ||
+           c == '\v';
+}
+
+static bool equals(const char* begin, const char* end, const char* literal) {
+    for (; begin != end; ++begin, ++literal)
+        if (*literal == '\0' || *begin != *literal) return false;
+    return *literal == '\0';
+}
+
+/*! \brief Returns piece of a promotion or of a SAN move, None if \a c is no
+ * piece */
+static Piece::Type pieceType(char c) {
+    switch (c) {
+        case 'N':
+        case 'n':
+            return Piece::Type::Knight;
+        case 'B':
+        case 'b':
+            return Piece::Type::Bishop;
+        case 'R':
+        case 'r':
+            return Piece::Type::Rook;
+        case 'Q':
+        case 'q':
+            return Piece::Type::Queen;
+        case 'K':
+        case 'k':
+            return Piece::Type::King;
+        default:
+            return Piece::Type::None;
+    }
+}
+
+PgnReader::PgnReader(QIODevice* device)
+    : m_device(device),
+      m_buffer(BufferSize, '\0'),
+      m_base(m_buffer.constData()),
+      m_pos(m_base),
+      m_end(m_base),
+      m_consumed(0),
+      m_tokenLength(0),
+      m_gameCount(0),
+      m_skippedCount(0),
+      m_lastErrorGame(0) {}
+
+PgnReader::PgnReader(const char* begin, const char* end)
+    : m_device(nullptr),
+      m_base(begin),
+      m_pos(begin),
+      m_end(end),
+      m_consumed(0),
+      m_tokenLength(0),
+      m_gameCount(0),
+      m_skippedCount(0),
+      m_lastErrorGame(0) {}
+
+std::unique_ptr<Tree> PgnReader::readGame() {
+    for (;;) {
+        skipWhitespace();
+        int c = peek();
+        if (c < 0) return nullptr;
+        // UTF-8 byte order mark.
+        if (c == 0xEF && position() == 0) {
+            for (int i = 0; i < 3; ++i) get();
+            continue;
+        }
+        // Escaped line, e.g. "%" followed by a program specific directive.
+        if (c == '%') {
+            readText('\n');
+            continue;
+        }
+
+        auto game = std::make_unique<Tree>();
+        bool valid = true;
+        while (valid && peek() == '[') {
+            valid = readTag(*game);
+            skipWhitespace();
+        }
+
+        // Tree takes its starting position at construction.
+        Board start;
+        QString fen = game->tag("FEN");
+        if (valid && !fen.isEmpty()) {
+            if (start.setFen(fen)) {
+                auto setUp = std::make_unique<Tree>(start);
+                for (const auto& tag : game->tags())
+                    setUp->setTag(tag.first, tag.second);
+                game = std::move(setUp);
+            } else
+                valid = fail("Invalid FEN: " + fen);
+        }
+
+        if (valid && readMoveText(*game, start)) {
+            ++m_gameCount;
+            return game;
+        }
+        ++m_skippedCount;
+        skipGame();
+    }
+}
+
+bool PgnReader::parseSan(const char* begin, const char* end,
+                         const Board& board, Move& move) {
+    // Check, mate and annotation marks carry no information.
+    while (end > begin && (end[-1] == '+' || end[-1] == '#' ||
+                           end[-1] == '!' || end[-1] == '?'))
+        --end;
+    if (end - begin < 2) return false;
+
+    Player player = board.currentPlayer();
+    int homeRank = player.isWhite() ? 7 : 0;
+
+    // Castling, written with letter O or digit zero.
+    if (*begin == 'O' || *begin == '0') {
+        int castles = 0;
+        for (const char* c = begin; c != end; ++c) {
+            if (*c == 'O' || *c == '0')
+                ++castles;
+            else if (*c != '-')
+                return false;
+        }
+        if (castles != 2 && castles != 3) return false;
+
+        move = Move(Coord2D<int>(4, homeRank),
+                    Coord2D<int>(castles == 2 ? 6 : 2, homeRank));
+        return board.pieceAt(4, homeRank).isKing() &&
+               board.owner(4, homeRank) == player && board.isLegal(move);
+    }
+
+    Piece::Type type = Piece::Type::Pawn;
+    if (*begin >= 'A' && *begin <= 'Z') {
+        type = *begin == 'P' ? Piece::Type::Pawn : pieceType(*begin);
+        if (type == Piece::Type::None) return false;
+        ++begin;
+    }
+
+    // Promotion, "e8=Q" or "e8Q".
+    Piece::Type promotion = Piece::Type::None;
+    if (end - begin >= 3 && end[-2] == '=') {
+        promotion = pieceType(end[-1]);
+        if (promotion == Piece::Type::None) return false;
+        end -= 2;
+    } else if (end - begin >= 3 && end[-2] >= '1' && end[-2] <= '8' &&
+               pieceType(end[-1]) != Piece::Type::None) {
+        promotion = pieceType(end[-1]);
+        --end;
+    }
+    if (promotion == Piece::Type::King ||
+        (promotion != Piece::Type::None && type != Piece::Type::Pawn))
+        return false;
+
+    // Destination square.
+    if (end - begin < 2 || end[-2] < 'a' || end[-2] > 'h' || end[-1] < '1' ||
+        end[-1] > '8')
+        return false;
+    Coord2D<int> to(end[-2] - 'a', '8' - end[-1]);
+    end -= 2;
+
+    // Whatever is left disambiguates the origin, or is the full origin of
+    // a move in long algebraic notation.
+    int fromFile = -1;
+    int fromRank = -1;
+    for (const char* c = begin; c != end; ++c) {
+        if (*c >= 'a' && *c <= 'h')
+            fromFile = *c - 'a';
+        else if (*c >= '1' && *c <= '8')
+            fromRank = '8' - *c;
+        else if (*c != 'x' && *c != ':' && *c != '-')
+            return false;
+    }
+
+    // Some writers omit the piece of a promotion to a queen.
+    if (type == Piece::Type::Pawn && promotion == Piece::Type::None &&
+        to.y == (player.isWhite() ? 0 : 7))
+        promotion = Piece::Type::Queen;
+
+    int found = 0;
+    for (int y = fromRank < 0 ? 0 : fromRank; y < 8; ++y) {
+        for (int x = fromFile < 0 ? 0 : fromFile; x < 8; ++x) {
+            const Piece& piece = board.pieceAt(x, y);
+            if (piece.type() == type && piece.owner() == player) {
+                Move candidate(Coord2D<int>(x, y), to, promotion);
+                if (board.isLegal(candidate)) {
+                    // Ambiguous move.
+                    if (++found > 1) return false;
+                    move = candidate;
+                }
+            }
+            if (fromFile >= 0) break;
+        }
+        if (fromRank >= 0) break;
+    }
+    return found == 1;
+}
+
+bool PgnReader::fill() {
+    if (!m_device) return false;
+
+    m_consumed += m_end - m_base;
+    qint64 length = m_device->read(m_buffer.data(), m_buffer.size());
+    m_base = m_buffer.constData();
+    m_pos = m_base;
+    m_end = m_base + qMax<qint64>(0, length);
+    return length > 0;
+}
+
+void PgnReader::skipWhitespace() {
+    while (isWhitespace(peek())) ++m_pos;
+}
+
+void PgnReader::readSymbol() {
+    m_tokenLength = 0;
+    for (int c = peek(); isSymbolChar(c); c = peek()) {
+        // Overlong tokens are truncated, no move is that long anyway.
+        if (m_tokenLength < MaxTokenLength) m_token[m_tokenLength++] = c;
+        ++m_pos;
+    }
+    m_token[m_tokenLength] = '\0';
+}
+
+bool PgnReader::readText(char terminator) {
+    m_text.clear();
+    for (;;) {
+        // Copy whole runs of the buffer at once.
+        if (m_pos == m_end && !fill()) return false;
+        const char* stop = static_cast<const char*>(
+            std::memchr(m_pos, terminator, m_end - m_pos));
+        if (stop) {
+            m_text.append(m_pos, stop - m_pos);
+            m_pos = stop + 1;
+            return true;
+        }
+        m_text.append(m_pos, m_end - m_pos);
+        m_pos = m_end;
+    }
+}
+
+bool PgnReader::readTag(Tree& tree) {
+    // [Name "Value"]
+    ++m_pos;
+    skipWhitespace();
+    readSymbol();
+    if (m_tokenLength == 0) return fail("Tag without a name");
+    QString name = QString::fromLatin1(m_token, m_tokenLength);
+
+    skipWhitespace();
+    if (get() != '"') return fail("Tag " + name + " without a value");
+    m_text.clear();
+    for (int c = get(); c != '"'; c = get()) {
+        if (c == '\\') c = get();
+        if (c < 0 || c == '\n') return fail("Unterminated tag " + name);
+        m_text.append(static_cast<char>(c));
+    }
+    tree.setTag(name, QString::fromUtf8(m_text));
+
+    if (!readText(']')) return fail("Unterminated tag " + name);
+    return true;
+}
+
+bool PgnReader::readMoveText(Tree& tree, const Board& start) {
+    Board board = start;
+    // Position before the last move, a variation replaces that move.
+    Board previous = start;
+    bool hasMove = false;
+    m_frames.clear();
+
+    for (;;) {
+        skipWhitespace();
+        int c = peek();
+
+        switch (c) {
+            case -1:
+            case '[':
+                // Result is missing, the game ends anyway.
+                return m_frames.empty() || fail("Unterminated variation");
+            case '*':
+                ++m_pos;
+                return m_frames.empty() || fail("Unterminated variation");
+            case '{':
+                ++m_pos;
+                if (!readText('}')) return fail("Unterminated comment");
+                appendComment(tree);
+                continue;
+            case ';':
+                ++m_pos;
+                readText('\n');
+                appendComment(tree);
+                continue;
+            case '%':
+                readText('\n');
+                continue;
+            case '.':
+                ++m_pos;
+                continue;
+            case '(':
+                ++m_pos;
+                if (!hasMove) return fail("Variation without a move");
+                m_frames.push_back({tree.currentNode(), board, previous});
+                tree.back();
+                board = previous;
+                hasMove = false;
+                continue;
+            case ')':
+                ++m_pos;
+                if (m_frames.empty()) return fail("Unmatched ')'");
+                tree.setCurrent(const_cast<TreeNode*>(m_frames.back().node));
+                board = std::move(m_frames.back().board);
+                previous = std::move(m_frames.back().previous);
+                m_frames.pop_back();
+                hasMove = true;
+                continue;
+            case '$': {
+                ++m_pos;
+                readSymbol();
+                int nag = QByteArray::fromRawData(m_token, m_tokenLength)
+                              .toInt();
+                if (nag > 0) tree.addNag(nag);
+                continue;
+            }
+            case '!':
+            case '?': {
+                // Suffix annotations: ! ? !! ?? !? ?!
+                char first = get();
+                char second = peek() == '!' || peek() == '?' ? get() : '\0';
+                int nag = second == '\0' ? (first == '!' ? 1 : 2)
+                          : first == second ? (first == '!' ? 3 : 4)
+                                            : (first == '!' ? 5 : 6);
+                if (hasMove) tree.addNag(nag);
+                continue;
+            }
+            default:
+                break;
+        }
+
+        if (!isSymbolChar(c))
+            return fail(QString("Unexpected character '%1'").arg(QChar(c)));
+
+        readSymbol();
+        const char* token = m_token;
+        const char* end = m_token + m_tokenLength;
+
+        if (equals(token, end, "1-0") || equals(token, end, "0-1") ||
+            equals(token, end, "1/2-1/2"))
+            return m_frames.empty() || fail("Unterminated variation");
+
+        // Move number, the dots are skipped on their own.
+        if (token[0] >= '0' && token[0] <= '9') {
+            const char* digit = token;
+            while (digit != end && *digit >= '0' && *digit <= '9') ++digit;
+            if (digit == end) continue;
+        }
+
+        Move move;
+        if (!parseSan(token, end, board, move))
+            return fail("Illegal move " + QString::fromLatin1(token));
+
+        previous = board;
+        board.makeMove(move);
+        tree.addMove(move);
+        hasMove = true;
+    }
+}
+
+void PgnReader::appendComment(Tree& tree) {
+    QString comment = QString::fromUtf8(m_text).trimmed();
+    if (comment.isEmpty()) return;
+
+    const QString& current = tree.currentNode()->comment();
+    tree.setComment(current.isEmpty() ? comment : current + ' ' + comment);
+}
+
+void PgnReader::skipGame() {
+    // Next game starts with a tag at the beginning of a line.
+    if (peek() == '[') return;
+    for (int c = get(); c >= 0; c = get())
+        if (c == '\n' && peek() == '[') return;
+}
+
+bool PgnReader::fail(const QString& reason) {
+    m_lastError = reason;
+    m_lastErrorGame = m_gameCount + m_skippedCount + 1;
+    return false;
+}
@@ -0,0 +1,112 @@
+#ifndef PGN_READER_HPP
+#define PGN_READER_HPP
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+#include <memory>
+#include <vector>
+
+#include "game/board.hpp"
+#include "game/tree.hpp"
+
+/*! \brief Streaming reader of PGN files.
+ *
+ * Games are parsed straight from a fixed size buffer into a Tree, tags,
+ * variations, comments and NAGs included, so files of any size are read in
+ * constant memory. SAN moves are resolved against the position without
+ * building a string per token. Games with an illegal move or broken syntax
+ * are skipped, reading goes on with the next game.
+ */
+class PgnReader {
+public:
+    /*! \brief Reads games from \a device, which has to be open */
+    explicit PgnReader(QIODevice* device);
+
+    /*! \brief Reads games from memory, which has to outlive the reader */
+    PgnReader(const char* begin, const char* end);
+
+    /*! \brief Reads next game.
+     * \returns nullptr at the end of input
+     */
+    std::unique_ptr<Tree> readGame();
+
+    /*! \brief Returns number of games read so far */
+    qint64 gameCount() const { return m_gameCount; }
+
+    /*! \brief Returns number of skipped invalid games */
+    qint64 skippedCount() const { return m_skippedCount; }
+
+    /*! \brief Returns reason the last invalid game was skipped for */
+    const QString& lastError() const { return m_lastError; }
+
+    /*! \brief Returns number of the last invalid game in the input, counting
+     * from 1 */
+    qint64 lastErrorGame() const { return m_lastErrorGame; }
+
+    /*! \brief Returns number of bytes consumed so far */
+    qint64 position() const { return m_consumed + (m_pos - m_base); }
+
+    /*! \brief Resolves SAN, long algebraic notation is accepted too.
+     * \returns false if the move is invalid or ambiguous in \a board
+     */
+    static bool parseSan(const char* begin, const char* end,
+                         const Board& board, Move& move);
+
+private:
+    /*! \brief Unfinished line while a variation is read */
+    struct Frame {
+        const TreeNode* node;
+        Board board;
+        Board previous;
+    };
+
+    enum { BufferSize = 1 << 20, MaxTokenLength = 255 };
+
+    /*! \brief Refills the buffer.
+     * \returns false at the end of input
+     */
+    bool fill();
+
+    int peek() {
+        if (m_pos == m_end && !fill()) return -1;
+        return static_cast<unsigned char>(*m_pos);
+    }
+
+    int get() {
+        int c = peek();
+        if (c >= 0) ++m_pos;
+        return c;
+    }
+
+    void skipWhitespace();
+    /*! \brief Reads symbol token into m_token */
+    void readSymbol();
+    /*! \brief Reads text up to \a terminator into m_text */
+    bool readText(char terminator);
+    bool readTag(Tree& tree);
+    bool readMoveText(Tree& tree, const Board& start);
+    /*! \brief Adds m_text to the comment of the current node */
+    void appendComment(Tree& tree);
+    /*! \brief Skips the rest of a broken game */
+    void skipGame();
+    bool fail(const QString& reason);
+
+    QIODevice* m_device;
+    QByteArray m_buffer;
+    /*!< Start of the data the reader walks through */
+    const char* m_base;
+    const char* m_pos;
+    const char* m_end;
+    /*!< Bytes consumed before the buffer was last refilled */
+    qint64 m_consumed;
+    char m_token[MaxTokenLength + 1];
+    int m_tokenLength;
+    QByteArray m_text;
+    std::vector<Frame> m_frames;
+    qint64 m_gameCount;
+    qint64 m_skippedCount;
+    QString m_lastError;
+    qint64 m_lastErrorGame;
+};
+
+#endif  // PGN_READER_HPP
@@ -0,0 +1,177 @@
+#include "pgn/pgn-writer.hpp"
+
+#include <QList>
+#include <cstdio>
+#include <cstring>
+
+#include "util/stringify.hpp"
+
+static const char* const SevenTagRoster[] = {
+    "Event", "Site", "Date", "Round", "White", "Black", "Result"};
+
+static bool isRosterTag(const QString& name) {
+    for (const char* tag : SevenTagRoster)
+        if (name == QLatin1String(tag)) return true;
+    return false;
+}
+
+PgnWriter::PgnWriter(QIODevice* device)
+    : m_device(device), m_lineLength(0), m_glued(false) {
+    m_buffer.reserve(BufferSize);
+}
+
+PgnWriter::~PgnWriter() { flush(); }
+
+void PgnWriter::writeGame(const Tree& tree) {
+    writeTags(tree);
+    append("\n", 1);
+    m_lineLength = 0;
+    m_glued = false;
+
+    // Comment of the root comes before the first move.
+    const TreeNode* root = tree.rootNode();
+    if (!root->comment().isEmpty()) writeComment(root->comment());
+    writeLine(root, *root->getBoard(), true);
+
+    QString result = tree.tag("Result");
+    writeToken(result.isEmpty() ? QByteArray("*") : result.toLatin1());
+    append("\n\n", 2);
+    m_lineLength = 0;
+}
+
+bool PgnWriter::flush() {
+    bool written = m_buffer.isEmpty() ||
+                   m_device->write(m_buffer) == m_buffer.size();
+    // Keeps the capacity, unlike clear().
+    m_buffer.truncate(0);
+    return written;
+}
+
+void PgnWriter::writeTags(const Tree& tree) {
+    static const QString startFen = Board().toFen();
+
+    for (const char* name : SevenTagRoster) {
+        QString value = tree.tag(name);
+        if (value.isEmpty()) {
+            if (std::strcmp(name, "Date") == 0)
+                value = "????.??.??";
+            else if (std::strcmp(name, "Result") == 0)
+                value = "*";
+            else
+                value = "?";
+        }
+        writeTag(name, value);
+    }
+
+    // FEN is always written from the starting position, a stored tag may
+    // have been written by an older version that PgnReader rejects.
+    for (const auto& tag : tree.tags()) {
+        if (isRosterTag(tag.first) || tag.first == "FEN" ||
+            tag.first == "SetUp")
+            continue;
+        writeTag(tag.first, tag.second);
+    }
+
+    QString fen = tree.rootNode()->getBoard()->toFen();
+    if (fen != startFen) {
+        writeTag("SetUp", "1");
+        writeTag("FEN", fen);
+    }
+}
+
+void PgnWriter::writeTag(const QString& name, const QString& value) {
+    QByteArray line = '[' + name.toUtf8() + " \"";
+    for (char c : value.toUtf8()) {
+        if (c == '"' || c == '\\') line += '\\';
+        line += c;
+    }
+    line += "\"]\n";
+    append(line.constData(), line.size());
+}
+
+void PgnWriter::writeLine(const TreeNode* node, Board board,
+                          bool forceNumber) {
+    // Main line is followed iteratively, only variations recurse.
+    while (node->hasNeighbours()) {
+        Move move = node->nextMove();
+        const TreeNode* next = node->next();
+        forceNumber = writeMove(board, next, move, forceNumber);
+
+        if (node->hasVariations()) {
+            for (const Move& variation : node->nonMainMoves()) {
+                const TreeNode* child = node->next(variation);
+                writeToken("(", 1);
+                m_glued = true;
+
+                Board variationBoard = board;
+                bool force = writeMove(board, child, variation, true);
+                variationBoard.makeMove(variation);
+                writeLine(child, variationBoard, force);
+                writeToken(")", 1, false);
+            }
+            forceNumber = true;
+        }
+
+        board.makeMove(move);
+        node = next;
+    }
+}
+
+bool PgnWriter::writeMove(const Board& board, const TreeNode* node, Move move,
+                          bool forceNumber) {
+    char number[24];
+    int length = 0;
+    if (board.currentPlayer().isWhite())
+        length = std::snprintf(number, sizeof(number), "%d.",
+                               board.fullMoveCount());
+    else if (forceNumber)
+        length = std::snprintf(number, sizeof(number), "%d...",
+                               board.fullMoveCount());
+    if (length > 0) writeToken(number, length);
+
+    writeToken(Stringify::algebraicNotationString(board, move).toLatin1());
+
+    for (int nag : node->nags()) {
+        length = std::snprintf(number, sizeof(number), "$%d", nag);
+        writeToken(number, length);
+    }
+
+    if (node->comment().isEmpty()) return false;
+
+    writeComment(node->comment());
+    return true;
+}
+
+void PgnWriter::writeComment(const QString& comment) {
+    // Comment cannot contain its own terminator, words are wrapped like any
+    // other token.
+    QByteArray text = comment.toUtf8().replace('}', ')').simplified();
+    if (text.isEmpty()) return;
+
+    QList<QByteArray> words = text.split(' ');
+    words.first().prepend('{');
+    words.last().append('}');
+    for (const QByteArray& word : words) writeToken(word);
+}
+
+void PgnWriter::writeToken(const char* text, int length, bool spaced) {
+    bool space = spaced && !m_glued && m_lineLength > 0;
+
+    if (m_lineLength > 0 && m_lineLength + space + length > MaxLineLength) {
+        append("\n", 1);
+        m_lineLength = 0;
+        space = false;
+    }
+    if (space) {
+        append(" ", 1);
+        ++m_lineLength;
+    }
+    append(text, length);
+    m_lineLength += length;
+    m_glued = false;
+}
+
+void PgnWriter::append(const char* text, int length) {
+    m_buffer.append(text, length);
+    if (m_buffer.size() >= BufferSize) flush();
+}
@@ -0,0 +1,63 @@
+#ifndef PGN_WRITER_HPP
+#define PGN_WRITER_HPP
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+
+#include "game/board.hpp"
+#include "game/tree.hpp"
+
+/*! \brief Writes trees as PGN games.
+ *
+ * The Seven Tag Roster goes first, then the remaining tags of the tree.
+ * Movetext is in export format: variations follow the main line move they
+ * replace, move numbers are repeated after comments and variations, and
+ * lines are kept below 80 characters. Text goes through a fixed size buffer
+ * straight to the device.
+ */
+class PgnWriter {
+public:
+    /*! \brief Writes games to \a device, which has to be open */
+    explicit PgnWriter(QIODevice* device);
+
+    /*! \brief Flushes the buffer */
+    ~PgnWriter();
+
+    /*! \brief Writes \a tree as a game, result is taken from its Result tag
+     */
+    void writeGame(const Tree& tree);
+
+    /*! \brief Writes buffered text to the device.
+     * \returns false if the device fails
+     */
+    bool flush();
+
+private:
+    enum { BufferSize = 1 << 16, MaxLineLength = 79 };
+
+    void writeTags(const Tree& tree);
+    void writeTag(const QString& name, const QString& value);
+    /*! \brief Writes moves from \a node on, \a board is the position of the
+     * node */
+    void writeLine(const TreeNode* node, Board board, bool forceNumber);
+    /*! \brief Writes move, its NAGs and comment
+     * \returns true if the next move needs a number
+     */
+    bool writeMove(const Board& board, const TreeNode* node, Move move,
+                   bool forceNumber);
+    void writeComment(const QString& comment);
+    /*! \brief Writes token, starting new line if it does not fit */
+    void writeToken(const char* text, int length, bool spaced = true);
+    void writeToken(const QByteArray& text, bool spaced = true) {
+        writeToken(text.constData(), text.size(), spaced);
+    }
+    void append(const char* text, int length);
+
+    QIODevice* m_device;
+    QByteArray m_buffer;
+    int m_lineLength;
+    /*!< Next token sticks to the previous one, e.g. after "(" */
+    bool m_glued;
+};
+
+#endif  // PGN_WRITER_HPP
@@ -14,5 +14,23 @@ BoardSettings::BoardSettings() : AbstractSettings("board") {
     set("boolBorder", true);
     set("intMarginSize", 5);
     set("intBorderSize", 20);
+    set("intAnimationMs", 150);
     reset();
+    rebuildStyle();
+
+    QObject::connect(this, &AbstractSettings::changed, this,
+                     &BoardSettings::rebuildStyle);
+}
+
+void BoardSettings::rebuildStyle() {
+    m_style.pieceStyle = get("stringPieceStyle").toString();
+    m_style.squareLight = get("colorSquareLight").value<QColor>();
+    m_style.squareDark = get("colorSquareDark").value<QColor>();
+    m_style.picking = get("colorPicking").value<QColor>();
+    m_style.border = get("colorBorder").value<QColor>();
+    m_style.borderText = get("colorBorderText").value<QColor>();
+    m_style.hasBorder = get("boolBorder").toBool();
+    m_style.marginSize = get("intMarginSize").toInt();
+    m_style.borderSize = get("intBorderSize").toInt();
+    m_style.animationMs = get("intAnimationMs").toInt();
 }
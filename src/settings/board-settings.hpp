@@ -1,12 +1,38 @@
 #ifndef BOARD_SETTINGS_HPP
 #define BOARD_SETTINGS_HPP
+#include <QColor>
+
 #include "settings/abstract-settings.hpp"
 
+/*! \brief Typed snapshot of the board settings, cheap to read while painting.
+ */
+struct BoardStyle {
+    QString pieceStyle;
+    QColor squareLight;
+    QColor squareDark;
+    QColor picking;
+    QColor border;
+    QColor borderText;
+    bool hasBorder;
+    int marginSize;
+    int borderSize;
+    int animationMs;
+};
+
 class BoardSettings : public AbstractSettings {
     friend class SettingsFactory;
 
+public:
+    /*! \brief Returns settings snapshot, rebuilt whenever changed() fires. */
+    const BoardStyle& style() const { return m_style; }
+
 private:
     BoardSettings();
+
+    /*! \brief Re-reads all keys into the snapshot. */
+    void rebuildStyle();
+
+    BoardStyle m_style;
 };
 
 #endif
@@ -4,6 +4,13 @@
 
 EnginesSettings::EnginesSettings() : AbstractSettings("engines") {
     set("configs", QList<QVariant>());
+    set("intOutputFrameRate", 10);
+    set("boolPrewarmEngines", false);
+    set("intAnalysisCacheMb", 64);
+    set("stringUciLogDir", "");
+    set("stringBookPath", "");
+    set("stringPolyglotRandomFile", "");
+    set("stringSyzygyPath", "");
     reset();
 }
 
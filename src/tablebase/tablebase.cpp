@@ -0,0 +1,972 @@
+#include "tablebase/tablebase.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+#include <QtEndian>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <utility>
+
+#include "game/zobrist.hpp"
+
+namespace {
+
+/*!< Flags of a subtable */
+enum Flag {
+    StmFlag = 1,
+    MappedFlag = 2,
+    WinPliesFlag = 4,
+    LossPliesFlag = 8,
+    WideFlag = 16,
+    SingleValueFlag = 128
+};
+
+const int MaxPieces = 7;
+const uchar WdlMagic[4] = {0x71, 0xe8, 0x23, 0x5d};
+const uchar DtzMagic[4] = {0xd7, 0x66, 0x0c, 0xa5};
+/*!< Slots of the per-thread WDL cache, a power of two */
+const int CacheSize = 4096;
+
+typedef quint16 Sym;
+
+/*! \brief Node of the Huffman tree, two 12-bit symbols */
+struct LR {
+    uchar lr[3];
+
+    Sym left() const { return Sym(((lr[1] & 0xf) << 8) | lr[0]); }
+    Sym right() const { return Sym((lr[2] << 4) | (lr[1] >> 4)); }
+};
+static_assert(sizeof(LR) == 3, "LR layout changed");
+
+/*! \brief Decoding data of a subtable, one per side to move and pawn file.
+ * Pointers point into the mapped file, multi-byte values in it are little
+ * endian except the compressed blocks.
+ */
+struct PairsData {
+    quint8 flags = 0;
+    quint64 blockSize = 0;
+    /*!< Positions per entry of the sparse index */
+    quint64 span = 0;
+    quint32 blockCount = 0;
+    int maxSymLen = 0;
+    int minSymLen = 0;
+    const uchar* lowestSym = nullptr;
+    const LR* btree = nullptr;
+    const uchar* blockLength = nullptr;
+    quint32 blockLengthSize = 0;
+    /*!< Entries of 32-bit block and 16-bit offset */
+    const uchar* sparseIndex = nullptr;
+    quint64 sparseIndexSize = 0;
+    const uchar* data = nullptr;
+    /*!< Lowest code of every length, left aligned */
+    std::vector<quint64> base64;
+    /*!< Number of values a symbol expands to, minus one */
+    std::vector<quint8> symlen;
+    /*!< Piece codes in the order of the index */
+    int pieces[MaxPieces] = {};
+    quint64 groupIdx[MaxPieces + 1] = {};
+    int groupLen[MaxPieces + 1] = {};
+    /*!< Offsets of the DTZ value maps per WDL result */
+    quint16 mapIdx[4] = {};
+};
+
+template <typename T>
+T readLe(const uchar* p) {
+    return qFromLittleEndian<T>(p);
+}
+
+template <typename T>
+T readBe(const uchar* p) {
+    return qFromBigEndian<T>(p);
+}
+
+/*! \brief Squares are file + 8 * rank, a1 is 0 */
+int fileOf(int square) { return square & 7; }
+int rankOf(int square) { return square >> 3; }
+/*! \brief Returns distance from the a1-h8 diagonal, positive above it */
+int offA1H8(int square) { return rankOf(square) - fileOf(square); }
+
+int sign(int value) { return (value > 0) - (value < 0); }
+
+/*! \brief Index tables of the reference encoding */
+struct Indices {
+    int mapPawns[64] = {};
+    int mapB1H1H7[64] = {};
+    int mapA1D1D4[64] = {};
+    int mapKK[10][64] = {};
+    int binomial[6][64] = {};
+    int leadPawnIdx[6][64] = {};
+    int leadPawnsSize[6][4] = {};
+
+    Indices();
+};
+
+Indices::Indices() {
+    int code = 0;
+    for (int s = 0; s < 64; ++s)
+        if (offA1H8(s) < 0) mapB1H1H7[s] = code++;
+
+    // Squares below the diagonal first, then those on it.
+    const int D4 = 27;
+    std::vector<int> diagonal;
+    code = 0;
+    for (int s = 0; s <= D4; ++s) {
+        if (offA1H8(s) < 0 && fileOf(s) <= 3)
+            mapA1D1D4[s] = code++;
+        else if (!offA1H8(s) && fileOf(s) <= 3)
+            diagonal.push_back(s);
+    }
+    for (int s : diagonal) mapA1D1D4[s] = code++;
+
+    // Pairs of kings where both are on the diagonal come last.
+    const int B1 = 1;
+    std::vector<std::pair<int, int>> bothOnDiagonal;
+    code = 0;
+    for (int idx = 0; idx < 10; ++idx)
+        for (int s1 = 0; s1 <= D4; ++s1) {
+            if (mapA1D1D4[s1] != idx || (!idx && s1 != B1)) continue;
+            for (int s2 = 0; s2 < 64; ++s2) {
+                int distance = qMax(qAbs(fileOf(s1) - fileOf(s2)),
+                                    qAbs(rankOf(s1) - rankOf(s2)));
+                if (distance <= 1 || (!offA1H8(s1) && offA1H8(s2) > 0))
+                    continue;
+                if (!offA1H8(s1) && !offA1H8(s2))
+                    bothOnDiagonal.emplace_back(idx, s2);
+                else
+                    mapKK[idx][s2] = code++;
+            }
+        }
+    for (const auto& pair : bothOnDiagonal)
+        mapKK[pair.first][pair.second] = code++;
+
+    binomial[0][0] = 1;
+    for (int n = 1; n < 64; ++n)
+        for (int k = 0; k < 6 && k <= n; ++k)
+            binomial[k][n] = (k > 0 ? binomial[k - 1][n - 1] : 0) +
+                             (k < n ? binomial[k][n - 1] : 0);
+
+    // Pawns are counted per file from a to d, the leading pawn decides the
+    // file of the subtable.
+    int availableSquares = 47;
+    for (int leadPawnsCnt = 1; leadPawnsCnt <= 5; ++leadPawnsCnt)
+        for (int f = 0; f < 4; ++f) {
+            int idx = 0;
+            for (int r = 1; r < 7; ++r) {
+                int s = f + 8 * r;
+                if (leadPawnsCnt == 1) {
+                    mapPawns[s] = availableSquares--;
+                    mapPawns[s ^ 7] = availableSquares--;
+                }
+                leadPawnIdx[leadPawnsCnt][s] = idx;
+                idx += binomial[leadPawnsCnt - 1][mapPawns[s]];
+            }
+            leadPawnsSize[leadPawnsCnt][f] = idx;
+        }
+}
+
+const Indices& indices() {
+    static const Indices instance;
+    return instance;
+}
+
+/*! \brief Orders pawns by their index, the leading pawn is the largest */
+bool pawnsComp(int a, int b) {
+    return indices().mapPawns[a] < indices().mapPawns[b];
+}
+
+/*! \brief Returns piece code of the tables, 1 to 6 for white pawn to king,
+ * 9 to 14 for black, 0 for an empty square */
+int pieceCode(const Piece& piece) {
+    if (piece.isNone()) return 0;
+    return static_cast<int>(piece.type()) + 1 +
+           (piece.owner().isWhite() ? 0 : 8);
+}
+
+/*! \brief Returns pieces of one side in the order of table names */
+QString material(const Board& board, bool white) {
+    static const char Letters[] = "PNBRQK";
+    int counts[6] = {};
+    for (int y = 0; y < 8; ++y)
+        for (int x = 0; x < 8; ++x) {
+            const Piece& piece = board.pieceAt(x, y);
+            if (!piece.isNone() && piece.owner().isWhite() == white)
+                ++counts[static_cast<int>(piece.type())];
+        }
+
+    QString text;
+    for (int type = 5; type >= 0; --type)
+        text += QString(counts[type], QChar(Letters[type]));
+    return text;
+}
+
+bool isZeroing(const Board& board, const Move& move) {
+    const Piece& piece = board.pieceAt(move.From);
+    return piece.isPawn() || !board.pieceAt(move.To).isNone();
+}
+
+bool isCapture(const Board& board, const Move& move) {
+    // Pawn moving diagonally to an empty square takes en passant.
+    return !board.pieceAt(move.To).isNone() ||
+           (board.pieceAt(move.From).isPawn() && move.From.x != move.To.x);
+}
+
+/*! \brief Returns DTZ of a position where the best move zeroes, the win
+ * or loss is then decided in the next ply */
+int dtzBeforeZeroing(int wdl) {
+    switch (wdl) {
+    case Tablebase::Loss:
+        return -1;
+    case Tablebase::BlessedLoss:
+        return -101;
+    case Tablebase::CursedWin:
+        return 101;
+    case Tablebase::Win:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/*! \brief Cached WDL result, generation 0 marks an empty slot */
+struct CacheEntry {
+    quint64 hash;
+    quint32 generation;
+    int wdl;
+};
+
+/*! \brief Returns slot of the per-thread cache, WDL does not depend on the
+ * move counters left out of the hash */
+CacheEntry* cacheEntry(quint64 hash) {
+    thread_local std::vector<CacheEntry> cache(CacheSize,
+                                               CacheEntry{0, 0, 0});
+    return &cache[hash & (CacheSize - 1)];
+}
+
+quint8 setSymlen(PairsData* d, Sym s, std::vector<bool>& visited) {
+    visited[s] = true;
+    Sym right = d->btree[s].right();
+    if (right == 0xfff) return 0;
+
+    Sym left = d->btree[s].left();
+    // Damaged tree must not recurse out of bounds.
+    if (left >= d->symlen.size() || right >= d->symlen.size()) return 0;
+    if (!visited[left]) d->symlen[left] = setSymlen(d, left, visited);
+    if (!visited[right]) d->symlen[right] = setSymlen(d, right, visited);
+    return d->symlen[left] + d->symlen[right] + 1;
+}
+
+/*! \brief Reads sizes and Huffman code of a subtable.
+ * \returns data following them, null if they are damaged
+ */
+const uchar* setSizes(PairsData* d, const uchar* data, const uchar* end) {
+    if (end - data < 2) return nullptr;
+    d->flags = *data++;
+    if (d->flags & SingleValueFlag) {
+        d->blockCount = 0;
+        d->blockLengthSize = 0;
+        d->span = 0;
+        d->sparseIndexSize = 0;
+        d->minSymLen = *data++;
+        return data;
+    }
+
+    if (end - data < 10) return nullptr;
+    int groups = std::find(d->groupLen, d->groupLen + MaxPieces, 0) -
+                 d->groupLen;
+    quint64 tableSize = d->groupIdx[groups];
+    d->blockSize = quint64(1) << (*data++ & 63);
+    d->span = quint64(1) << (*data++ & 63);
+    d->sparseIndexSize = (tableSize + d->span - 1) / d->span;
+    int padding = *data++;
+    d->blockCount = readLe<quint32>(data);
+    data += 4;
+    d->blockLengthSize = d->blockCount + padding;
+    d->maxSymLen = *data++;
+    d->minSymLen = *data++;
+    if (d->minSymLen < 1 || d->maxSymLen < d->minSymLen ||
+        d->maxSymLen > 64)
+        return nullptr;
+
+    d->lowestSym = data;
+    d->base64.assign(d->maxSymLen - d->minSymLen + 1, 0);
+    data += d->base64.size() * sizeof(Sym);
+    if (end - data < 2) return nullptr;
+
+    // Canonical Huffman code, the lowest code of every length is derived
+    // from the one of the next length.
+    for (int i = int(d->base64.size()) - 2; i >= 0; --i)
+        d->base64[i] = (d->base64[i + 1] + readLe<Sym>(d->lowestSym + 2 * i) -
+                        readLe<Sym>(d->lowestSym + 2 * (i + 1))) /
+                       2;
+    for (size_t i = 0; i < d->base64.size(); ++i)
+        d->base64[i] <<= 64 - i - d->minSymLen;
+
+    d->symlen.assign(readLe<quint16>(data), 0);
+    data += 2;
+    d->btree = reinterpret_cast<const LR*>(data);
+    data += d->symlen.size() * sizeof(LR) + (d->symlen.size() & 1);
+    if (data > end) return nullptr;
+
+    std::vector<bool> visited(d->symlen.size());
+    for (Sym s = 0; s < d->symlen.size(); ++s)
+        if (!visited[s]) d->symlen[s] = setSymlen(d, s, visited);
+    return data;
+}
+
+/*! \brief Returns value number \a idx of a subtable */
+int decompressPairs(const PairsData* d, quint64 idx) {
+    if (d->flags & SingleValueFlag) return d->minSymLen;
+
+    // Sparse index gives a block and an offset into it for the middle of
+    // every span, the wanted value is then found by walking block lengths.
+    quint64 k = idx / d->span;
+    quint32 block = readLe<quint32>(d->sparseIndex + 6 * k);
+    int offset = readLe<quint16>(d->sparseIndex + 6 * k + 4);
+    offset += int(idx % d->span) - int(d->span / 2);
+
+    auto blockLength = [d](quint32 i) {
+        return int(readLe<quint16>(d->blockLength + 2 * i));
+    };
+    while (offset < 0) offset += blockLength(--block) + 1;
+    while (offset > blockLength(block)) offset -= blockLength(block++) + 1;
+
+    const uchar* p = d->data + quint64(block) * d->blockSize;
+    quint64 buf64 = readBe<quint64>(p);
+    p += 8;
+    int buf64Size = 64;
+    Sym sym;
+    while (true) {
+        int len = 0;
+        // Last entry is zero, so this stops.
+        while (buf64 < d->base64[len]) ++len;
+
+        sym = Sym((buf64 - d->base64[len]) >> (64 - len - d->minSymLen));
+        sym += readLe<Sym>(d->lowestSym + 2 * len);
+        if (offset < d->symlen[sym] + 1) break;
+
+        offset -= d->symlen[sym] + 1;
+        len += d->minSymLen;
+        buf64 <<= len;
+        buf64Size -= len;
+        if (buf64Size <= 32) {
+            buf64Size += 32;
+            buf64 |= quint64(readBe<quint32>(p)) << (64 - buf64Size);
+            p += 4;
+        }
+    }
+
+    // Symbol stands for a pair of symbols, expanded down to the value.
+    while (d->symlen[sym]) {
+        Sym left = d->btree[sym].left();
+        if (offset < d->symlen[left] + 1) {
+            sym = left;
+        } else {
+            offset -= d->symlen[left] + 1;
+            sym = d->btree[sym].right();
+        }
+    }
+    return d->btree[sym].left();
+}
+
+}  // namespace
+
+/*! \brief Table of one material, mapped on first use */
+struct Tablebase::Table {
+    bool dtz = false;
+    QString path;
+    QFile file;
+    std::atomic<bool> ready{false};
+    uchar* map = nullptr;
+    /*!< DTZ value maps, DTZ tables only */
+    const uchar* dtzMap = nullptr;
+    /*!< Both sides have the same pieces */
+    bool symmetric = false;
+    int pieceCount = 0;
+    bool hasPawns = false;
+    /*!< Some piece other than the kings is the only one of its kind */
+    bool hasUniquePieces = false;
+    /*!< Pawns of the leading color and of the other one */
+    int pawnCount[2] = {};
+    PairsData items[2][4];
+
+    PairsData* get(int stm, int file) {
+        return &items[dtz ? 0 : stm][hasPawns ? file : 0];
+    }
+
+    /*! \brief Reads material like "KRPvKR" from the table name.
+     * \returns false if the name is not a table
+     */
+    bool parse(const QString& name);
+    /*! \brief Reads headers of the mapped file */
+    bool setup(const uchar* base, const uchar* end);
+    bool setGroups(PairsData* d, const int order[2], int file);
+    const uchar* setDtzMap(const uchar* data, int maxFile,
+                           const uchar* base);
+    /*! \brief Turns stored \a value into WDL or DTZ */
+    int mapScore(int file, int value, int wdl);
+};
+
+bool Tablebase::Table::parse(const QString& name) {
+    static const QString Letters = "PNBRQK";
+    QStringList sides = name.split('v');
+    if (sides.size() != 2) return false;
+
+    int counts[2][6] = {};
+    for (int side = 0; side < 2; ++side)
+        for (QChar letter : sides[side]) {
+            int type = Letters.indexOf(letter);
+            if (type < 0) return false;
+            ++counts[side][type];
+            ++pieceCount;
+        }
+    if (counts[0][5] != 1 || counts[1][5] != 1 || pieceCount > MaxPieces)
+        return false;
+
+    symmetric = sides[0] == sides[1];
+    hasPawns = counts[0][0] + counts[1][0] > 0;
+    for (int side = 0; side < 2; ++side)
+        for (int type = 0; type < 5; ++type)
+            if (counts[side][type] == 1) hasUniquePieces = true;
+
+    // Leading color has fewer pawns, white if both have the same number.
+    bool blackLeads =
+        counts[1][0] && (!counts[0][0] || counts[1][0] < counts[0][0]);
+    pawnCount[0] = counts[blackLeads][0];
+    pawnCount[1] = counts[!blackLeads][0];
+    return true;
+}
+
+bool Tablebase::Table::setup(const uchar* base, const uchar* end) {
+    enum { Split = 1, HasPawns = 2 };
+    const uchar* data = base + 4;
+    if (bool(*data & HasPawns) != hasPawns ||
+        bool(*data & Split) != !symmetric)
+        return false;
+    ++data;
+
+    const int sides = !dtz && !symmetric ? 2 : 1;
+    const int maxFile = hasPawns ? 3 : 0;
+    // Pawns of both colors are encoded before other pieces.
+    const bool pp = hasPawns && pawnCount[1];
+    for (int f = 0; f <= maxFile; ++f) {
+        for (int i = 0; i < sides; ++i) *get(i, f) = PairsData();
+
+        int order[2][2] = {{data[0] & 0xf, pp ? data[1] & 0xf : 0xf},
+                           {data[0] >> 4, pp ? data[1] >> 4 : 0xf}};
+        data += 1 + pp;
+        for (int k = 0; k < pieceCount; ++k, ++data)
+            for (int i = 0; i < sides; ++i)
+                get(i, f)->pieces[k] = i ? *data >> 4 : *data & 0xf;
+
+        for (int i = 0; i < sides; ++i)
+            if (!setGroups(get(i, f), order[i], f)) return false;
+    }
+    data += (data - base) & 1;
+
+    for (int f = 0; f <= maxFile; ++f)
+        for (int i = 0; i < sides; ++i) {
+            data = setSizes(get(i, f), data, end);
+            if (!data) return false;
+        }
+
+    if (dtz) data = setDtzMap(data, maxFile, base);
+
+    for (int f = 0; f <= maxFile; ++f)
+        for (int i = 0; i < sides; ++i) {
+            get(i, f)->sparseIndex = data;
+            data += get(i, f)->sparseIndexSize * 6;
+        }
+    for (int f = 0; f <= maxFile; ++f)
+        for (int i = 0; i < sides; ++i) {
+            get(i, f)->blockLength = data;
+            data += get(i, f)->blockLengthSize * 2;
+        }
+    for (int f = 0; f <= maxFile; ++f)
+        for (int i = 0; i < sides; ++i) {
+            // Blocks are aligned to 64 bytes.
+            data = base + ((data - base + 0x3f) & ~0x3f);
+            get(i, f)->data = data;
+            data += quint64(get(i, f)->blockCount) * get(i, f)->blockSize;
+        }
+    return data <= end;
+}
+
+bool Tablebase::Table::setGroups(PairsData* d, const int order[2],
+                                 int file) {
+    const Indices& ind = indices();
+
+    // Kings and a unique piece form the first group of a table without
+    // pawns, the leading pawns that of a table with them. Other groups are
+    // runs of equal pieces.
+    int n = 0;
+    int firstLen = hasPawns ? 0 : hasUniquePieces ? 3 : 2;
+    d->groupLen[n] = 1;
+    for (int i = 1; i < pieceCount; ++i) {
+        if (--firstLen > 0 || d->pieces[i] != d->pieces[i - 1])
+            d->groupLen[++n] = 1;
+        else
+            d->groupLen[n]++;
+    }
+    d->groupLen[++n] = 0;
+
+    const bool pp = hasPawns && pawnCount[1];
+    int next = pp ? 2 : 1;
+    int freeSquares = 64 - d->groupLen[0] - (pp ? d->groupLen[1] : 0);
+    quint64 idx = 1;
+    for (int k = 0; next < n || k == order[0] || k == order[1]; ++k) {
+        if (k == order[0]) {
+            d->groupIdx[0] = idx;
+            idx *= hasPawns ? ind.leadPawnsSize[d->groupLen[0]][file]
+                 : hasUniquePieces ? 31332
+                                   : 462;
+        } else if (k == order[1]) {
+            d->groupIdx[1] = idx;
+            idx *= ind.binomial[d->groupLen[1]][48 - d->groupLen[0]];
+        } else {
+            if (next >= n) return false;
+            d->groupIdx[next] = idx;
+            idx *= ind.binomial[d->groupLen[next]][freeSquares];
+            freeSquares -= d->groupLen[next++];
+        }
+    }
+    d->groupIdx[n] = idx;
+    return true;
+}
+
+const uchar* Tablebase::Table::setDtzMap(const uchar* data, int maxFile,
+                                         const uchar* base) {
+    dtzMap = data;
+    for (int f = 0; f <= maxFile; ++f) {
+        PairsData* d = get(0, f);
+        if (!(d->flags & MappedFlag)) continue;
+
+        // Maps of the four results follow each other, every one starts
+        // with its length.
+        if (d->flags & WideFlag) {
+            data += (data - base) & 1;
+            for (int i = 0; i < 4; ++i) {
+                d->mapIdx[i] = quint16((data - dtzMap) / 2 + 1);
+                data += 2 * readLe<quint16>(data) + 2;
+            }
+        } else {
+            for (int i = 0; i < 4; ++i) {
+                d->mapIdx[i] = quint16(data - dtzMap + 1);
+                data += *data + 1;
+            }
+        }
+    }
+    return data + ((data - base) & 1);
+}
+
+int Tablebase::Table::mapScore(int file, int value, int wdl) {
+    if (!dtz) return value - 2;
+
+    // Maps are ordered win, loss, cursed win, blessed loss.
+    static const int WdlMap[] = {1, 3, 0, 2, 0};
+    PairsData* d = get(0, file);
+    if (d->flags & MappedFlag) {
+        int idx = d->mapIdx[WdlMap[wdl + 2]] + value;
+        value = d->flags & WideFlag ? readLe<quint16>(dtzMap + 2 * idx)
+                                    : dtzMap[idx];
+    }
+
+    // DTZ of a win or loss is stored in moves unless the flags say plies,
+    // cursed results always are.
+    if ((wdl == Win && !(d->flags & WinPliesFlag)) ||
+        (wdl == Loss && !(d->flags & LossPliesFlag)) || wdl == CursedWin ||
+        wdl == BlessedLoss)
+        value *= 2;
+    return value + 1;
+}
+
+Tablebase::Tablebase() : m_maxPieces(0), m_generation(0) {}
+
+Tablebase::~Tablebase() {
+    for (const auto& table : m_tables)
+        if (table->map) table->file.unmap(table->map);
+}
+
+Tablebase& Tablebase::instance() {
+    static Tablebase tablebase;
+    return tablebase;
+}
+
+int Tablebase::init(const QString& paths) {
+    for (const auto& table : m_tables)
+        if (table->map) table->file.unmap(table->map);
+    m_tables.clear();
+    m_wdl.clear();
+    m_dtz.clear();
+    m_maxPieces = 0;
+    // Cache slots of the previous tables no longer match.
+    ++m_generation;
+
+    for (const QString& directory :
+         paths.split(QDir::listSeparator(), Qt::SkipEmptyParts)) {
+        QDir dir(directory);
+        for (const QString& name :
+             dir.entryList({"*.rtbw", "*.rtbz"}, QDir::Files)) {
+            bool dtz = name.endsWith(".rtbz");
+            QString material = QFileInfo(name).completeBaseName();
+            auto& tables = dtz ? m_dtz : m_wdl;
+            // Directory listed first wins.
+            if (tables.contains(material)) continue;
+
+            auto table = std::make_unique<Table>();
+            table->dtz = dtz;
+            table->path = dir.filePath(name);
+            if (!table->parse(material)) continue;
+
+            if (!dtz) m_maxPieces = qMax(m_maxPieces, table->pieceCount);
+            tables.insert(material, table.get());
+            m_tables.push_back(std::move(table));
+        }
+    }
+    return int(m_tables.size());
+}
+
+bool Tablebase::canProbe(const Board& board) const {
+    if (m_maxPieces == 0 ||
+        board.hasShortCastlingRights(Player::white()) ||
+        board.hasLongCastlingRights(Player::white()) ||
+        board.hasShortCastlingRights(Player::black()) ||
+        board.hasLongCastlingRights(Player::black()))
+        return false;
+
+    int pieces = 0;
+    for (int y = 0; y < 8; ++y)
+        for (int x = 0; x < 8; ++x)
+            if (!board.pieceAt(x, y).isNone()) ++pieces;
+    return pieces <= m_maxPieces;
+}
+
+bool Tablebase::probeWdl(const Board& board, Wdl& wdl) const {
+    if (!canProbe(board)) return false;
+
+    quint64 hash = Zobrist::hash(board);
+    CacheEntry* entry = cacheEntry(hash);
+    if (entry->generation == m_generation + 1 && entry->hash == hash) {
+        wdl = Wdl(entry->wdl);
+        return true;
+    }
+
+    ProbeState state = Ok;
+    int value = search(board, false, state);
+    if (state == Fail) return false;
+
+    *entry = {hash, m_generation + 1, value};
+    wdl = Wdl(value);
+    return true;
+}
+
+bool Tablebase::probeDtz(const Board& board, int& dtz) const {
+    if (!canProbe(board)) return false;
+
+    ProbeState state = Ok;
+    dtz = probeDtz(board, state);
+    return state != Fail;
+}
+
+bool Tablebase::probeRoot(const Board& board, Move& move, Wdl& wdl,
+                          int& dtz) const {
+    if (!probeWdl(board, wdl) || !probeDtz(board, dtz)) return false;
+
+    // Wins are ranked by the shortest DTZ, losses by the longest. DTZ of a
+    // move is counted from this position.
+    move = Move::NullMove;
+    int bestRank = INT_MIN;
+    for (const Move& candidate : board.legalMoves()) {
+        Board next = board;
+        next.makeMove(candidate);
+
+        int moveDtz;
+        if (next.isCheckmate()) {
+            moveDtz = 1;
+        } else if (next.halfMoveClock() == 0) {
+            Wdl nextWdl;
+            if (!probeWdl(next, nextWdl)) return false;
+            moveDtz = dtzBeforeZeroing(-nextWdl);
+        } else {
+            int nextDtz;
+            if (!probeDtz(next, nextDtz)) return false;
+            moveDtz = -nextDtz;
+            moveDtz += sign(moveDtz);
+        }
+
+        int rank = moveDtz > 0 ? 1000 - moveDtz
+                   : moveDtz < 0 ? -1000 - moveDtz
+                                 : 0;
+        if (rank > bestRank) {
+            bestRank = rank;
+            move = candidate;
+        }
+    }
+    return true;
+}
+
+Tablebase::Table* Tablebase::table(const Board& board, bool dtz,
+                                   bool& blackStronger) const {
+    QString white = material(board, true);
+    QString black = material(board, false);
+    const auto& tables = dtz ? m_dtz : m_wdl;
+
+    // Tables are named with the stronger side first.
+    blackStronger = false;
+    Table* found = tables.value(white + 'v' + black);
+    if (!found) {
+        found = tables.value(black + 'v' + white);
+        blackStronger = found != nullptr;
+    }
+    return found;
+}
+
+bool Tablebase::map(Table& table) const {
+    if (table.ready.load(std::memory_order_acquire)) return table.map;
+
+    std::lock_guard<std::mutex> lock(m_mapLock);
+    if (table.ready.load(std::memory_order_relaxed)) return table.map;
+
+    // Missing or damaged table is not tried again.
+    const uchar* magic = table.dtz ? DtzMagic : WdlMagic;
+    table.file.setFileName(table.path);
+    if (table.file.open(QIODevice::ReadOnly) &&
+        table.file.size() % 64 == 16) {
+        uchar* data = table.file.map(0, table.file.size());
+        if (data && std::memcmp(data, magic, 4) == 0 &&
+            table.setup(data, data + table.file.size()))
+            table.map = data;
+        else if (data)
+            table.file.unmap(data);
+    }
+    if (!table.map) table.file.close();
+    table.ready.store(true, std::memory_order_release);
+    return table.map;
+}
+
+int Tablebase::probeTable(const Board& board, bool dtz, int wdl,
+                          ProbeState& state) const {
+    const Indices& ind = indices();
+
+    int codes[64];
+    int pieceCount = 0;
+    for (int y = 0; y < 8; ++y)
+        for (int x = 0; x < 8; ++x) {
+            int code = pieceCode(board.pieceAt(x, y));
+            codes[x + 8 * (7 - y)] = code;
+            if (code) ++pieceCount;
+        }
+    // Bare kings are a draw, there is no table for them.
+    if (pieceCount == 2) return 0;
+
+    bool blackStronger;
+    Table* entry = table(board, dtz, blackStronger);
+    if (!entry || !map(*entry)) {
+        state = Fail;
+        return 0;
+    }
+
+    // Tables are stored with the stronger side as white, and symmetric ones
+    // with white to move, other positions are flipped.
+    int sideToMove = board.currentPlayer().isWhite() ? 0 : 1;
+    bool flip = (entry->symmetric && sideToMove == 1) || blackStronger;
+    int flipColor = flip ? 8 : 0;
+    int flipSquares = flip ? 56 : 0;
+    int stm = flip ? sideToMove ^ 1 : sideToMove;
+
+    int squares[MaxPieces];
+    int pieces[MaxPieces];
+    int size = 0;
+    int leadPawnsCnt = 0;
+    int tbFile = 0;
+    quint64 leadPawns = 0;
+    if (entry->hasPawns) {
+        int pawn = entry->get(0, 0)->pieces[0] ^ flipColor;
+        for (int s = 0; s < 64 && size < MaxPieces; ++s)
+            if (codes[s] == pawn) {
+                leadPawns |= quint64(1) << s;
+                squares[size++] = s ^ flipSquares;
+            }
+        if (size == 0) {
+            state = Fail;
+            return 0;
+        }
+        leadPawnsCnt = size;
+        std::swap(squares[0], *std::max_element(squares, squares + size,
+                                                pawnsComp));
+        tbFile = qMin(fileOf(squares[0]), 7 - fileOf(squares[0]));
+    }
+
+    // DTZ tables hold one side to move only, the other one needs a search.
+    if (dtz && (entry->get(stm, tbFile)->flags & StmFlag) != stm &&
+        !(entry->symmetric && !entry->hasPawns)) {
+        state = ChangeStm;
+        return 0;
+    }
+
+    for (int s = 0; s < 64 && size < MaxPieces; ++s)
+        if (codes[s] && !(leadPawns >> s & 1)) {
+            squares[size] = s ^ flipSquares;
+            pieces[size++] = codes[s] ^ flipColor;
+        }
+
+    // Pieces are put in the order of the table.
+    PairsData* d = entry->get(stm, tbFile);
+    for (int i = leadPawnsCnt; i < size - 1; ++i)
+        for (int j = i + 1; j < size; ++j)
+            if (d->pieces[i] == pieces[j]) {
+                std::swap(pieces[i], pieces[j]);
+                std::swap(squares[i], squares[j]);
+                break;
+            }
+
+    // Mirror so that the leading piece is on files a to d.
+    if (fileOf(squares[0]) > 3)
+        for (int i = 0; i < size; ++i) squares[i] ^= 7;
+
+    quint64 idx;
+    if (entry->hasPawns) {
+        idx = ind.leadPawnIdx[leadPawnsCnt][squares[0]];
+        std::stable_sort(squares + 1, squares + leadPawnsCnt, pawnsComp);
+        for (int i = 1; i < leadPawnsCnt; ++i)
+            idx += ind.binomial[i][ind.mapPawns[squares[i]]];
+    } else {
+        // Without pawns the leading piece goes to the a1-d1-d4 triangle and
+        // the first piece off the diagonal below it.
+        if (rankOf(squares[0]) > 3)
+            for (int i = 0; i < size; ++i) squares[i] ^= 56;
+
+        for (int i = 0; i < d->groupLen[0]; ++i) {
+            if (!offA1H8(squares[i])) continue;
+            if (offA1H8(squares[i]) > 0)
+                for (int j = i; j < size; ++j)
+                    squares[j] = ((squares[j] >> 3) | (squares[j] << 3)) & 63;
+            break;
+        }
+
+        if (entry->hasUniquePieces) {
+            int adjust1 = squares[1] > squares[0];
+            int adjust2 = (squares[2] > squares[0]) + (squares[2] > squares[1]);
+            if (offA1H8(squares[0]))
+                idx = (ind.mapA1D1D4[squares[0]] * 63 +
+                       (squares[1] - adjust1)) *
+                          62 +
+                      squares[2] - adjust2;
+            else if (offA1H8(squares[1]))
+                idx = (6 * 63 + rankOf(squares[0]) * 28 +
+                       ind.mapB1H1H7[squares[1]]) *
+                          62 +
+                      squares[2] - adjust2;
+            else if (offA1H8(squares[2]))
+                idx = 6 * 63 * 62 + 4 * 28 * 62 +
+                      rankOf(squares[0]) * 7 * 28 +
+                      (rankOf(squares[1]) - adjust1) * 28 +
+                      ind.mapB1H1H7[squares[2]];
+            else
+                idx = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 +
+                      rankOf(squares[0]) * 7 * 6 +
+                      (rankOf(squares[1]) - adjust1) * 6 +
+                      (rankOf(squares[2]) - adjust2);
+        } else {
+            idx = ind.mapKK[ind.mapA1D1D4[squares[0]]][squares[1]];
+        }
+    }
+    idx *= d->groupIdx[0];
+
+    // Every other group is a combination of the squares left free.
+    int* groupSq = squares + d->groupLen[0];
+    bool remainingPawns = entry->hasPawns && entry->pawnCount[1];
+    for (int next = 1; d->groupLen[next]; ++next) {
+        std::stable_sort(groupSq, groupSq + d->groupLen[next]);
+        quint64 n = 0;
+        for (int i = 0; i < d->groupLen[next]; ++i) {
+            int adjust = std::count_if(squares, groupSq, [&](int s) {
+                return groupSq[i] > s;
+            });
+            n += ind.binomial[i + 1]
+                             [groupSq[i] - adjust - 8 * remainingPawns];
+        }
+        remainingPawns = false;
+        idx += n * d->groupIdx[next];
+        groupSq += d->groupLen[next];
+    }
+
+    return entry->mapScore(tbFile, decompressPairs(d, idx), wdl);
+}
+
+int Tablebase::search(const Board& board, bool zeroing,
+                      ProbeState& state) const {
+    int bestValue = Loss;
+    QVector<Move> moves = board.legalMoves();
+    int moveCount = 0;
+    for (const Move& move : moves) {
+        if (!isCapture(board, move) &&
+            (!zeroing || !board.pieceAt(move.From).isPawn()))
+            continue;
+
+        ++moveCount;
+        Board next = board;
+        next.makeMove(move);
+        int value = -search(next, false, state);
+        if (state == Fail) return Draw;
+
+        if (value > bestValue) {
+            bestValue = value;
+            if (value >= Win) {
+                state = ZeroingBestMove;
+                return value;
+            }
+        }
+    }
+
+    // Table is not needed when all moves were searched.
+    bool noMoreMoves = moveCount && moveCount == moves.size();
+    int value;
+    if (noMoreMoves) {
+        value = bestValue;
+    } else {
+        value = probeTable(board, false, Draw, state);
+        if (state == Fail) return Draw;
+    }
+
+    if (bestValue >= value) {
+        state = bestValue > Draw || noMoreMoves ? ZeroingBestMove : Ok;
+        return bestValue;
+    }
+    state = Ok;
+    return value;
+}
+
+int Tablebase::probeDtz(const Board& board, ProbeState& state) const {
+    state = Ok;
+    int wdl = search(board, true, state);
+    if (state == Fail || wdl == Draw) return 0;
+    if (state == ZeroingBestMove) return dtzBeforeZeroing(wdl);
+
+    int dtz = probeTable(board, true, wdl, state);
+    if (state == Fail) return 0;
+    if (state != ChangeStm)
+        return (dtz + 100 * (wdl == BlessedLoss || wdl == CursedWin)) *
+               sign(wdl);
+
+    // Table is stored for the other side, one ply is searched.
+    int minDtz = 0xffff;
+    for (const Move& move : board.legalMoves()) {
+        bool zeroingMove = isZeroing(board, move);
+        Board next = board;
+        next.makeMove(move);
+
+        dtz = zeroingMove ? -dtzBeforeZeroing(search(next, false, state))
+                          : -probeDtz(next, state);
+        if (state == Fail) return 0;
+
+        if (dtz == 1 && next.isCheckmate()) minDtz = 1;
+        if (!zeroingMove) dtz += sign(dtz);
+        if (dtz < minDtz && sign(dtz) == sign(wdl)) minDtz = dtz;
+    }
+    // No move keeps the result, so all lose.
+    return minDtz == 0xffff ? -1 : minDtz;
+}
@@ -0,0 +1,95 @@
+#ifndef TABLEBASE_HPP
+#define TABLEBASE_HPP
+#include <QHash>
+#include <QString>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "game/board.hpp"
+
+/*! \brief Syzygy endgame tablebases, up to seven pieces.
+ *
+ * init() only looks for .rtbw (WDL) and .rtbz (DTZ) files, a table is memory
+ * mapped when a position of its material is probed first. WDL tables give
+ * the result under the fifty-move rule, DTZ tables the number of plies to
+ * the next capture or pawn move. Positions with castling rights are not in
+ * the tables.
+ *
+ * Probing follows the reference implementation: the tables may store any
+ * value where a capture is the best move, so captures are searched first,
+ * which also resolves en passant. WDL results are kept in a small per-thread
+ * cache. Probing is thread-safe, init() is not.
+ */
+class Tablebase {
+public:
+    /*! \brief Result for the side to move, cursed wins and blessed losses
+     * are drawn by the fifty-move rule */
+    enum Wdl { Loss = -2, BlessedLoss = -1, Draw = 0, CursedWin = 1, Win = 2 };
+
+    Tablebase();
+    ~Tablebase();
+
+    Tablebase(const Tablebase&) = delete;
+    Tablebase& operator=(const Tablebase&) = delete;
+
+    /*! \brief Returns tablebases shared by the application */
+    static Tablebase& instance();
+
+    /*! \brief Finds tables in \a paths, directories separated by
+     * QDir::listSeparator(). Tables found earlier are dropped.
+     * \returns number of tables found
+     */
+    int init(const QString& paths);
+
+    /*! \brief Returns largest number of pieces of the found tables */
+    int maxPieces() const { return m_maxPieces; }
+
+    /*! \brief Tests whether the position can be in the found tables */
+    bool canProbe(const Board& board) const;
+
+    /*! \brief Probes result of the position.
+     * \returns false if the table is missing or damaged
+     */
+    bool probeWdl(const Board& board, Wdl& wdl) const;
+
+    /*! \brief Probes distance to zeroing in plies, positive if the side to
+     * move wins, 0 for a draw. Beyond 100 the win or loss is cursed.
+     * \returns false if the table is missing or damaged
+     */
+    bool probeDtz(const Board& board, int& dtz) const;
+
+    /*! \brief Finds move keeping the result, the fastest win or the longest
+     * loss, \a move is null if there is no legal move.
+     * \returns false if some table is missing or damaged
+     */
+    bool probeRoot(const Board& board, Move& move, Wdl& wdl, int& dtz) const;
+
+private:
+    struct Table;
+    enum ProbeState { Fail, Ok, ChangeStm, ZeroingBestMove };
+
+    /*! \brief Returns table of the material of the position, null if there
+     * is none, \a blackStronger is set if the colors are swapped in it */
+    Table* table(const Board& board, bool dtz, bool& blackStronger) const;
+    /*! \brief Maps table on first use */
+    bool map(Table& table) const;
+    /*! \brief Reads value of the position from its WDL or DTZ table */
+    int probeTable(const Board& board, bool dtz, int wdl,
+                   ProbeState& state) const;
+    /*! \brief Resolves captures, and pawn moves if \a zeroing, before
+     * reading the WDL table */
+    int search(const Board& board, bool zeroing, ProbeState& state) const;
+    int probeDtz(const Board& board, ProbeState& state) const;
+
+    std::vector<std::unique_ptr<Table>> m_tables;
+    /*!< Tables by material, e.g. "KRvK" */
+    QHash<QString, Table*> m_wdl;
+    QHash<QString, Table*> m_dtz;
+    int m_maxPieces;
+    /*!< Tells cached results of earlier tables apart */
+    quint32 m_generation;
+    mutable std::mutex m_mapLock;
+};
+
+#endif  // TABLEBASE_HPP
@@ -0,0 +1,135 @@
+#include "util/profiler.hpp"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QThread>
+#include <algorithm>
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler() : m_enabled(false), m_lastProbeNs(0), m_eventCount(0) {
+    // First user may be an engine thread, the probe measures the GUI one.
+    if (QCoreApplication* app = QCoreApplication::instance()) {
+        moveToThread(app->thread());
+        m_probe.moveToThread(app->thread());
+    }
+    m_clock.start();
+    m_probe.setTimerType(Qt::PreciseTimer);
+    m_probe.setInterval(ProbeIntervalMs);
+    QObject::connect(&m_probe, &QTimer::timeout, this, &Profiler::onProbe);
+}
+
+void Profiler::setEnabled(bool enabled) {
+    m_enabled.store(enabled, std::memory_order_relaxed);
+
+    if (enabled) {
+        m_lastProbeNs = now();
+        m_probe.start();
+    } else
+        m_probe.stop();
+}
+
+void Profiler::record(const char* section, qint64 startNs, qint64 durationNs) {
+    QMutexLocker lock(&m_mutex);
+
+    QVector<qint64>& samples = m_samples[section];
+    qint64& count = m_counts[section];
+
+    if (samples.size() < MaxSamples)
+        samples.append(durationNs);
+    else
+        samples[count % MaxSamples] = durationNs;
+    ++count;
+
+    Event event{section, startNs, durationNs,
+                reinterpret_cast<qint64>(QThread::currentThreadId())};
+    if (m_events.size() < MaxEvents)
+        m_events.append(event);
+    else
+        m_events[m_eventCount % MaxEvents] = event;
+    ++m_eventCount;
+}
+
+QVector<Profiler::Stats> Profiler::stats() const {
+    QMutexLocker lock(&m_mutex);
+    QVector<Stats> result;
+
+    for (auto it = m_samples.cbegin(); it != m_samples.cend(); ++it) {
+        QVector<qint64> sorted = it.value();
+        if (sorted.isEmpty()) continue;
+        std::sort(sorted.begin(), sorted.end());
+
+        auto percentile = [&sorted](double p) {
+            int index = std::min<int>(sorted.size() - 1, p * sorted.size());
+            return sorted[index] / 1000.0;
+        };
+
+        Stats stats;
+        stats.section = it.key();
+        stats.count = m_counts[it.key()];
+        stats.p50 = percentile(0.50);
+        stats.p99 = percentile(0.99);
+        stats.max = sorted.last() / 1000.0;
+        result.append(stats);
+    }
+
+    std::sort(result.begin(), result.end(),
+              [](const Stats& a, const Stats& b) {
+                  return a.section < b.section;
+              });
+    return result;
+}
+
+void Profiler::clear() {
+    QMutexLocker lock(&m_mutex);
+    m_samples.clear();
+    m_counts.clear();
+    m_events.clear();
+    m_eventCount = 0;
+}
+
+bool Profiler::exportChromeTrace(const QString& path) const {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+    QMutexLocker lock(&m_mutex);
+    QTextStream out(&file);
+    QHash<qint64, int> threadIds;
+
+    // Oldest event first, the ring buffer may have wrapped around.
+    int first = m_events.size() < MaxEvents ? 0 : m_eventCount % MaxEvents;
+    out << "{\"traceEvents\":[\n";
+    for (int i = 0; i < m_events.size(); i++) {
+        const Event& event = m_events[(first + i) % m_events.size()];
+
+        // Trace viewers want small thread ids.
+        if (!threadIds.contains(event.threadId))
+            threadIds.insert(event.threadId, threadIds.size() + 1);
+
+        out << "{\"name\":\"" << event.section
+            << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+            << threadIds[event.threadId]
+            << ",\"ts\":" << QString::number(event.startNs / 1000.0, 'f', 3)
+            << ",\"dur\":"
+            << QString::number(event.durationNs / 1000.0, 'f', 3) << "}";
+        out << (i + 1 < m_events.size() ? ",\n" : "\n");
+    }
+    out << "],\"displayTimeUnit\":\"ms\"}\n";
+    out.flush();
+
+    return out.status() == QTextStream::Ok;
+}
+
+void Profiler::onProbe() {
+    qint64 current = now();
+    qint64 stall = current - m_lastProbeNs - ProbeIntervalMs * 1000000LL;
+    m_lastProbeNs = current;
+
+    // Timer jitter is not a stall.
+    if (stall > 1000000LL) record(EventLoopStall, current - stall, stall);
+}
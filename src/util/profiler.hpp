@@ -0,0 +1,120 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+#include <atomic>
+
+/*! \brief Collects timings of instrumented GUI sections.
+ *
+ * Recording is disabled by default and costs a single atomic load per scope
+ * in that case. When enabled, the last samples of every section are kept for
+ * percentile statistics and the latest events are kept for export in the
+ * Chrome trace format (chrome://tracing, Perfetto).
+ */
+class Profiler : public QObject {
+    Q_OBJECT
+public:
+    /*! \brief Aggregated statistics of a single section, in microseconds. */
+    struct Stats {
+        QString section;
+        qint64 count = 0;
+        double p50 = 0;
+        double p99 = 0;
+        double max = 0;
+    };
+
+    /*!< Name under which event loop stalls are recorded */
+    static constexpr const char* EventLoopStall = "EventLoop::stall";
+
+    static Profiler& instance();
+
+    /*! \brief Enables or disables recording, also starts event loop probe.
+     * Called from the GUI thread, which owns the probe timer. */
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    /*! \brief Returns monotonic time in nanoseconds. */
+    qint64 now() const { return m_clock.nsecsElapsed(); }
+
+    /*! \brief Records section that started at \a startNs and took
+     * \a durationNs. Thread-safe. */
+    void record(const char* section, qint64 startNs, qint64 durationNs);
+
+    /*! \brief Returns statistics of all recorded sections. */
+    QVector<Stats> stats() const;
+
+    /*! \brief Drops all recorded samples and events. */
+    void clear();
+
+    /*! \brief Writes recorded events as Chrome trace JSON.
+     * \returns false if the file cannot be written
+     */
+    bool exportChromeTrace(const QString& path) const;
+
+private slots:
+    void onProbe();
+
+private:
+    Profiler();
+
+    struct Event {
+        const char* section;
+        qint64 startNs;
+        qint64 durationNs;
+        qint64 threadId;
+    };
+
+    /*!< Samples kept per section for percentiles */
+    static const int MaxSamples = 4096;
+    /*!< Events kept for the trace export, newer ones overwrite the oldest */
+    static const int MaxEvents = 200000;
+    /*!< Period of the event loop probe */
+    static const int ProbeIntervalMs = 10;
+
+    std::atomic<bool> m_enabled;
+    QElapsedTimer m_clock;
+    QTimer m_probe;
+    qint64 m_lastProbeNs;
+
+    mutable QMutex m_mutex;
+    /*!< Ring buffers of durations indexed by section */
+    QHash<const char*, QVector<qint64>> m_samples;
+    QHash<const char*, qint64> m_counts;
+    /*!< Ring buffer of events, m_eventCount % MaxEvents is the oldest once
+     * it is full */
+    QVector<Event> m_events;
+    qint64 m_eventCount;
+};
+
+/*! \brief Records duration of the enclosing scope under given section name.
+ *
+ * Section name must be a string literal, it is used as a key.
+ */
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* section)
+        : m_section(section),
+          m_startNs(Profiler::instance().isEnabled()
+                        ? Profiler::instance().now()
+                        : -1) {}
+
+    ~ProfileScope() {
+        if (m_startNs < 0) return;
+        Profiler& profiler = Profiler::instance();
+        profiler.record(m_section, m_startNs, profiler.now() - m_startNs);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* m_section;
+    qint64 m_startNs;
+};
+
+#endif  // PROFILER_HPP
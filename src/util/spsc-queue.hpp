@@ -0,0 +1,68 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/*! \brief Bounded lock-free queue for exactly one producer and one consumer
+ * thread.
+ *
+ * Capacity is rounded up to a power of two. Producer and consumer indices
+ * live on separate cache lines so that the two threads do not contend.
+ */
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size *= 2;
+        m_buffer.resize(size);
+        m_mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /*! \brief Appends value, producer only.
+     * \returns false if the queue is full and the value was not added
+     */
+    bool push(T value) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) > m_mask)
+            return false;
+
+        m_buffer[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*! \brief Takes the oldest value, consumer only.
+     * \returns false if the queue is empty
+     */
+    bool pop(T& value) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) return false;
+
+        value = std::move(m_buffer[head & m_mask]);
+        // Do not keep resources of consumed values alive in the buffer.
+        m_buffer[head & m_mask] = T();
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*! \brief Tests emptiness, exact only when called by the consumer */
+    bool empty() const {
+        return m_head.load(std::memory_order_acquire) ==
+               m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    static const size_t CacheLine = 64;
+
+    std::vector<T> m_buffer;
+    size_t m_mask;
+    alignas(CacheLine) std::atomic<size_t> m_head{0};
+    alignas(CacheLine) std::atomic<size_t> m_tail{0};
+};
+
+#endif  // SPSC_QUEUE_HPP
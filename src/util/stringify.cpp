@@ -29,7 +29,12 @@ QString Stringify::algebraicNotationString(const Board &board,
 
     if (!board.isLegal(move, &gameState, &moveType)) return "invalid move";
 
-    QString check = gameState.IsCheck ? "+" : "";
+    QString check = "";
+    if (gameState.IsCheck) {
+        Board next = board;
+        next.makeMove(move);
+        check = next.isCheckmate() ? "#" : "+";
+    }
 
     switch (moveType) {
         case MoveType::MOVE_CASTLE_SHORT:
@@ -40,7 +45,10 @@ QString Stringify::algebraicNotationString(const Board &board,
             return fileString(move.from().x) + "x" + squareString(move.to()) +
                    check;
         case MoveType::MOVE_PROMOTION:
-            return squareString(move.to()) + "=" +
+            return (move.from().x != move.to().x
+                        ? fileString(move.from().x) + "x"
+                        : QString()) +
+                   squareString(move.to()) + "=" +
                    Piece(move.promotionPiece()).symbolString() + check;
         default:
             break;
@@ -0,0 +1,106 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <cstdio>
+
+#include "engine/batch-analyzer.hpp"
+#include "game/board.hpp"
+#include "tablebase/tablebase.hpp"
+
+// Analyses positions of a FEN/EPD file, one position per line, with a pool
+// of engine processes, e.g.
+//
+//     batch-analysis --engine stockfish --option Threads=1 --depth 20 \
+//         --output results.tsv positions.fen
+//
+// Rerunning the same command after an interruption continues the batch.
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless batch analysis of positions.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("positions", "File with one FEN per line.");
+    parser.addOptions({
+        {"engine", "Engine executable.", "command"},
+        {"option", "Engine option, may be repeated.", "name=value"},
+        {"depth", "Search depth in plies.", "plies"},
+        {"nodes", "Number of nodes per position.", "nodes"},
+        {"movetime", "Search time per position.", "ms"},
+        {"workers", "Number of engine processes.", "count"},
+        {"output", "Result file, appended to.", "file"},
+        {"syzygy", "Syzygy tablebase directories, positions found in them "
+                   "are not searched.", "paths"},
+    });
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1 || !parser.isSet("engine") ||
+        !parser.isSet("output"))
+        parser.showHelp(1);
+
+    EngineConfig config;
+    config.setCommand(parser.value("engine"));
+    config.setName(QFileInfo(parser.value("engine")).baseName());
+    for (const QString& option : parser.values("option")) {
+        int separator = option.indexOf('=');
+        if (separator <= 0) parser.showHelp(1);
+        config.setOption(option.left(separator), option.mid(separator + 1));
+    }
+
+    SearchLimits limits;
+    limits.depth = parser.value("depth").toInt();
+    limits.nodes = parser.value("nodes").toLongLong();
+    limits.moveTime = parser.value("movetime").toInt();
+    if (limits.isInfinite()) {
+        std::fprintf(stderr, "One of --depth, --nodes or --movetime is "
+                             "required.\n");
+        return 1;
+    }
+
+    BatchAnalyzer analyzer(config, limits);
+    if (parser.isSet("workers"))
+        analyzer.setWorkerCount(parser.value("workers").toInt());
+    if (parser.isSet("syzygy")) {
+        Tablebase& tablebase = Tablebase::instance();
+        if (tablebase.init(parser.value("syzygy")) == 0)
+            std::fprintf(stderr, "No tablebases found in %s.\n",
+                         qPrintable(parser.value("syzygy")));
+        analyzer.setTablebase(&tablebase);
+    }
+
+    QFile input(parser.positionalArguments().first());
+    if (!input.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        std::fprintf(stderr, "Cannot open %s.\n", qPrintable(input.fileName()));
+        return 1;
+    }
+    QTextStream stream(&input);
+    Board board;
+    while (!stream.atEnd()) {
+        QString line = stream.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#')) continue;
+
+        if (board.setFen(line))
+            analyzer.addPosition(board.toFen());
+        else
+            std::fprintf(stderr, "Invalid FEN: %s\n", qPrintable(line));
+    }
+
+    if (!analyzer.setOutput(parser.value("output"))) {
+        std::fprintf(stderr, "Cannot open %s.\n",
+                     qPrintable(parser.value("output")));
+        return 1;
+    }
+
+    QObject::connect(&analyzer, &BatchAnalyzer::progress,
+                     [](int done, int total) {
+                         std::fprintf(stderr, "\r%d/%d", done, total);
+                     });
+    QObject::connect(&analyzer, &BatchAnalyzer::finished, &app, [&app]() {
+        std::fprintf(stderr, "\n");
+        app.quit();
+    });
+    analyzer.start();
+
+    return app.exec();
+}
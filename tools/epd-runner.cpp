@@ -0,0 +1,117 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+#include <QTextStream>
+#include <cstdio>
+
+#include "engine/epd-runner.hpp"
+#include "pgn/epd-reader.hpp"
+#include "util/stringify.hpp"
+
+// Runs an EPD test suite, e.g.
+//
+//     epd-runner --engine stockfish --option Threads=1 --movetime 1000 \
+//         --workers 8 wac.epd
+//
+// Prints every position as it finishes and the solved count with time to
+// solve statistics at the end.
+static QString moveList(const Board& board, const QVector<Move>& moves) {
+    QStringList names;
+    for (const Move& move : moves)
+        names.append(Stringify::algebraicNotationString(board, move));
+    return names.join(' ');
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Runs an EPD test suite on an engine.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("suite", "EPD file with bm or am moves.");
+    parser.addOptions({
+        {"engine", "Engine executable.", "command"},
+        {"option", "Engine option, may be repeated.", "name=value"},
+        {"movetime", "Search time per position.", "ms"},
+        {"nodes", "Number of nodes per position.", "nodes"},
+        {"workers", "Number of engine processes.", "count"},
+    });
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1 || !parser.isSet("engine"))
+        parser.showHelp(1);
+
+    EngineConfig config;
+    config.setCommand(parser.value("engine"));
+    config.setName(QFileInfo(parser.value("engine")).baseName());
+    for (const QString& option : parser.values("option")) {
+        int separator = option.indexOf('=');
+        if (separator <= 0) parser.showHelp(1);
+        config.setOption(option.left(separator), option.mid(separator + 1));
+    }
+
+    SearchLimits limits;
+    limits.moveTime = parser.value("movetime").toInt();
+    limits.nodes = parser.value("nodes").toLongLong();
+    if (limits.isInfinite()) {
+        std::fprintf(stderr, "One of --movetime or --nodes is required.\n");
+        return 1;
+    }
+
+    EpdRunner runner(config, limits);
+    if (parser.isSet("workers"))
+        runner.setWorkerCount(parser.value("workers").toInt());
+
+    QFile input(parser.positionalArguments().first());
+    if (!input.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        std::fprintf(stderr, "Cannot open %s.\n", qPrintable(input.fileName()));
+        return 1;
+    }
+    QTextStream stream(&input);
+    for (int number = 1; !stream.atEnd(); ++number) {
+        QString line = stream.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#')) continue;
+
+        EpdRecord record;
+        QString error;
+        if (!EpdReader::parse(line, record, &error))
+            std::fprintf(stderr, "Line %d: %s\n", number, qPrintable(error));
+        else if (!runner.addPosition(record))
+            std::fprintf(stderr, "Line %d: no bm or am moves\n", number);
+    }
+
+    QObject::connect(
+        &runner, &EpdRunner::positionFinished, [&runner](int index) {
+            const EpdRecord& record = runner.positions()[index];
+            const EpdRunner::Result& result = runner.results()[index];
+            QString id = record.id.isEmpty() ? QString::number(index + 1)
+                                             : record.id;
+            QString played =
+                result.bestMove == Move::NullMove
+                    ? QString("(none)")
+                    : Stringify::algebraicNotationString(record.board,
+                                                         result.bestMove);
+            if (result.solved)
+                std::printf("[%d/%d] %s: solved %s in %lld ms, depth %d, "
+                            "%lld nodes\n",
+                            runner.done(), runner.total(), qPrintable(id),
+                            qPrintable(played), result.time, result.depth,
+                            result.nodes);
+            else
+                std::printf(
+                    "[%d/%d] %s: failed with %s, bm %s am %s\n",
+                    runner.done(), runner.total(), qPrintable(id),
+                    qPrintable(played),
+                    qPrintable(moveList(record.board, record.bestMoves)),
+                    qPrintable(moveList(record.board, record.avoidMoves)));
+            std::fflush(stdout);
+        });
+    QObject::connect(&runner, &EpdRunner::finished, &app, [&app, &runner]() {
+        std::printf("%s\n", qPrintable(runner.summary()));
+        app.quit();
+    });
+    runner.start();
+
+    return app.exec();
+}
@@ -0,0 +1,135 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QThread>
+#include <cstdio>
+
+#include "match/match-runner.hpp"
+
+// Plays a match between two engines, e.g.
+//
+//     match-runner --first sf-new --second sf-old --tc 10+0.1 --games 1000 \
+//         --openings book.epd --pgn games.pgn --sprt 0,5
+static bool parseEngine(const QString& value, EngineConfig& config) {
+    // "command[:Name=value[,Name=value...]]"
+    QStringList parts = value.split(':');
+    config.setCommand(parts[0]);
+    config.setName(QFileInfo(parts[0]).baseName());
+
+    if (parts.size() < 2) return true;
+    for (const QString& option : parts[1].split(',')) {
+        int separator = option.indexOf('=');
+        if (separator <= 0) return false;
+        config.setOption(option.left(separator), option.mid(separator + 1));
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Engine versus engine match.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"first", "First engine.", "command[:Name=value,...]"},
+        {"second", "Second engine.", "command[:Name=value,...]"},
+        {"tc", "Time control in seconds.", "base+increment", "10+0.1"},
+        {"games", "Number of games.", "count", "100"},
+        {"concurrency", "Number of games played at once.", "count"},
+        {"openings", "File with one FEN or EPD per line.", "file"},
+        {"pgn", "File the games are appended to.", "file"},
+        {"sprt", "Stop early on SPRT decision.", "elo0,elo1"},
+        {"ponder", "Let engines think on the opponent's time."},
+        {"book", "Polyglot opening book.", "file"},
+        {"book-plies", "Maximum number of book plies.", "count", "16"},
+        {"polyglot-random", "Text file with the Polyglot Random64 table.",
+         "file"},
+    });
+    parser.process(app);
+
+    EngineConfig first;
+    EngineConfig second;
+    if (!parser.isSet("first") || !parser.isSet("second") ||
+        !parseEngine(parser.value("first"), first) ||
+        !parseEngine(parser.value("second"), second))
+        parser.showHelp(1);
+    // Make the engines distinguishable in the PGN.
+    if (first.name() == second.name()) {
+        first.setName(first.name() + "-1");
+        second.setName(second.name() + "-2");
+    }
+
+    TimeControl timeControl;
+    if (!timeControl.fromString(parser.value("tc"))) parser.showHelp(1);
+
+    MatchRunner runner(first, second, timeControl);
+    runner.setGameCount(parser.value("games").toInt());
+    runner.setPonder(parser.isSet("ponder"));
+    if (parser.isSet("concurrency"))
+        runner.setConcurrency(parser.value("concurrency").toInt());
+    else if (parser.isSet("ponder"))
+        runner.setConcurrency(QThread::idealThreadCount() / 2);
+
+    if (parser.isSet("openings")) {
+        QFile input(parser.value("openings"));
+        if (!input.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            std::fprintf(stderr, "Cannot open %s.\n",
+                         qPrintable(input.fileName()));
+            return 1;
+        }
+        QTextStream stream(&input);
+        while (!stream.atEnd()) {
+            QString line = stream.readLine().trimmed();
+            if (line.isEmpty() || line.startsWith('#')) continue;
+            if (!runner.addOpening(line))
+                std::fprintf(stderr, "Invalid opening: %s\n", qPrintable(line));
+        }
+    }
+
+    if (parser.isSet("polyglot-random") &&
+        !PolyglotBook::loadRandomTable(parser.value("polyglot-random"))) {
+        std::fprintf(stderr, "No Random64 table in %s.\n",
+                     qPrintable(parser.value("polyglot-random")));
+        return 1;
+    }
+    if (parser.isSet("book") &&
+        !runner.setBook(parser.value("book"),
+                        parser.value("book-plies").toInt())) {
+        std::fprintf(stderr, "Cannot open book %s.\n",
+                     qPrintable(parser.value("book")));
+        if (!PolyglotBook::hasStandardTable())
+            std::fprintf(stderr, "Books of other programs need "
+                                 "--polyglot-random.\n");
+        return 1;
+    }
+
+    if (parser.isSet("pgn") && !runner.setOutput(parser.value("pgn"))) {
+        std::fprintf(stderr, "Cannot open %s.\n",
+                     qPrintable(parser.value("pgn")));
+        return 1;
+    }
+
+    if (parser.isSet("sprt")) {
+        QStringList bounds = parser.value("sprt").split(',');
+        if (bounds.size() != 2) parser.showHelp(1);
+        runner.setSprt(bounds[0].toDouble(), bounds[1].toDouble());
+    }
+
+    QObject::connect(&runner, &MatchRunner::gameFinished,
+                     [&runner](int round, QString white, QString black,
+                               QString result) {
+                         std::printf("Game %d: %s - %s %s\n%s\n", round + 1,
+                                     qPrintable(white), qPrintable(black),
+                                     qPrintable(result),
+                                     qPrintable(
+                                         runner.statistics().toString()));
+                         std::fflush(stdout);
+                     });
+    QObject::connect(&runner, &MatchRunner::finished, &app,
+                     &QCoreApplication::quit);
+    runner.start();
+
+    return app.exec();
+}
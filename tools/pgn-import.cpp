@@ -0,0 +1,223 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <cstdio>
+
+#include "book/polyglot-book.hpp"
+#include "database/game-database.hpp"
+#include "database/game-deduplicator.hpp"
+#include "database/opening-explorer.hpp"
+#include "database/position-index.hpp"
+#include "pgn/pgn-importer.hpp"
+#include "pgn/pgn-writer.hpp"
+
+// Reads every game of a PGN file into a move tree on all cores and reports
+// throughput, e.g.
+//
+//     pgn-import --threads 8 archive.pgn
+//
+// With --output the games are exported again, which checks that the reader
+// and writer round trip. With --database the games are converted into the
+// binary game database, --positions indexes its positions afterwards and
+// --explorer computes its opening statistics. With --book the database is
+// turned into a Polyglot opening book.
+//
+// With --dedup games seen before, in the file or in the database, are not
+// written, --dedup-report lists duplicates and near duplicates with the
+// same moves and other tags.
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Imports games from a PGN file.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("pgn", "PGN file.");
+    parser.addOptions({
+        {"threads", "Number of parsing threads.", "count"},
+        {"output", "Writes the games back to a PGN file.", "file"},
+        {"database", "Appends the games to a game database.", "file"},
+        {"positions", "Builds position index of the database."},
+        {"explorer", "Builds opening explorer of the database."},
+        {"book", "Builds Polyglot book from the database.", "file"},
+        {"book-plies", "Maximum number of book plies.", "count", "16"},
+        {"polyglot-random", "Text file with the Polyglot Random64 table.",
+         "file"},
+        {"dedup", "Skips games with the same moves and tags as an earlier "
+                  "one, games of the database included."},
+        {"dedup-moves", "Skips games with the same moves regardless of "
+                        "tags."},
+        {"dedup-report", "Writes duplicates and near duplicates to a file.",
+         "file"},
+    });
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1 ||
+        ((parser.isSet("positions") || parser.isSet("explorer") ||
+          parser.isSet("book")) &&
+         !parser.isSet("database")))
+        parser.showHelp(1);
+
+    QString path = parser.positionalArguments().first();
+    qint64 size = qMax<qint64>(1, QFileInfo(path).size());
+    PgnImporter importer(path);
+    if (parser.isSet("threads"))
+        importer.setThreadCount(parser.value("threads").toInt());
+
+    QFile output(parser.value("output"));
+    std::unique_ptr<PgnWriter> writer;
+    if (parser.isSet("output")) {
+        if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::fprintf(stderr, "Cannot open %s.\n",
+                         qPrintable(output.fileName()));
+            return 1;
+        }
+        writer = std::make_unique<PgnWriter>(&output);
+    }
+
+    GameDatabase database;
+    if (parser.isSet("database") &&
+        !database.open(parser.value("database"), GameDatabase::Append)) {
+        std::fprintf(stderr, "Cannot open database %s.\n",
+                     qPrintable(parser.value("database")));
+        return 1;
+    }
+
+    // Ids of database games are their indexes, games of the file follow.
+    bool skipDuplicates = parser.isSet("dedup") || parser.isSet("dedup-moves");
+    bool dedup = skipDuplicates || parser.isSet("dedup-report");
+    qint64 databaseGames = 0;
+    std::unique_ptr<GameDeduplicator> deduplicator;
+    QFile report(parser.value("dedup-report"));
+    if (dedup) {
+        GameDatabase existing;
+        if (parser.isSet("database") && existing.open(parser.value("database")))
+            databaseGames = existing.gameCount();
+        // Sized up front, growing the sets would briefly triple them.
+        deduplicator =
+            std::make_unique<GameDeduplicator>(databaseGames + size / 1024);
+        if (existing.isOpen())
+            deduplicator->addDatabase(existing, importer.threadCount());
+    }
+    if (parser.isSet("dedup-report") &&
+        !report.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        std::fprintf(stderr, "Cannot open %s.\n",
+                     qPrintable(report.fileName()));
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 lastReport = 0;
+    qint64 inputGames = 0;
+    qint64 duplicates = 0;
+    qint64 nearDuplicates = 0;
+    qint64 skipped = 0;
+    // Games are hashed on the parsing threads, in order only looked up.
+    PgnImporter::KeyFunction hash;
+    if (deduplicator)
+        hash = [](const Tree& game) { return GameDeduplicator::key(game); };
+    bool imported = importer.run(hash, [&](std::unique_ptr<Tree> game,
+                                          const PgnImporter::Key& key) {
+        qint64 id = databaseGames + inputGames++;
+        quint32 original = 0;
+        GameDeduplicator::Match match =
+            deduplicator ? deduplicator->add(key, id, original)
+                         : GameDeduplicator::Unique;
+        if (match != GameDeduplicator::Unique) {
+            bool exact = match == GameDeduplicator::Duplicate;
+            ++(exact ? duplicates : nearDuplicates);
+            // Games of the file count from 1 like in error messages.
+            if (report.isOpen())
+                report.write(
+                    QString("%1\t%2\t%3 %4\n")
+                        .arg(inputGames)
+                        .arg(exact ? "duplicate" : "near-duplicate")
+                        .arg(original < databaseGames ? "database" : "input")
+                        .arg(original < databaseGames
+                                 ? original
+                                 : original - databaseGames + 1)
+                        .toUtf8());
+        }
+
+        bool skip = (match == GameDeduplicator::Duplicate && skipDuplicates) ||
+                    (match != GameDeduplicator::Unique &&
+                     parser.isSet("dedup-moves"));
+        if (skip) ++skipped;
+        if (writer && !skip) writer->writeGame(*game);
+        if (database.isOpen() && !skip) database.append(*game);
+        if (timer.elapsed() - lastReport < 1000) return;
+
+        lastReport = timer.elapsed();
+        std::fprintf(stderr, "\r%lld games, %.0f games/s, %.0f%%",
+                     importer.gameCount(),
+                     importer.gameCount() * 1000.0 / lastReport,
+                     importer.position() * 100.0 / size);
+    });
+    if (!imported) {
+        std::fprintf(stderr, "Cannot read %s: %s\n", qPrintable(path),
+                     qPrintable(importer.lastError()));
+        return 1;
+    }
+
+    if (database.isOpen() && !database.flush()) {
+        std::fprintf(stderr, "Cannot write database %s.\n",
+                     qPrintable(parser.value("database")));
+        return 1;
+    }
+    if (writer && !writer->flush()) {
+        std::fprintf(stderr, "Cannot write %s.\n",
+                     qPrintable(output.fileName()));
+        return 1;
+    }
+
+    double seconds = qMax<qint64>(1, timer.elapsed()) / 1000.0;
+    std::fprintf(stderr, "\r");
+    std::printf("%lld games, %lld skipped in %.1f s on %d threads: "
+                "%.0f games/s, %.1f MB/s\n",
+                importer.gameCount(), importer.skippedCount(), seconds,
+                importer.threadCount(), importer.gameCount() / seconds,
+                importer.position() / seconds / (1024 * 1024));
+    if (importer.skippedCount())
+        std::printf("Last error: %s\n", qPrintable(importer.lastError()));
+    if (deduplicator)
+        std::printf("%lld duplicates, %lld near duplicates, %lld skipped\n",
+                    duplicates, nearDuplicates, skipped);
+    if (report.isOpen() && !report.flush()) {
+        std::fprintf(stderr, "Cannot write %s.\n",
+                     qPrintable(report.fileName()));
+        return 1;
+    }
+    if (!parser.isSet("positions") && !parser.isSet("explorer") &&
+        !parser.isSet("book"))
+        return 0;
+    if (parser.isSet("polyglot-random") &&
+        !PolyglotBook::loadRandomTable(parser.value("polyglot-random"))) {
+        std::fprintf(stderr, "No Random64 table in %s.\n",
+                     qPrintable(parser.value("polyglot-random")));
+        return 1;
+    }
+
+    // Indexes cover the whole database, not only the games just added.
+    QString databasePath = parser.value("database");
+    database.close();
+    timer.restart();
+    if (!database.open(databasePath) ||
+        (parser.isSet("positions") &&
+         !PositionIndex::build(database, databasePath,
+                               importer.threadCount())) ||
+        (parser.isSet("explorer") &&
+         !OpeningExplorer::build(database, databasePath,
+                                 importer.threadCount())) ||
+        (parser.isSet("book") &&
+         !PolyglotBook::build(database, parser.value("book"),
+                              importer.threadCount(),
+                              parser.value("book-plies").toInt()))) {
+        std::fprintf(stderr, "Cannot index database %s.\n",
+                     qPrintable(databasePath));
+        return 1;
+    }
+    std::printf("Indexed %lld games in %.1f s\n", database.gameCount(),
+                qMax<qint64>(1, timer.elapsed()) / 1000.0);
+    return 0;
+}
@@ -0,0 +1,126 @@
+// Stand-in UCI engine that plays back a log written by UciRecorder, so that
+// engine handling can be tested and benchmarked without a real engine:
+//
+//     uci-replay session.uci [--speed factor]
+//
+// Engine output is written with the recorded delays divided by the speed
+// factor, measured from the last command it follows; speed 0 writes it as
+// fast as possible. Commands are matched by their first word. Unexpected
+// commands are ignored, and recorded commands that never arrive are skipped
+// as soon as a later command of the same group does.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Message {
+    long long time;
+    char direction;
+    std::string text;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+std::string firstWord(const std::string& line) {
+    return line.substr(0, line.find(' '));
+}
+
+bool loadLog(const char* path, std::vector<Message>& messages) {
+    std::ifstream input(path);
+    if (!input) return false;
+
+    std::string line;
+    while (std::getline(input, line)) {
+        std::istringstream stream(line);
+        Message message;
+        if (!(stream >> message.time >> message.direction)) continue;
+        if (message.direction != '<' && message.direction != '>') continue;
+
+        stream.get();
+        std::getline(stream, message.text);
+        messages.push_back(message);
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const char* path = nullptr;
+    double speed = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--speed") == 0 && i + 1 < argc)
+            speed = std::atof(argv[++i]);
+        else
+            path = argv[i];
+    }
+
+    std::vector<Message> messages;
+    if (!path || !loadLog(path, messages)) {
+        std::fprintf(stderr, "Usage: uci-replay <log> [--speed factor]\n");
+        return 1;
+    }
+
+    long long syncTime = 0;
+    Clock::time_point syncClock = Clock::now();
+    size_t next = 0;
+
+    while (next < messages.size()) {
+        const Message& message = messages[next];
+
+        if (message.direction == '<') {
+            if (speed > 0) {
+                auto delay = std::chrono::microseconds(static_cast<long long>(
+                    (message.time - syncTime) / speed));
+                std::this_thread::sleep_until(syncClock + delay);
+            }
+            std::fwrite(message.text.data(), 1, message.text.size(), stdout);
+            std::fputc('\n', stdout);
+            std::fflush(stdout);
+            ++next;
+            continue;
+        }
+
+        // Wait for one of the commands recorded before the next output.
+        size_t groupEnd = next;
+        while (groupEnd < messages.size() &&
+               messages[groupEnd].direction == '>')
+            ++groupEnd;
+
+        std::string line;
+        if (!std::getline(std::cin, line) || line == "quit") return 0;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        size_t matched = next;
+        while (matched < groupEnd &&
+               firstWord(messages[matched].text) != firstWord(line))
+            ++matched;
+        if (matched == groupEnd) {
+            std::fprintf(stderr, "uci-replay: ignoring '%s'\n", line.c_str());
+            continue;
+        }
+
+        syncTime = messages[matched].time;
+        syncClock = Clock::now();
+        next = matched + 1;
+    }
+
+    // Recording is over, keep the GUI happy until it lets us go.
+    std::string line;
+    while (std::getline(std::cin, line) && line != "quit") {
+        if (line == "isready") {
+            std::puts("readyok");
+            std::fflush(stdout);
+        }
+    }
+    return 0;
+}